@@ -19,7 +19,7 @@
 #include <gio/gio.h>
 #include "gmpd-audio-format.h"
 
-static GRegex *gmpd_audio_format_get_regex(void);
+static const gchar *gmpd_audio_format_match(const gchar *s);
 
 enum {
 	PROP_NONE,
@@ -151,36 +151,21 @@ gmpd_audio_format_new(void)
 GMpdAudioFormat *
 gmpd_audio_format_new_from_string(const gchar *s)
 {
-	GRegex *regex;
-	GMatchInfo *match_info;
-
 	GMpdAudioFormat *afmt;
-	gchar *pos_1;
-	gchar *pos_2;
-	gchar *pos_3;
+	const gchar *match;
+	gchar *end;
 
 	g_return_val_if_fail(s != NULL, NULL);
 
-	regex = gmpd_audio_format_get_regex();
-
-	if (!g_regex_match(regex, s, 0, &match_info)) {
-		g_match_info_unref(match_info);
+	match = gmpd_audio_format_match(s);
+	if (!match)
 		return NULL;
-	}
 
 	afmt = gmpd_audio_format_new();
-	pos_1 = g_match_info_fetch(match_info, 1);
-	pos_2 = g_match_info_fetch(match_info, 2);
-	pos_3 = g_match_info_fetch(match_info, 3);
-
-	afmt->sample_rate = g_ascii_strtoull(pos_1, NULL, 10);
-	afmt->bit_depth = g_ascii_strtoull(pos_2, NULL, 10);
-	afmt->channels = g_ascii_strtoull(pos_3, NULL, 10);
 
-	g_free(pos_1);
-	g_free(pos_2);
-	g_free(pos_3);
-	g_match_info_unref(match_info);
+	afmt->sample_rate = g_ascii_strtoull(match, &end, 10);
+	afmt->bit_depth = g_ascii_strtoull(end + 1, &end, 10);
+	afmt->channels = g_ascii_strtoull(end + 1, NULL, 10);
 
 	return afmt;
 }
@@ -242,24 +227,44 @@ gmpd_audio_format_get_channels(GMpdAudioFormat *self)
 	return self->channels;
 }
 
-static GRegex *
-gmpd_audio_format_get_regex(void)
+static gsize
+count_digits(const gchar *s)
 {
-	static const gchar *const regex_string = "(\\d+):(\\d+):(\\d+)";
-	static GRegex *regex = NULL;
-	static volatile gsize initialized = 0;
+	gsize n = 0;
 
-	if (g_once_init_enter(&initialized)) {
-		GError *err = NULL;
+	while (g_ascii_isdigit(s[n]))
+		n++;
 
-		regex = g_regex_new(regex_string, G_REGEX_OPTIMIZE, 0, &err);
-		if (!regex)
-			g_error("failed to compile regex: %s", err->message);
+	return n;
+}
 
-		g_once_init_leave(&initialized, 1);
+/* Finds the first "<digits>:<digits>:<digits>" in s, which may be
+ * preceded or followed by anything. A match can only start at the
+ * beginning of a run of digits, and if it fails there it fails for the
+ * rest of the run too.
+ */
+static const gchar *
+gmpd_audio_format_match(const gchar *s)
+{
+	while (*s) {
+		const gchar *p = s;
+		gsize n;
+
+		n = count_digits(p);
+		if (!n) {
+			s++;
+			continue;
+		}
+
+		p += n;
+		if (*p == ':' && (n = count_digits(p + 1))) {
+			p += n + 1;
+			if (*p == ':' && count_digits(p + 1))
+				return s;
+		}
+
+		s += count_digits(s);
 	}
 
-	g_assert(regex != NULL);
-	return regex;
+	return NULL;
 }
-
@@ -0,0 +1,255 @@
+/* libgmpd: MPD protocol implementation for GLib
+ * Copyright (C) 2020 Patrick Keating <binarydrifter@protonmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <gio/gio.h>
+#include "gmpd-batch.h"
+#include "gmpd-batch-priv.h"
+#include "gmpd-protocol.h"
+#include "gmpd-replay-gain-mode.h"
+#include "gmpd-response.h"
+#include "gmpd-void-response.h"
+
+static void gmpd_batch_response_iface_init(GMpdResponseIface *iface);
+
+static GMpdResponse *gmpd_batch_get_current(GMpdBatch *self);
+
+G_DEFINE_TYPE_WITH_CODE(GMpdBatch, gmpd_batch, G_TYPE_OBJECT,
+                        G_IMPLEMENT_INTERFACE(GMPD_TYPE_RESPONSE,
+                                              gmpd_batch_response_iface_init))
+
+static void
+gmpd_batch_response_feed_pair(GMpdResponse *response,
+                              GMpdVersion  *version,
+                              const gchar  *key,
+                              const gchar  *value)
+{
+	GMpdResponse *current;
+
+	g_return_if_fail(GMPD_IS_BATCH(response));
+	g_return_if_fail(GMPD_IS_VERSION(version));
+	g_return_if_fail(key != NULL);
+	g_return_if_fail(value != NULL);
+
+	current = gmpd_batch_get_current(GMPD_BATCH(response));
+	g_return_if_fail(current != NULL);
+
+	gmpd_response_feed_pair(current, version, key, value);
+}
+
+static void
+gmpd_batch_response_feed_binary(GMpdResponse *response,
+                                GMpdVersion  *version,
+                                GBytes       *binary)
+{
+	GMpdResponse *current;
+
+	g_return_if_fail(GMPD_IS_BATCH(response));
+	g_return_if_fail(GMPD_IS_VERSION(version));
+	g_return_if_fail(binary != NULL);
+
+	current = gmpd_batch_get_current(GMPD_BATCH(response));
+	g_return_if_fail(current != NULL);
+
+	gmpd_response_feed_binary(current, version, binary);
+}
+
+static gsize
+gmpd_batch_response_get_remaining_binary(GMpdResponse *response)
+{
+	GMpdResponse *current;
+
+	g_return_val_if_fail(GMPD_IS_BATCH(response), 0);
+
+	current = gmpd_batch_get_current(GMPD_BATCH(response));
+
+	return current ? gmpd_response_get_remaining_binary(current) : 0;
+}
+
+static gboolean
+gmpd_batch_response_feed_list_ok(GMpdResponse *response,
+                                 GMpdVersion  *version)
+{
+	GMpdResponse *current;
+	GMpdBatch *self;
+
+	g_return_val_if_fail(GMPD_IS_BATCH(response), TRUE);
+
+	self = GMPD_BATCH(response);
+
+	current = gmpd_batch_get_current(self);
+	if (current)
+		gmpd_response_finish(current, version);
+
+	/* the batch itself is terminated by the final OK */
+	if (self->n_completed < self->tasks->len)
+		self->n_completed++;
+
+	return FALSE;
+}
+
+static void
+gmpd_batch_response_iface_init(GMpdResponseIface *iface)
+{
+	iface->feed_pair = gmpd_batch_response_feed_pair;
+	iface->feed_binary = gmpd_batch_response_feed_binary;
+	iface->get_remaining_binary = gmpd_batch_response_get_remaining_binary;
+	iface->feed_list_ok = gmpd_batch_response_feed_list_ok;
+}
+
+static void
+gmpd_batch_finalize(GObject *object)
+{
+	GMpdBatch *self = GMPD_BATCH(object);
+
+	g_clear_pointer(&self->tasks, g_ptr_array_unref);
+
+	G_OBJECT_CLASS(gmpd_batch_parent_class)->finalize(object);
+}
+
+static void
+gmpd_batch_class_init(GMpdBatchClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(klass);
+
+	object_class->finalize = gmpd_batch_finalize;
+}
+
+static void
+gmpd_batch_init(GMpdBatch *self)
+{
+	self->tasks = g_ptr_array_new_with_free_func((GDestroyNotify)gmpd_task_data_unref);
+	self->n_completed = 0;
+	self->sent = FALSE;
+}
+
+GMpdBatch *
+gmpd_batch_new(void)
+{
+	return g_object_new(GMPD_TYPE_BATCH, NULL);
+}
+
+guint
+gmpd_batch_add_clearerror(GMpdBatch *self)
+{
+	g_return_val_if_fail(GMPD_IS_BATCH(self), G_MAXUINT);
+	return gmpd_batch_add_task(self, gmpd_protocol_clearerror());
+}
+
+guint
+gmpd_batch_add_currentsong(GMpdBatch *self)
+{
+	g_return_val_if_fail(GMPD_IS_BATCH(self), G_MAXUINT);
+	return gmpd_batch_add_task(self, gmpd_protocol_currentsong());
+}
+
+guint
+gmpd_batch_add_status(GMpdBatch *self)
+{
+	g_return_val_if_fail(GMPD_IS_BATCH(self), G_MAXUINT);
+	return gmpd_batch_add_task(self, gmpd_protocol_status());
+}
+
+guint
+gmpd_batch_add_stats(GMpdBatch *self)
+{
+	g_return_val_if_fail(GMPD_IS_BATCH(self), G_MAXUINT);
+	return gmpd_batch_add_task(self, gmpd_protocol_stats());
+}
+
+guint
+gmpd_batch_add_replay_gain_mode(GMpdBatch          *self,
+                                GMpdReplayGainMode  mode)
+{
+	g_return_val_if_fail(GMPD_IS_BATCH(self), G_MAXUINT);
+	g_return_val_if_fail(GMPD_IS_REPLAY_GAIN_MODE(mode), G_MAXUINT);
+	return gmpd_batch_add_task(self, gmpd_protocol_replay_gain_mode(mode));
+}
+
+guint
+gmpd_batch_add_replay_gain_status(GMpdBatch *self)
+{
+	g_return_val_if_fail(GMPD_IS_BATCH(self), G_MAXUINT);
+	return gmpd_batch_add_task(self, gmpd_protocol_replay_gain_status());
+}
+
+guint
+gmpd_batch_get_length(GMpdBatch *self)
+{
+	g_return_val_if_fail(GMPD_IS_BATCH(self), 0);
+	return self->tasks->len;
+}
+
+guint
+gmpd_batch_get_n_completed(GMpdBatch *self)
+{
+	g_return_val_if_fail(GMPD_IS_BATCH(self), 0);
+	return self->n_completed;
+}
+
+gpointer
+gmpd_batch_get_response(GMpdBatch *self,
+                        guint      index)
+{
+	GMpdTaskData *data;
+
+	g_return_val_if_fail(GMPD_IS_BATCH(self), NULL);
+	g_return_val_if_fail(index < self->tasks->len, NULL);
+
+	if (index >= self->n_completed)
+		return NULL;
+
+	data = g_ptr_array_index(self->tasks, index);
+
+	if (!data->response || GMPD_IS_VOID_RESPONSE(data->response))
+		return NULL;
+
+	return g_object_ref(data->response);
+}
+
+guint
+gmpd_batch_add_task(GMpdBatch    *self,
+                    GMpdTaskData *data)
+{
+	g_return_val_if_fail(GMPD_IS_BATCH(self), G_MAXUINT);
+	g_return_val_if_fail(data != NULL, G_MAXUINT);
+
+	if (self->sent) {
+		g_critical("commands can not be added to a batch that has been sent");
+		gmpd_task_data_unref(data);
+		return G_MAXUINT;
+	}
+
+	g_ptr_array_add(self->tasks, data);
+
+	return self->tasks->len - 1;
+}
+
+static GMpdResponse *
+gmpd_batch_get_current(GMpdBatch *self)
+{
+	GMpdTaskData *data;
+
+	g_return_val_if_fail(GMPD_IS_BATCH(self), NULL);
+
+	if (self->n_completed >= self->tasks->len)
+		return NULL;
+
+	data = g_ptr_array_index(self->tasks, self->n_completed);
+
+	return data->response;
+}
@@ -0,0 +1,74 @@
+/* libgmpd: MPD protocol implementation for GLib
+ * Copyright (C) 2020 Patrick Keating <binarydrifter@protonmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef __GMPD_BATCH_H__
+#define __GMPD_BATCH_H__
+
+#if !defined(__GMPD_H_INSIDE__) && !defined(__GMPD_BUILD__)
+#   error "Only <gmpd.h> can be included directly."
+#endif
+
+#include <gio/gio.h>
+#include <gmpd-replay-gain-mode.h>
+
+G_BEGIN_DECLS
+
+#define GMPD_TYPE_BATCH \
+	(gmpd_batch_get_type())
+
+#define GMPD_BATCH(inst) \
+	(G_TYPE_CHECK_INSTANCE_CAST((inst), GMPD_TYPE_BATCH, GMpdBatch))
+
+#define GMPD_BATCH_CLASS(klass) \
+	(G_TYPE_CHECK_CLASS_CAST((klass), GMPD_TYPE_BATCH, GMpdBatchClass))
+
+#define GMPD_IS_BATCH(inst) \
+	(G_TYPE_CHECK_INSTANCE_TYPE((inst), GMPD_TYPE_BATCH))
+
+#define GMPD_IS_BATCH_CLASS(klass) \
+	(G_TYPE_CHECK_CLASS_TYPE((klass), GMPD_TYPE_BATCH))
+
+#define GMPD_BATCH_GET_CLASS(inst) \
+	(G_TYPE_INSTANCE_GET_CLASS((inst), GMPD_TYPE_BATCH, GMpdBatchClass))
+
+typedef struct _GMpdBatch      GMpdBatch;
+typedef struct _GMpdBatchClass GMpdBatchClass;
+
+GType        gmpd_batch_get_type                (void);
+
+GMpdBatch *  gmpd_batch_new                     (void);
+
+guint        gmpd_batch_add_clearerror          (GMpdBatch          *self);
+guint        gmpd_batch_add_currentsong         (GMpdBatch          *self);
+guint        gmpd_batch_add_status              (GMpdBatch          *self);
+guint        gmpd_batch_add_stats               (GMpdBatch          *self);
+
+guint        gmpd_batch_add_replay_gain_mode    (GMpdBatch          *self,
+                                                 GMpdReplayGainMode  mode);
+
+guint        gmpd_batch_add_replay_gain_status  (GMpdBatch          *self);
+
+guint        gmpd_batch_get_length              (GMpdBatch          *self);
+guint        gmpd_batch_get_n_completed         (GMpdBatch          *self);
+
+gpointer     gmpd_batch_get_response            (GMpdBatch          *self,
+                                                 guint               index);
+
+G_END_DECLS
+
+#endif /* __GMPD_BATCH_H__ */
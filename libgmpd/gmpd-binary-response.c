@@ -0,0 +1,162 @@
+/* libgmpd: MPD protocol implementation for GLib
+ * Copyright (C) 2020 Patrick Keating <binarydrifter@protonmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <string.h>
+#include <gio/gio.h>
+#include "gmpd-binary-response.h"
+#include "gmpd-response.h"
+#include "gmpd-version.h"
+
+static void gmpd_binary_response_iface_init(GMpdResponseIface *iface);
+
+G_DEFINE_TYPE_WITH_CODE(GMpdBinaryResponse, gmpd_binary_response, G_TYPE_OBJECT,
+                        G_IMPLEMENT_INTERFACE(GMPD_TYPE_RESPONSE,
+                                              gmpd_binary_response_iface_init))
+
+static void
+gmpd_binary_response_feed_pair(GMpdResponse *response,
+                               GMpdVersion  *version,
+                               const gchar  *key,
+                               const gchar  *value)
+{
+	GMpdBinaryResponse *self;
+
+	g_return_if_fail(GMPD_IS_BINARY_RESPONSE(response));
+	g_return_if_fail(GMPD_IS_VERSION(version));
+	g_return_if_fail(key != NULL);
+	g_return_if_fail(value != NULL);
+
+	self = GMPD_BINARY_RESPONSE(response);
+
+	if (!g_strcmp0(key, "size")) {
+		self->size = g_ascii_strtoull(value, NULL, 10);
+
+		if (self->buffer->len == 0 && self->size > self->base)
+			g_byte_array_set_size(self->buffer, self->size - self->base);
+
+	} else if (!g_strcmp0(key, "binary")) {
+		/* the data is followed by a newline */
+		self->length = g_ascii_strtoull(value, NULL, 10);
+		self->remaining = self->length + 1;
+
+	} else if (g_strcmp0(key, "type") != 0) {
+		g_warning("invalid key: %s", key);
+	}
+}
+
+static void
+gmpd_binary_response_feed_binary(GMpdResponse *response,
+                                 GMpdVersion  *version,
+                                 GBytes       *binary)
+{
+	GMpdBinaryResponse *self;
+	const guint8 *data;
+	gsize n_data;
+	gsize start;
+	gsize stop;
+
+	g_return_if_fail(GMPD_IS_BINARY_RESPONSE(response));
+	g_return_if_fail(GMPD_IS_VERSION(version));
+	g_return_if_fail(binary != NULL);
+
+	self = GMPD_BINARY_RESPONSE(response);
+	data = g_bytes_get_data(binary, &n_data);
+
+	g_return_if_fail(n_data <= self->remaining);
+
+	/* the part of the chunk in this piece, clipped to what the buffer
+	 * and the request cover */
+	start = self->offset + self->received;
+	stop = MIN(start + n_data, self->offset + self->length);
+	stop = MIN(stop, self->end);
+	stop = MIN(stop, self->base + self->buffer->len);
+
+	if (start < stop)
+		memcpy(self->buffer->data + start - self->base, data, stop - start);
+
+	self->received += n_data;
+	self->remaining -= n_data;
+}
+
+static gsize
+gmpd_binary_response_get_remaining_binary(GMpdResponse *response)
+{
+	g_return_val_if_fail(GMPD_IS_BINARY_RESPONSE(response), 0);
+	return GMPD_BINARY_RESPONSE(response)->remaining;
+}
+
+static void
+gmpd_binary_response_iface_init(GMpdResponseIface *iface)
+{
+	iface->feed_pair = gmpd_binary_response_feed_pair;
+	iface->feed_binary = gmpd_binary_response_feed_binary;
+	iface->get_remaining_binary = gmpd_binary_response_get_remaining_binary;
+}
+
+static void
+gmpd_binary_response_finalize(GObject *object)
+{
+	GMpdBinaryResponse *self = GMPD_BINARY_RESPONSE(object);
+
+	g_clear_pointer(&self->buffer, g_byte_array_unref);
+
+	G_OBJECT_CLASS(gmpd_binary_response_parent_class)->finalize(object);
+}
+
+static void
+gmpd_binary_response_class_init(GMpdBinaryResponseClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(klass);
+
+	object_class->finalize = gmpd_binary_response_finalize;
+}
+
+static void
+gmpd_binary_response_init(GMpdBinaryResponse *self)
+{
+	self->buffer = NULL;
+	self->base = 0;
+	self->offset = 0;
+	self->end = 0;
+
+	self->size = 0;
+	self->length = 0;
+	self->received = 0;
+	self->remaining = 0;
+}
+
+GMpdBinaryResponse *
+gmpd_binary_response_new(GByteArray *buffer,
+                         gsize       base,
+                         gsize       offset,
+                         gsize       end)
+{
+	GMpdBinaryResponse *self;
+
+	g_return_val_if_fail(buffer != NULL, NULL);
+	g_return_val_if_fail(base <= offset, NULL);
+	g_return_val_if_fail(offset <= end, NULL);
+
+	self = g_object_new(GMPD_TYPE_BINARY_RESPONSE, NULL);
+	self->buffer = g_byte_array_ref(buffer);
+	self->base = base;
+	self->offset = offset;
+	self->end = end;
+
+	return self;
+}
@@ -0,0 +1,83 @@
+/* libgmpd: MPD protocol implementation for GLib
+ * Copyright (C) 2020 Patrick Keating <binarydrifter@protonmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef __GMPD_BINARY_RESPONSE_H__
+#define __GMPD_BINARY_RESPONSE_H__
+
+#if !defined(__GMPD_BUILD__)
+#   error "This file is private to libgmpd and should not be included."
+#endif
+
+#include <gio/gio.h>
+#include <gmpd-response.h>
+
+G_BEGIN_DECLS
+
+#define GMPD_TYPE_BINARY_RESPONSE \
+	(gmpd_binary_response_get_type())
+
+#define GMPD_BINARY_RESPONSE(inst) \
+	(G_TYPE_CHECK_INSTANCE_CAST((inst), GMPD_TYPE_BINARY_RESPONSE, GMpdBinaryResponse))
+
+#define GMPD_BINARY_RESPONSE_CLASS(klass) \
+	(G_TYPE_CHECK_CLASS_CAST((klass), GMPD_TYPE_BINARY_RESPONSE, GMpdBinaryResponseClass))
+
+#define GMPD_IS_BINARY_RESPONSE(inst) \
+	(G_TYPE_CHECK_INSTANCE_TYPE((inst), GMPD_TYPE_BINARY_RESPONSE))
+
+#define GMPD_IS_BINARY_RESPONSE_CLASS(klass) \
+	(G_TYPE_CHECK_CLASS_TYPE((klass), GMPD_TYPE_BINARY_RESPONSE))
+
+#define GMPD_BINARY_RESPONSE_GET_CLASS(inst) \
+	(G_TYPE_INSTANCE_GET_CLASS((inst), GMPD_TYPE_BINARY_RESPONSE, GMpdBinaryResponseClass))
+
+typedef struct _GMpdBinaryResponse      GMpdBinaryResponse;
+typedef struct _GMpdBinaryResponseClass GMpdBinaryResponseClass;
+
+/* One chunk of an albumart or readpicture transfer. The chunk covers
+ * [offset, end) of the file and is copied straight into buffer, which
+ * holds the file from base onwards and is shared by all the chunks of
+ * the transfer. The first chunk to learn the size allocates it.
+ */
+struct _GMpdBinaryResponse {
+	GObject     __base__;
+	GByteArray *buffer;
+	gsize       base;
+	gsize       offset;
+	gsize       end;
+
+	gsize       size;
+	gsize       length;
+	gsize       received;
+	gsize       remaining;
+};
+
+struct _GMpdBinaryResponseClass {
+	GObjectClass __base__;
+};
+
+GType                 gmpd_binary_response_get_type  (void);
+
+GMpdBinaryResponse *  gmpd_binary_response_new       (GByteArray *buffer,
+                                                      gsize       base,
+                                                      gsize       offset,
+                                                      gsize       end);
+
+G_END_DECLS
+
+#endif /* __GMPD_BINARY_RESPONSE_H__ */
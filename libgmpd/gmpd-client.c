@@ -19,10 +19,19 @@
 #include <gio/gio.h>
 #include <gio/gunixsocketaddress.h>
 
+#include "gmpd-batch.h"
+#include "gmpd-batch-priv.h"
+#include "gmpd-binary-response.h"
 #include "gmpd-client.h"
+#include "gmpd-connection-state.h"
+#include "gmpd-entity.h"
+#include "gmpd-entity-list.h"
 #include "gmpd-error.h"
 #include "gmpd-idle.h"
 #include "gmpd-idle-response.h"
+#include "gmpd-input-buffer.h"
+#include "gmpd-metrics.h"
+#include "gmpd-metrics-priv.h"
 #include "gmpd-object.h"
 #include "gmpd-object-priv.h"
 #include "gmpd-protocol.h"
@@ -30,6 +39,7 @@
 #include "gmpd-song.h"
 #include "gmpd-stats.h"
 #include "gmpd-status.h"
+#include "gmpd-tag.h"
 #include "gmpd-version.h"
 #include "gmpd-void-response.h"
 
@@ -51,16 +61,24 @@
 #define IS_CANCELLED(err) \
 	g_error_matches((err), G_IO_ERROR, G_IO_ERROR_CANCELLED)
 
-#define RETURN_TASK(self, task, have_lock) G_STMT_START { \
+/* delays between reconnect attempts in milliseconds */
+#define RECONNECT_MIN_DELAY 100
+#define RECONNECT_MAX_DELAY 30000
+
+/* bounds of the binarylimit sent to the server in bytes */
+#define BINARY_CHUNK_MIN_SIZE 8192
+#define BINARY_CHUNK_MAX_SIZE 1048576
+#define BINARY_CHUNK_DEFAULT_SIZE 65536
+
+#define RETURN_TASK(self, task) G_STMT_START { \
 	gmpd_object_run_in_context(GMPD_OBJECT((self)), \
 	                           return_task, \
 	                           task, \
-	                           g_object_unref, \
-	                           (have_lock)); \
+	                           g_object_unref); \
 } G_STMT_END
 
 static void gmpd_client_initable_iface_init(GInitableIface *iface);
-static void gmpd_client_async_initable_iface_init(GAsyncInitable *iface);
+static void gmpd_client_async_initable_iface_init(GAsyncInitableIface *iface);
 
 static void gmpd_client_do_set_hostname(GMpdClient  *self,
                                         const gchar *hostname,
@@ -78,6 +96,25 @@ static void gmpd_client_do_set_timeout(GMpdClient *self,
                                        guint       timeout,
                                        gboolean    have_lock);
 
+static void gmpd_client_do_set_max_pending_commands(GMpdClient *self,
+                                                    guint       max_pending_commands,
+                                                    gboolean    have_lock);
+
+static void gmpd_client_do_set_max_pending_bytes(GMpdClient *self,
+                                                 guint       max_pending_bytes,
+                                                 gboolean    have_lock);
+
+static void gmpd_client_do_set_metrics_enabled(GMpdClient *self,
+                                               gboolean    metrics_enabled,
+                                               gboolean    have_lock);
+
+static void gmpd_client_do_set_reconnect(GMpdClient *self,
+                                         gboolean    reconnect,
+                                         gboolean    have_lock);
+
+static void gmpd_client_set_connection_state(GMpdClient         *self,
+                                             GMpdConnectionState connection_state);
+
 static void gmpd_client_do_set_version(GMpdClient  *self,
                                        GMpdVersion *version,
                                        gboolean     have_lock);
@@ -98,6 +135,14 @@ static gboolean gmpd_client_connect_to_server(GMpdClient   *self,
                                               GCancellable *cancellable,
                                               GError      **error);
 
+static GSocketConnectable *gmpd_client_new_connectable(GMpdClient *self);
+
+static void gmpd_client_setup_connection(GMpdClient        *self,
+                                         GSocketConnection *socket_connection);
+
+static gboolean gmpd_client_finish_init(GMpdClient *self,
+                                        GError    **error);
+
 static gboolean gmpd_client_receive_version(GMpdClient   *self,
                                             GCancellable *cancellable,
                                             GError      **error);
@@ -127,7 +172,57 @@ static GTask *gmpd_client_start_task(GMpdClient         *self,
                                      GAsyncReadyCallback callback,
                                      gpointer            user_data);
 
+static GTask *gmpd_client_new_task(GMpdClient         *self,
+                                   GMpdTaskData       *task_data,
+                                   GCancellable       *cancellable,
+                                   GAsyncReadyCallback callback,
+                                   gpointer            user_data);
+
+static void gmpd_client_queue_task(GMpdClient *self,
+                                   gboolean    have_lock,
+                                   GTask      *task);
+
+static void gmpd_client_write_task(GMpdClient *self,
+                                   GTask      *task);
+
+static GTask *gmpd_client_pop_task(GMpdClient *self);
+static gboolean gmpd_client_has_room(GMpdClient *self, gsize n_bytes);
+static gboolean gmpd_client_release_tasks(GMpdClient *self);
+static void gmpd_client_record_task(GMpdClient *self, GTask *task);
+static void gmpd_client_update_pipeline_full(GMpdClient *self);
+
+static GMpdResponse *gmpd_client_sync_task(GMpdClient   *self,
+                                           GTask        *task,
+                                           GCancellable *cancellable,
+                                           GError      **error);
+
+static GMpdClient *gmpd_client_ref_idle_client(GMpdClient   *self,
+                                               GMpdTaskData *task_data);
+
+static void gmpd_client_set_idle_client(GMpdClient *self,
+                                        GMpdClient *idle_client);
+
+static void gmpd_client_close_idle_client(GMpdClient *self);
+
 static void gmpd_client_do_disconnect(GMpdClient *self);
+static gboolean gmpd_client_will_reconnect(GMpdClient *self);
+static void gmpd_client_hold_tasks(GMpdClient *self);
+static void gmpd_client_fail_tasks(GMpdClient *self, GQueue *queue);
+static void gmpd_client_set_connected(GMpdClient *self);
+
+static gboolean gmpd_client_check_version(GMpdClient *self,
+                                          gint        major,
+                                          gint        minor,
+                                          gint        patch);
+
+static GTask *gmpd_client_new_tag_types_task(GMpdClient *self);
+static void gmpd_client_schedule_reconnect(GMpdClient *self);
+
+static gboolean gmpd_client_reconnect_sync(GMpdClient   *self,
+                                           GCancellable *cancellable,
+                                           GError      **error);
+
+static gboolean gmpd_client_on_reconnect_timeout(GMpdClient *self);
 static void gmpd_client_update_timeout(GMpdClient *self);
 static gboolean gmpd_client_is_idle(GMpdClient *self);
 static void gmpd_client_disable_timeout(GMpdClient *self);
@@ -151,23 +246,131 @@ static gboolean gmpd_client_on_socket_ready(GSocket     *socket,
                                             GIOCondition condition,
                                             GMpdClient  *self);
 
+static void on_socket_client_ready(GObject      *source_object,
+                                   GAsyncResult *result,
+                                   gpointer      user_data);
+
+static gboolean return_init_task(gpointer data);
+
+static void on_reconnect_ready(GObject      *source_object,
+                               GAsyncResult *result,
+                               gpointer      user_data);
+
+static void on_idle_client_ready(GObject      *source_object,
+                                 GAsyncResult *result,
+                                 gpointer      user_data);
+
 static gboolean return_task (gpointer data);
 
+static void gmpd_client_end_idle(GMpdClient *self);
+static gboolean end_idle_in_context(gpointer data);
+static void gmpd_client_emit_idle(GMpdClient *self, GMpdIdle changed);
+static gboolean gmpd_client_on_idle_window(GMpdClient *self);
+
+static void on_idle_watch_ready(GObject      *source_object,
+                                GAsyncResult *result,
+                                gpointer      user_data);
+
+typedef GMpdTaskData *(*BinaryTaskFunc) (const gchar        *uri,
+                                         GMpdBinaryResponse *response);
+
+typedef struct _BinaryRange {
+	gsize offset;
+	gsize end;
+} BinaryRange;
+
+/* State shared by the chunks of an albumart or readpicture transfer.
+ * The first chunk is requested on its own to learn the size and chunk
+ * size, then all the others are queued at once and pipelined.
+ */
+typedef struct _BinaryTransfer {
+	BinaryTaskFunc  new_task;
+	gchar          *uri;
+	GByteArray     *buffer;
+	gsize           base;
+	gsize           size;
+	gsize           chunk_size;
+	guint           n_pending;
+	GError         *error;
+
+	gint64          start_time;
+	gint64          round_trip_time;
+} BinaryTransfer;
+
+static BinaryTransfer *binary_transfer_new(BinaryTaskFunc  new_task,
+                                           const gchar    *uri,
+                                           gsize           offset);
+
+static void binary_transfer_free(BinaryTransfer *transfer);
+
+static void gmpd_client_start_binary_transfer(GMpdClient *self);
+
+static void gmpd_client_finish_binary_transfer(GMpdClient     *self,
+                                               BinaryTransfer *transfer);
+
+static GMpdTaskData *binary_transfer_new_task(BinaryTransfer *transfer,
+                                              gsize           offset,
+                                              gsize           end);
+
+static gboolean binary_transfer_complete_chunk(BinaryTransfer     *transfer,
+                                               GMpdBinaryResponse *response,
+                                               GArray             *ranges,
+                                               GError            **error);
+
+static GBytes *gmpd_client_run_binary_transfer(GMpdClient     *self,
+                                               BinaryTaskFunc  new_task,
+                                               const gchar    *uri,
+                                               gsize           offset,
+                                               GCancellable   *cancellable,
+                                               GError        **error);
+
+static void gmpd_client_run_binary_transfer_async(GMpdClient         *self,
+                                                  BinaryTaskFunc      new_task,
+                                                  const gchar        *uri,
+                                                  gsize               offset,
+                                                  GCancellable       *cancellable,
+                                                  GAsyncReadyCallback callback,
+                                                  gpointer            user_data);
+
+static void gmpd_client_queue_binary_chunks(GMpdClient *self,
+                                            GTask      *task,
+                                            GArray     *ranges);
+
+static void on_status_into_ready(GObject      *source_object,
+                                 GAsyncResult *result,
+                                 gpointer      user_data);
+
+static void on_binary_chunk_ready(GObject      *source_object,
+                                  GAsyncResult *result,
+                                  gpointer      user_data);
+
 enum {
 	PROP_NONE,
 	PROP_HOSTNAME,
 	PROP_PORT,
 	PROP_KEEPALIVE,
 	PROP_TIMEOUT,
+	PROP_MAX_PENDING_COMMANDS,
+	PROP_MAX_PENDING_BYTES,
+	PROP_PIPELINE_FULL,
+	PROP_METRICS_ENABLED,
+	PROP_RECONNECT,
+	PROP_CONNECTION_STATE,
 	PROP_VERSION,
+	PROP_IDLE_WINDOW,
 	N_PROPERTIES,
 };
 
+enum {
+	SIGNAL_IDLE,
+	N_SIGNALS,
+};
+
 struct _GMpdClient {
 	GMpdObject             __base__;
 
 	GSocketConnection     *socket_connection;
-	GDataInputStream      *input_stream;
+	GMpdInputBuffer       *input_buffer;
 	GBufferedOutputStream *output_stream;
 	GSource               *input_source;
 	GSource               *output_source;
@@ -178,7 +381,39 @@ struct _GMpdClient {
 	guint                  timeout;
 	GMpdVersion           *version;
 
+	guint                  max_pending_commands;
+	guint                  max_pending_bytes;
+	gboolean               pipeline_full;
+
 	GQueue                *task_queue;
+	GQueue                *wait_queue;
+	gsize                  task_bytes;
+
+	GMpdClient            *idle_client;
+	GSocket               *idle_socket;
+
+	GMpdMetrics           *metrics;
+
+	gboolean               reconnect;
+	gboolean               reconnecting;
+	gboolean               closing;
+	guint                  n_reconnect_attempts;
+	GSource               *reconnect_source;
+	GMpdConnectionState    connection_state;
+
+	guint32                tag_types;
+	gboolean               have_tag_types;
+
+	guint                  binary_limit;
+	guint                  binary_chunk_size;
+
+	guint                  idle_watchers;
+	gboolean               idle_armed;
+	guint                  idle_window;
+	GMpdIdle               idle_changed;
+	GSource               *idle_window_source;
+
+	GTask                 *init_task;
 };
 
 struct _GMpdClientClass {
@@ -192,6 +427,7 @@ G_DEFINE_TYPE_WITH_CODE(GMpdClient, gmpd_client, GMPD_TYPE_OBJECT,
                                               gmpd_client_async_initable_iface_init))
 
 static GParamSpec *PROPERTIES[N_PROPERTIES] = {NULL};
+static guint SIGNALS[N_SIGNALS] = {0};
 
 static gboolean
 gmpd_client_initable_init(GInitable    *initable,
@@ -206,10 +442,14 @@ gmpd_client_initable_init(GInitable    *initable,
 	gmpd_client_update_hostname(self);
 	gmpd_client_update_port(self);
 
+	gmpd_client_set_connection_state(self, GMPD_CONNECTION_CONNECTING);
+
 	result = gmpd_client_connect_to_server(self, cancellable, error) &&
 	         gmpd_client_receive_version(self, cancellable, error);
 
-	if (!result)
+	if (result)
+		gmpd_client_set_connected(self);
+	else
 		gmpd_client_do_disconnect(self);
 
 	UNLOCK(self);
@@ -222,10 +462,61 @@ gmpd_client_initable_iface_init(GInitableIface *iface)
 	iface->init = gmpd_client_initable_init;
 }
 
+/* The connection is made with g_socket_client_connect_async() and the
+ * welcome line is read from the input source, so neither blocks a
+ * worker thread. init_task is completed by gmpd_client_finish_init()
+ * once the welcome line has been read.
+ */
+static void
+gmpd_client_async_initable_init_async(GAsyncInitable     *initable,
+                                      gint                io_priority G_GNUC_UNUSED,
+                                      GCancellable       *cancellable,
+                                      GAsyncReadyCallback callback,
+                                      gpointer            user_data)
+{
+	GMpdClient *self = GMPD_CLIENT(initable);
+	GSocketConnectable *socket_connectable;
+	GSocketClient *socket_client;
+	GTask *task;
+
+	task = g_task_new(self, cancellable, callback, user_data);
+
+	LOCK(self);
+
+	gmpd_client_update_hostname(self);
+	gmpd_client_update_port(self);
+
+	gmpd_client_set_connection_state(self, GMPD_CONNECTION_CONNECTING);
+
+	socket_connectable = gmpd_client_new_connectable(self);
+
+	UNLOCK(self);
+
+	socket_client = g_socket_client_new();
+	g_socket_client_connect_async(socket_client,
+	                              socket_connectable,
+	                              cancellable,
+	                              on_socket_client_ready,
+	                              task);
+
+	g_object_unref(socket_connectable);
+	g_object_unref(socket_client);
+}
+
+static gboolean
+gmpd_client_async_initable_init_finish(GAsyncInitable *initable,
+                                       GAsyncResult   *result,
+                                       GError        **error)
+{
+	g_return_val_if_fail(g_task_is_valid(result, initable), FALSE);
+	return g_task_propagate_boolean(G_TASK(result), error);
+}
+
 static void
-gmpd_client_async_initable_iface_init(GAsyncInitable *iface G_GNUC_UNUSED)
+gmpd_client_async_initable_iface_init(GAsyncInitableIface *iface)
 {
-	/* use defaults */
+	iface->init_async = gmpd_client_async_initable_init_async;
+	iface->init_finish = gmpd_client_async_initable_init_finish;
 }
 
 static void
@@ -253,6 +544,26 @@ gmpd_client_set_property(GObject      *object,
 		gmpd_client_set_timeout(self, g_value_get_uint(value));
 		break;
 
+	case PROP_MAX_PENDING_COMMANDS:
+		gmpd_client_set_max_pending_commands(self, g_value_get_uint(value));
+		break;
+
+	case PROP_MAX_PENDING_BYTES:
+		gmpd_client_set_max_pending_bytes(self, g_value_get_uint(value));
+		break;
+
+	case PROP_METRICS_ENABLED:
+		gmpd_client_set_metrics_enabled(self, g_value_get_boolean(value));
+		break;
+
+	case PROP_RECONNECT:
+		gmpd_client_set_reconnect(self, g_value_get_boolean(value));
+		break;
+
+	case PROP_IDLE_WINDOW:
+		gmpd_client_set_idle_window(self, g_value_get_uint(value));
+		break;
+
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
 	}
@@ -283,10 +594,38 @@ gmpd_client_get_property(GObject    *object,
 		g_value_set_uint(value, gmpd_client_get_timeout(self));
 		break;
 
+	case PROP_MAX_PENDING_COMMANDS:
+		g_value_set_uint(value, gmpd_client_get_max_pending_commands(self));
+		break;
+
+	case PROP_MAX_PENDING_BYTES:
+		g_value_set_uint(value, gmpd_client_get_max_pending_bytes(self));
+		break;
+
+	case PROP_PIPELINE_FULL:
+		g_value_set_boolean(value, gmpd_client_get_pipeline_full(self));
+		break;
+
+	case PROP_METRICS_ENABLED:
+		g_value_set_boolean(value, gmpd_client_get_metrics_enabled(self));
+		break;
+
+	case PROP_RECONNECT:
+		g_value_set_boolean(value, gmpd_client_get_reconnect(self));
+		break;
+
+	case PROP_CONNECTION_STATE:
+		g_value_set_enum(value, gmpd_client_get_connection_state(self));
+		break;
+
 	case PROP_VERSION:
 		g_value_take_object(value, gmpd_client_get_version(self));
 		break;
 
+	case PROP_IDLE_WINDOW:
+		g_value_set_uint(value, gmpd_client_get_idle_window(self));
+		break;
+
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
 	}
@@ -300,7 +639,7 @@ gmpd_client_finalize(GObject *object)
 
 	gmpd_client_destroy_input_source(self);
 	gmpd_client_destroy_output_source(self);
-	g_clear_object(&self->input_stream);
+	g_clear_pointer(&self->input_buffer, gmpd_input_buffer_free);
 	g_clear_object(&self->output_stream);
 	g_clear_object(&self->socket_connection);
 
@@ -312,6 +651,25 @@ gmpd_client_finalize(GObject *object)
 
 	g_clear_pointer(&self->task_queue, g_queue_free);
 
+	while ((task = g_queue_pop_head(self->wait_queue)))
+		g_object_unref(task);
+
+	g_clear_pointer(&self->wait_queue, g_queue_free);
+
+	gmpd_client_close_idle_client(self);
+
+	g_clear_object(&self->metrics);
+
+	if (self->reconnect_source) {
+		g_source_destroy(self->reconnect_source);
+		g_clear_pointer(&self->reconnect_source, g_source_unref);
+	}
+
+	if (self->idle_window_source) {
+		g_source_destroy(self->idle_window_source);
+		g_clear_pointer(&self->idle_window_source, g_source_unref);
+	}
+
 	G_OBJECT_CLASS(gmpd_client_parent_class)->finalize(object);
 }
 
@@ -362,6 +720,61 @@ gmpd_client_class_init(GMpdClientClass *klass)
 		                  G_PARAM_EXPLICIT_NOTIFY |
 		                  G_PARAM_STATIC_STRINGS);
 
+	PROPERTIES[PROP_MAX_PENDING_COMMANDS] =
+		g_param_spec_uint("max-pending-commands",
+		                  "Max pending commands",
+		                  "Maximum number of commands awaiting a response, or 0 for no limit",
+		                  0, G_MAXUINT, 0,
+		                  G_PARAM_READWRITE |
+		                  G_PARAM_EXPLICIT_NOTIFY |
+		                  G_PARAM_STATIC_STRINGS);
+
+	PROPERTIES[PROP_MAX_PENDING_BYTES] =
+		g_param_spec_uint("max-pending-bytes",
+		                  "Max pending bytes",
+		                  "Maximum size of the commands awaiting a response, or 0 for no limit",
+		                  0, G_MAXUINT, 0,
+		                  G_PARAM_READWRITE |
+		                  G_PARAM_EXPLICIT_NOTIFY |
+		                  G_PARAM_STATIC_STRINGS);
+
+	PROPERTIES[PROP_PIPELINE_FULL] =
+		g_param_spec_boolean("pipeline-full",
+		                     "Pipeline full",
+		                     "Whether new commands have to wait for pending ones to complete",
+		                     FALSE,
+		                     G_PARAM_READABLE |
+		                     G_PARAM_EXPLICIT_NOTIFY |
+		                     G_PARAM_STATIC_STRINGS);
+
+	PROPERTIES[PROP_METRICS_ENABLED] =
+		g_param_spec_boolean("metrics-enabled",
+		                     "Metrics enabled",
+		                     "Collect latency and throughput metrics for each command",
+		                     FALSE,
+		                     G_PARAM_READWRITE |
+		                     G_PARAM_EXPLICIT_NOTIFY |
+		                     G_PARAM_STATIC_STRINGS);
+
+	PROPERTIES[PROP_RECONNECT] =
+		g_param_spec_boolean("reconnect",
+		                     "Reconnect",
+		                     "Reconnect automatically when the connection is lost",
+		                     FALSE,
+		                     G_PARAM_READWRITE |
+		                     G_PARAM_EXPLICIT_NOTIFY |
+		                     G_PARAM_STATIC_STRINGS);
+
+	PROPERTIES[PROP_CONNECTION_STATE] =
+		g_param_spec_enum("connection-state",
+		                  "Connection state",
+		                  "State of the connection to the MPD server",
+		                  GMPD_TYPE_CONNECTION_STATE,
+		                  GMPD_CONNECTION_DISCONNECTED,
+		                  G_PARAM_READABLE |
+		                  G_PARAM_EXPLICIT_NOTIFY |
+		                  G_PARAM_STATIC_STRINGS);
+
 	PROPERTIES[PROP_VERSION] =
 		g_param_spec_object("version",
 		                    "Version",
@@ -371,14 +784,35 @@ gmpd_client_class_init(GMpdClientClass *klass)
 		                    G_PARAM_EXPLICIT_NOTIFY |
 		                    G_PARAM_STATIC_STRINGS);
 
+	PROPERTIES[PROP_IDLE_WINDOW] =
+		g_param_spec_uint("idle-window",
+		                  "Idle window",
+		                  "Milliseconds over which idle events are collected before being emitted",
+		                  0, G_MAXUINT, 0,
+		                  G_PARAM_READWRITE |
+		                  G_PARAM_EXPLICIT_NOTIFY |
+		                  G_PARAM_STATIC_STRINGS);
+
 	g_object_class_install_properties(object_class, N_PROPERTIES, PROPERTIES);
+
+	/* emitted once for each changed subsystem, with the nick of the
+	 * subsystem without its "idle-" prefix as the detail
+	 */
+	SIGNALS[SIGNAL_IDLE] =
+		g_signal_new("idle",
+		             G_TYPE_FROM_CLASS(klass),
+		             G_SIGNAL_RUN_LAST | G_SIGNAL_DETAILED,
+		             0,
+		             NULL, NULL, NULL,
+		             G_TYPE_NONE,
+		             1, GMPD_TYPE_IDLE);
 }
 
 static void
 gmpd_client_init(GMpdClient *self)
 {
 	self->socket_connection = NULL;
-	self->input_stream = NULL;
+	self->input_buffer = NULL;
 	self->output_stream = NULL;
 	self->input_source = NULL;
 	self->output_source = NULL;
@@ -389,7 +823,39 @@ gmpd_client_init(GMpdClient *self)
 	self->timeout = 0;
 	self->version = NULL;
 
+	self->max_pending_commands = 0;
+	self->max_pending_bytes = 0;
+	self->pipeline_full = FALSE;
+
 	self->task_queue = g_queue_new();
+	self->wait_queue = g_queue_new();
+	self->task_bytes = 0;
+
+	self->idle_client = NULL;
+	self->idle_socket = NULL;
+
+	self->metrics = NULL;
+
+	self->reconnect = FALSE;
+	self->reconnecting = FALSE;
+	self->closing = FALSE;
+	self->n_reconnect_attempts = 0;
+	self->reconnect_source = NULL;
+	self->connection_state = GMPD_CONNECTION_DISCONNECTED;
+
+	self->tag_types = 0;
+	self->have_tag_types = FALSE;
+
+	self->binary_limit = 0;
+	self->binary_chunk_size = BINARY_CHUNK_DEFAULT_SIZE;
+
+	self->idle_watchers = 0;
+	self->idle_armed = FALSE;
+	self->idle_window = 0;
+	self->idle_changed = GMPD_IDLE_NONE;
+	self->idle_window_source = NULL;
+
+	self->init_task = NULL;
 }
 
 GMpdClient *
@@ -465,6 +931,117 @@ gmpd_client_set_timeout(GMpdClient *self,
 	gmpd_client_do_set_timeout(self, timeout, FALSE);
 }
 
+void
+gmpd_client_set_max_pending_commands(GMpdClient *self,
+                                     guint       max_pending_commands)
+{
+	g_return_if_fail(GMPD_IS_CLIENT(self));
+	gmpd_client_do_set_max_pending_commands(self, max_pending_commands, FALSE);
+}
+
+void
+gmpd_client_set_max_pending_bytes(GMpdClient *self,
+                                  guint       max_pending_bytes)
+{
+	g_return_if_fail(GMPD_IS_CLIENT(self));
+	gmpd_client_do_set_max_pending_bytes(self, max_pending_bytes, FALSE);
+}
+
+void
+gmpd_client_set_metrics_enabled(GMpdClient *self,
+                                gboolean    metrics_enabled)
+{
+	g_return_if_fail(GMPD_IS_CLIENT(self));
+	gmpd_client_do_set_metrics_enabled(self, metrics_enabled, FALSE);
+}
+
+void
+gmpd_client_set_reconnect(GMpdClient *self,
+                          gboolean    reconnect)
+{
+	g_return_if_fail(GMPD_IS_CLIENT(self));
+	gmpd_client_do_set_reconnect(self, reconnect, FALSE);
+}
+
+void
+gmpd_client_set_idle_window(GMpdClient *self,
+                            guint       idle_window)
+{
+	g_return_if_fail(GMPD_IS_CLIENT(self));
+
+	LOCK(self);
+
+	if (self->idle_window != idle_window) {
+		self->idle_window = idle_window;
+		NOTIFY(self, PROP_IDLE_WINDOW);
+	}
+
+	UNLOCK(self);
+}
+
+/* Limits the tags sent with each song to the given ones, which makes
+ * large listings a lot cheaper. The set is sent again after every
+ * reconnect. Needs MPD 0.21, older servers keep sending every tag.
+ */
+void
+gmpd_client_set_tag_types(GMpdClient    *self,
+                          const GMpdTag *tags,
+                          gsize          n_tags)
+{
+	guint32 tag_types = 0;
+	GTask *task = NULL;
+	gsize i;
+
+	g_return_if_fail(GMPD_IS_CLIENT(self));
+	g_return_if_fail(tags != NULL || n_tags == 0);
+
+	for (i = 0; i < n_tags; i++) {
+		g_return_if_fail(GMPD_TAG_IS_VALID(tags[i]));
+		tag_types |= 1u << tags[i];
+	}
+
+	LOCK(self);
+
+	self->tag_types = tag_types;
+	self->have_tag_types = TRUE;
+
+	if (self->connection_state == GMPD_CONNECTION_CONNECTED)
+		task = gmpd_client_new_tag_types_task(self);
+
+	if (task) {
+		gmpd_client_queue_task(self, TRUE, task);
+		g_object_unref(task);
+	}
+
+	UNLOCK(self);
+}
+
+void
+gmpd_client_reset_tag_types(GMpdClient *self)
+{
+	GTask *task = NULL;
+
+	g_return_if_fail(GMPD_IS_CLIENT(self));
+
+	LOCK(self);
+
+	if (self->have_tag_types) {
+		self->tag_types = (1u << GMPD_N_TAGS) - 1;
+
+		if (self->connection_state == GMPD_CONNECTION_CONNECTED)
+			task = gmpd_client_new_tag_types_task(self);
+
+		self->have_tag_types = FALSE;
+	}
+
+	if (task) {
+		gmpd_client_queue_task(self, TRUE, task);
+		g_object_unref(task);
+	}
+
+	UNLOCK(self);
+}
+
 gchar *
 gmpd_client_get_hostname(GMpdClient *self)
 {
@@ -529,50 +1106,187 @@ gmpd_client_get_timeout(GMpdClient *self)
 	return timeout;
 }
 
-GMpdVersion *
-gmpd_client_get_version(GMpdClient *self)
+guint
+gmpd_client_get_max_pending_commands(GMpdClient *self)
 {
-	GMpdVersion *version;
+	guint max_pending_commands;
 
-	g_return_val_if_fail(GMPD_IS_CLIENT(self), NULL);
+	g_return_val_if_fail(GMPD_IS_CLIENT(self), 0);
 
 	LOCK(self);
 
-	version = self->version ? g_object_ref(self->version) : NULL;
+	max_pending_commands = self->max_pending_commands;
 
 	UNLOCK(self);
 
-	return version;
+	return max_pending_commands;
 }
 
-gboolean
-gmpd_client_close(GMpdClient   *self,
-                  GCancellable *cancellable,
-                  GError      **error)
+guint
+gmpd_client_get_max_pending_bytes(GMpdClient *self)
 {
-	GError *err = NULL;
-	GMpdResponse *response;
-	gboolean retval;
+	guint max_pending_bytes;
 
-	g_return_val_if_fail(GMPD_IS_CLIENT(self), FALSE);
-	g_return_val_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable), FALSE);
-	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+	g_return_val_if_fail(GMPD_IS_CLIENT(self), 0);
 
-	response = gmpd_client_run_task(self, FALSE, gmpd_protocol_close(), cancellable, &err);
-	g_warn_if_fail(response == NULL);
+	LOCK(self);
 
-	if (err) {
-		retval = FALSE;
-		g_propagate_error(error, err);
-	} else {
-		retval = TRUE;
-	}
+	max_pending_bytes = self->max_pending_bytes;
 
-	return retval;
+	UNLOCK(self);
+
+	return max_pending_bytes;
 }
 
-void
-gmpd_client_close_async(GMpdClient         *self,
+gboolean
+gmpd_client_get_pipeline_full(GMpdClient *self)
+{
+	gboolean pipeline_full;
+
+	g_return_val_if_fail(GMPD_IS_CLIENT(self), FALSE);
+
+	LOCK(self);
+
+	pipeline_full = self->pipeline_full;
+
+	UNLOCK(self);
+
+	return pipeline_full;
+}
+
+gboolean
+gmpd_client_get_metrics_enabled(GMpdClient *self)
+{
+	gboolean metrics_enabled;
+
+	g_return_val_if_fail(GMPD_IS_CLIENT(self), FALSE);
+
+	LOCK(self);
+
+	metrics_enabled = self->metrics != NULL;
+
+	UNLOCK(self);
+
+	return metrics_enabled;
+}
+
+/* Returns a snapshot, so it can be read at leisure while the client
+ * keeps collecting.
+ */
+GMpdMetrics *
+gmpd_client_get_metrics(GMpdClient *self)
+{
+	GMpdMetrics *metrics = NULL;
+
+	g_return_val_if_fail(GMPD_IS_CLIENT(self), NULL);
+
+	LOCK(self);
+
+	if (self->metrics) {
+		gmpd_metrics_set_pipeline_depth(self->metrics,
+		                                self->task_queue->length,
+		                                self->wait_queue->length);
+
+		metrics = gmpd_metrics_copy(self->metrics);
+	}
+
+	UNLOCK(self);
+
+	return metrics;
+}
+
+gboolean
+gmpd_client_get_reconnect(GMpdClient *self)
+{
+	gboolean reconnect;
+
+	g_return_val_if_fail(GMPD_IS_CLIENT(self), FALSE);
+
+	LOCK(self);
+
+	reconnect = self->reconnect;
+
+	UNLOCK(self);
+
+	return reconnect;
+}
+
+guint
+gmpd_client_get_idle_window(GMpdClient *self)
+{
+	guint idle_window;
+
+	g_return_val_if_fail(GMPD_IS_CLIENT(self), 0);
+
+	LOCK(self);
+
+	idle_window = self->idle_window;
+
+	UNLOCK(self);
+
+	return idle_window;
+}
+
+GMpdConnectionState
+gmpd_client_get_connection_state(GMpdClient *self)
+{
+	GMpdConnectionState connection_state;
+
+	g_return_val_if_fail(GMPD_IS_CLIENT(self), GMPD_CONNECTION_DISCONNECTED);
+
+	LOCK(self);
+
+	connection_state = self->connection_state;
+
+	UNLOCK(self);
+
+	return connection_state;
+}
+
+GMpdVersion *
+gmpd_client_get_version(GMpdClient *self)
+{
+	GMpdVersion *version;
+
+	g_return_val_if_fail(GMPD_IS_CLIENT(self), NULL);
+
+	LOCK(self);
+
+	version = self->version ? g_object_ref(self->version) : NULL;
+
+	UNLOCK(self);
+
+	return version;
+}
+
+gboolean
+gmpd_client_close(GMpdClient   *self,
+                  GCancellable *cancellable,
+                  GError      **error)
+{
+	GError *err = NULL;
+	GMpdResponse *response;
+	gboolean retval;
+
+	g_return_val_if_fail(GMPD_IS_CLIENT(self), FALSE);
+	g_return_val_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable), FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	response = gmpd_client_run_task(self, FALSE, gmpd_protocol_close(), cancellable, &err);
+	g_warn_if_fail(response == NULL);
+
+	if (err) {
+		retval = FALSE;
+		g_propagate_error(error, err);
+	} else {
+		retval = TRUE;
+	}
+
+	return retval;
+}
+
+void
+gmpd_client_close_async(GMpdClient         *self,
                         GCancellable       *cancellable,
                         GAsyncReadyCallback callback,
                         gpointer            user_data)
@@ -619,6 +1333,111 @@ gmpd_client_close_finish(GMpdClient   *self,
 	return retval;
 }
 
+gboolean
+gmpd_client_open_idle_connection(GMpdClient   *self,
+                                 GCancellable *cancellable,
+                                 GError      **error)
+{
+	GMpdClient *idle_client;
+	gchar *hostname;
+	guint16 port;
+	gboolean keepalive;
+
+	g_return_val_if_fail(GMPD_IS_CLIENT(self), FALSE);
+	g_return_val_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable), FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	LOCK(self);
+
+	if (!self->socket_connection) {
+		g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_CLOSED, "The client is closed");
+		UNLOCK(self);
+		return FALSE;
+	}
+
+	hostname = g_strdup(self->hostname);
+	port = self->port;
+	keepalive = self->keepalive;
+
+	UNLOCK(self);
+
+	idle_client = g_initable_new(GMPD_TYPE_CLIENT, cancellable, error,
+	                             "context",   GMPD_OBJECT(self)->context,
+	                             "hostname",  hostname,
+	                             "port",      port,
+	                             "keepalive", keepalive, NULL);
+
+	g_free(hostname);
+
+	if (!idle_client)
+		return FALSE;
+
+	gmpd_client_set_idle_client(self, idle_client);
+	g_object_unref(idle_client);
+
+	return TRUE;
+}
+
+void
+gmpd_client_open_idle_connection_async(GMpdClient         *self,
+                                       GCancellable       *cancellable,
+                                       GAsyncReadyCallback callback,
+                                       gpointer            user_data)
+{
+	GTask *task;
+	gchar *hostname;
+	guint16 port;
+	gboolean keepalive;
+
+	g_return_if_fail(GMPD_IS_CLIENT(self));
+	g_return_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable));
+	g_return_if_fail(callback != NULL || user_data == NULL);
+
+	task = g_task_new(self, cancellable, callback, user_data);
+
+	LOCK(self);
+
+	if (!self->socket_connection) {
+		UNLOCK(self);
+
+		g_task_return_new_error(task, G_IO_ERROR, G_IO_ERROR_CLOSED, "The client is closed");
+		g_object_unref(task);
+		return;
+	}
+
+	hostname = g_strdup(self->hostname);
+	port = self->port;
+	keepalive = self->keepalive;
+
+	UNLOCK(self);
+
+	g_async_initable_new_async(GMPD_TYPE_CLIENT, G_PRIORITY_DEFAULT,
+	                           cancellable, on_idle_client_ready, task,
+	                           "context",   GMPD_OBJECT(self)->context,
+	                           "hostname",  hostname,
+	                           "port",      port,
+	                           "keepalive", keepalive, NULL);
+
+	g_free(hostname);
+}
+
+gboolean
+gmpd_client_open_idle_connection_finish(GMpdClient   *self,
+                                        GAsyncResult *result,
+                                        GError      **error)
+{
+	GTask *task;
+
+	g_return_val_if_fail(GMPD_IS_CLIENT(self), FALSE);
+	g_return_val_if_fail(G_IS_TASK(result), FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	task = G_TASK(result);
+	g_return_val_if_fail(g_task_get_source_object(task) == self, FALSE);
+
+	return g_task_propagate_boolean(task, error);
+}
+
 gboolean
 gmpd_client_clearerror(GMpdClient   *self,
                        GCancellable *cancellable,
@@ -755,6 +1574,89 @@ gmpd_client_idle_async(GMpdClient         *self,
 	                           user_data);
 }
 
+/* Keeps an idle pending and emits the idle signal for whatever it
+ * reports. The next idle is sent before the signals are emitted, so no
+ * event is lost while handlers run. With an idle-window, events are
+ * collected from the first one on and emitted together when it ends.
+ *
+ * Every start needs a matching stop, the watch runs until the last one
+ * or until the connection is closed.
+ */
+void
+gmpd_client_start_idle_watch(GMpdClient *self)
+{
+	gboolean arm;
+
+	g_return_if_fail(GMPD_IS_CLIENT(self));
+
+	LOCK(self);
+
+	self->idle_watchers++;
+	arm = !self->idle_armed;
+	self->idle_armed = TRUE;
+
+	UNLOCK(self);
+
+	if (arm)
+		gmpd_client_idle_async(self, GMPD_IDLE_ALL, NULL, on_idle_watch_ready, NULL);
+}
+
+void
+gmpd_client_stop_idle_watch(GMpdClient *self)
+{
+	GMpdClient *idle_client = NULL;
+
+	g_return_if_fail(GMPD_IS_CLIENT(self));
+
+	LOCK(self);
+
+	if (!self->idle_watchers || --self->idle_watchers) {
+		UNLOCK(self);
+		return;
+	}
+
+	self->idle_changed = GMPD_IDLE_NONE;
+
+	if (self->idle_window_source) {
+		g_source_destroy(self->idle_window_source);
+		g_clear_pointer(&self->idle_window_source, g_source_unref);
+	}
+
+	/* the pending idle is on the idle connection if there is one */
+	if (self->idle_armed) {
+		gmpd_client_end_idle(self);
+
+		if (self->idle_client)
+			idle_client = g_object_ref(self->idle_client);
+	}
+
+	UNLOCK(self);
+
+	/* a blocking idle holds the idle client's lock until it returns */
+	if (idle_client) {
+		gmpd_object_run_in_context(GMPD_OBJECT(idle_client),
+		                           end_idle_in_context,
+		                           idle_client,
+		                           g_object_unref);
+	}
+}
+
+gboolean
+gmpd_client_get_idle_watching(GMpdClient *self)
+{
+	gboolean idle_watching;
+
+	g_return_val_if_fail(GMPD_IS_CLIENT(self), FALSE);
+
+	LOCK(self);
+
+	idle_watching = self->idle_watchers > 0;
+
+	UNLOCK(self);
+
+	return idle_watching;
+}
+
 GMpdStatus *
 gmpd_client_status(GMpdClient   *self,
                    GCancellable *cancellable,
@@ -793,16 +1695,89 @@ gmpd_client_status_async(GMpdClient         *self,
 	                           user_data);
 }
 
-GMpdStats *
-gmpd_client_stats(GMpdClient   *self,
-                  GCancellable *cancellable,
-                  GError      **error)
+/* Reads the status into an existing object instead of a new one, only
+ * the properties that changed are notified. The response is parsed
+ * into a status of its own and copied over once the command is done,
+ * so status is never touched with the client locked or after a failed
+ * command. The async variant is finished with
+ * gmpd_client_finish_status_response(), which returns status itself.
+ */
+gboolean
+gmpd_client_status_into(GMpdClient   *self,
+                        GMpdStatus   *status,
+                        GCancellable *cancellable,
+                        GError      **error)
 {
-	GMpdResponse *response;
-
-	g_return_val_if_fail(GMPD_IS_CLIENT(self), NULL);
-	g_return_val_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable), NULL);
-	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+	GMpdStatus *response;
+
+	g_return_val_if_fail(GMPD_IS_CLIENT(self), FALSE);
+	g_return_val_if_fail(GMPD_IS_STATUS(status), FALSE);
+	g_return_val_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable), FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	response = gmpd_client_status(self, cancellable, error);
+	if (!response)
+		return FALSE;
+
+	gmpd_status_update(status, response);
+
+	g_object_unref(response);
+	return TRUE;
+}
+
+void
+gmpd_client_status_into_async(GMpdClient         *self,
+                              GMpdStatus         *status,
+                              GCancellable       *cancellable,
+                              GAsyncReadyCallback callback,
+                              gpointer            user_data)
+{
+	GTask *task;
+
+	g_return_if_fail(GMPD_IS_CLIENT(self));
+	g_return_if_fail(GMPD_IS_STATUS(status));
+	g_return_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable));
+	g_return_if_fail(callback != NULL || user_data == NULL);
+
+	task = g_task_new(self, cancellable, callback, user_data);
+	g_task_set_task_data(task, g_object_ref(status), g_object_unref);
+
+	gmpd_client_status_async(self, cancellable, on_status_into_ready, task);
+}
+
+static void
+on_status_into_ready(GObject      *source_object,
+                     GAsyncResult *result,
+                     gpointer      user_data)
+{
+	GTask *task = G_TASK(user_data);
+	GMpdStatus *status = g_task_get_task_data(task);
+	GMpdStatus *response;
+	GError *error = NULL;
+
+	response = gmpd_client_finish_status_response(GMPD_CLIENT(source_object), result, &error);
+
+	if (response) {
+		gmpd_status_update(status, response);
+		g_task_return_pointer(task, g_object_ref(status), g_object_unref);
+		g_object_unref(response);
+	} else {
+		g_task_return_error(task, error);
+	}
+
+	g_object_unref(task);
+}
+
+GMpdStats *
+gmpd_client_stats(GMpdClient   *self,
+                  GCancellable *cancellable,
+                  GError      **error)
+{
+	GMpdResponse *response;
+
+	g_return_val_if_fail(GMPD_IS_CLIENT(self), NULL);
+	g_return_val_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable), NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
 
 	response = gmpd_client_run_task(self,
 	                                FALSE,
@@ -924,117 +1899,264 @@ gmpd_client_replay_gain_status_async(GMpdClient         *self,
 
 }
 
-GMpdSong *
-gmpd_client_finish_song_response(GMpdClient   *self,
-                                 GAsyncResult *result,
-                                 GError      **error)
+GPtrArray *
+gmpd_client_playlistinfo(GMpdClient   *self,
+                         GCancellable *cancellable,
+                         GError      **error)
 {
-	GTask *task;
-	gpointer retval;
+	GMpdResponse *response;
+	GPtrArray *retval;
 
 	g_return_val_if_fail(GMPD_IS_CLIENT(self), NULL);
-	g_return_val_if_fail(G_IS_TASK(result), NULL);
+	g_return_val_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable), NULL);
 	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
 
-	task = G_TASK(result);
-	g_return_val_if_fail(g_task_get_source_object(task) == self, NULL);
+	response = gmpd_client_run_task(self,
+	                                FALSE,
+	                                gmpd_protocol_playlistinfo(),
+	                                cancellable,
+	                                error);
 
-	retval = g_task_propagate_pointer(task, error);
-	g_return_val_if_fail(retval == NULL || GMPD_IS_SONG(retval), NULL);
+	if (!response)
+		return NULL;
 
-	return retval ? GMPD_SONG(retval) : NULL;
+	retval = gmpd_entity_list_steal_entities(GMPD_ENTITY_LIST(response));
+
+	g_object_unref(response);
+
+	return retval;
 }
 
-GMpdIdle
-gmpd_client_finish_idle_response(GMpdClient   *self,
-                                 GAsyncResult *result,
-                                 GError      **error)
+void
+gmpd_client_playlistinfo_async(GMpdClient         *self,
+                               GCancellable       *cancellable,
+                               GAsyncReadyCallback callback,
+                               gpointer            user_data)
 {
-	GTask *task;
-	gpointer idle_resp;
-	GMpdIdle retval;
+	g_return_if_fail(GMPD_IS_CLIENT(self));
+	g_return_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable));
+	g_return_if_fail(callback != NULL || user_data == NULL);
 
-	g_return_val_if_fail(GMPD_IS_CLIENT(self), GMPD_IDLE_NONE);
-	g_return_val_if_fail(G_IS_TASK(result), GMPD_IDLE_NONE);
-	g_return_val_if_fail(error == NULL || *error == NULL, GMPD_IDLE_NONE);
+	gmpd_client_run_task_async(self,
+	                           FALSE,
+	                           gmpd_protocol_playlistinfo(),
+	                           cancellable,
+	                           callback,
+	                           user_data);
+}
 
-	task = G_TASK(result);
-	g_return_val_if_fail(g_task_get_source_object(task) == self, GMPD_IDLE_NONE);
+void
+gmpd_client_playlistinfo_foreach_async(GMpdClient         *self,
+                                       GMpdEntityFunc      func,
+                                       gpointer            func_data,
+                                       GCancellable       *cancellable,
+                                       GAsyncReadyCallback callback,
+                                       gpointer            user_data)
+{
+	GMpdTaskData *data;
 
-	idle_resp = g_task_propagate_pointer(task, error);
-	g_return_val_if_fail(idle_resp == NULL || GMPD_IS_IDLE_RESPONSE(idle_resp), GMPD_IDLE_NONE);
+	g_return_if_fail(GMPD_IS_CLIENT(self));
+	g_return_if_fail(func != NULL);
+	g_return_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable));
+	g_return_if_fail(callback != NULL || user_data == NULL);
 
-	if (!idle_resp)
-		return GMPD_IDLE_NONE;
+	data = gmpd_protocol_playlistinfo();
+	gmpd_entity_list_set_func(GMPD_ENTITY_LIST(data->response),
+	                          GMPD_OBJECT(self),
+	                          func,
+	                          func_data);
 
-	retval = gmpd_idle_response_get_changed(GMPD_IDLE_RESPONSE(idle_resp));
+	gmpd_client_run_task_async(self,
+	                           FALSE,
+	                           data,
+	                           cancellable,
+	                           callback,
+	                           user_data);
+}
 
-	g_object_unref(idle_resp);
+GPtrArray *
+gmpd_client_listallinfo(GMpdClient   *self,
+                        const gchar  *path,
+                        GCancellable *cancellable,
+                        GError      **error)
+{
+	GMpdResponse *response;
+	GPtrArray *retval;
+
+	g_return_val_if_fail(GMPD_IS_CLIENT(self), NULL);
+	g_return_val_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable), NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	response = gmpd_client_run_task(self,
+	                                FALSE,
+	                                gmpd_protocol_listallinfo(path),
+	                                cancellable,
+	                                error);
+
+	if (!response)
+		return NULL;
+
+	retval = gmpd_entity_list_steal_entities(GMPD_ENTITY_LIST(response));
+
+	g_object_unref(response);
 
 	return retval;
 }
 
-GMpdStatus *
-gmpd_client_finish_status_response(GMpdClient   *self,
-                                   GAsyncResult *result,
-                                   GError      **error)
+void
+gmpd_client_listallinfo_async(GMpdClient         *self,
+                              const gchar        *path,
+                              GCancellable       *cancellable,
+                              GAsyncReadyCallback callback,
+                              gpointer            user_data)
 {
-	GTask *task;
-	gpointer retval;
+	g_return_if_fail(GMPD_IS_CLIENT(self));
+	g_return_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable));
+	g_return_if_fail(callback != NULL || user_data == NULL);
+
+	gmpd_client_run_task_async(self,
+	                           FALSE,
+	                           gmpd_protocol_listallinfo(path),
+	                           cancellable,
+	                           callback,
+	                           user_data);
+}
+
+void
+gmpd_client_listallinfo_foreach_async(GMpdClient         *self,
+                                      const gchar        *path,
+                                      GMpdEntityFunc      func,
+                                      gpointer            func_data,
+                                      GCancellable       *cancellable,
+                                      GAsyncReadyCallback callback,
+                                      gpointer            user_data)
+{
+	GMpdTaskData *data;
+
+	g_return_if_fail(GMPD_IS_CLIENT(self));
+	g_return_if_fail(func != NULL);
+	g_return_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable));
+	g_return_if_fail(callback != NULL || user_data == NULL);
+
+	data = gmpd_protocol_listallinfo(path);
+	gmpd_entity_list_set_func(GMPD_ENTITY_LIST(data->response),
+	                          GMPD_OBJECT(self),
+	                          func,
+	                          func_data);
+
+	gmpd_client_run_task_async(self,
+	                           FALSE,
+	                           data,
+	                           cancellable,
+	                           callback,
+	                           user_data);
+}
 
+GBytes *
+gmpd_client_albumart(GMpdClient   *self,
+                     const gchar  *uri,
+                     gsize         offset,
+                     GCancellable *cancellable,
+                     GError      **error)
+{
 	g_return_val_if_fail(GMPD_IS_CLIENT(self), NULL);
-	g_return_val_if_fail(G_IS_TASK(result), NULL);
+	g_return_val_if_fail(uri != NULL, NULL);
+	g_return_val_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable), NULL);
 	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
 
-	task = G_TASK(result);
-	g_return_val_if_fail(g_task_get_source_object(task) == self, NULL);
+	return gmpd_client_run_binary_transfer(self,
+	                                       gmpd_protocol_albumart,
+	                                       uri,
+	                                       offset,
+	                                       cancellable,
+	                                       error);
+}
 
-	retval = g_task_propagate_pointer(task, error);
-	g_return_val_if_fail(retval == NULL || GMPD_IS_STATUS(retval), NULL);
+void
+gmpd_client_albumart_async(GMpdClient         *self,
+                           const gchar        *uri,
+                           gsize               offset,
+                           GCancellable       *cancellable,
+                           GAsyncReadyCallback callback,
+                           gpointer            user_data)
+{
+	g_return_if_fail(GMPD_IS_CLIENT(self));
+	g_return_if_fail(uri != NULL);
+	g_return_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable));
+	g_return_if_fail(callback != NULL || user_data == NULL);
 
-	return retval ? GMPD_STATUS(retval) : NULL;
+	gmpd_client_run_binary_transfer_async(self,
+	                                      gmpd_protocol_albumart,
+	                                      uri,
+	                                      offset,
+	                                      cancellable,
+	                                      callback,
+	                                      user_data);
 }
 
-GMpdStats *
-gmpd_client_finish_stats_response(GMpdClient   *self,
-                                  GAsyncResult *result,
-                                  GError      **error)
+GBytes *
+gmpd_client_readpicture(GMpdClient   *self,
+                        const gchar  *uri,
+                        gsize         offset,
+                        GCancellable *cancellable,
+                        GError      **error)
 {
-	GTask *task;
-	gpointer retval;
-
 	g_return_val_if_fail(GMPD_IS_CLIENT(self), NULL);
-	g_return_val_if_fail(G_IS_TASK(result), NULL);
+	g_return_val_if_fail(uri != NULL, NULL);
+	g_return_val_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable), NULL);
 	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
 
-	task = G_TASK(result);
-	g_return_val_if_fail(g_task_get_source_object(task) == self, NULL);
+	return gmpd_client_run_binary_transfer(self,
+	                                       gmpd_protocol_readpicture,
+	                                       uri,
+	                                       offset,
+	                                       cancellable,
+	                                       error);
+}
 
-	retval = g_task_propagate_pointer(task, error);
-	g_return_val_if_fail(retval == NULL || GMPD_IS_STATS(retval), NULL);
+void
+gmpd_client_readpicture_async(GMpdClient         *self,
+                              const gchar        *uri,
+                              gsize               offset,
+                              GCancellable       *cancellable,
+                              GAsyncReadyCallback callback,
+                              gpointer            user_data)
+{
+	g_return_if_fail(GMPD_IS_CLIENT(self));
+	g_return_if_fail(uri != NULL);
+	g_return_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable));
+	g_return_if_fail(callback != NULL || user_data == NULL);
 
-	return retval ? GMPD_STATS(retval) : NULL;
+	gmpd_client_run_binary_transfer_async(self,
+	                                      gmpd_protocol_readpicture,
+	                                      uri,
+	                                      offset,
+	                                      cancellable,
+	                                      callback,
+	                                      user_data);
 }
 
 gboolean
-gmpd_client_finish_void_response(GMpdClient   *self,
-                                 GAsyncResult *result,
-                                 GError      **error)
+gmpd_client_batch(GMpdClient   *self,
+                  GMpdBatch    *batch,
+                  GCancellable *cancellable,
+                  GError      **error)
 {
-	GTask *task;
-	GMpdVoidResponse *response;
+	GMpdResponse *response;
 	GError *err = NULL;
 	gboolean retval;
 
 	g_return_val_if_fail(GMPD_IS_CLIENT(self), FALSE);
-	g_return_val_if_fail(G_IS_TASK(result), FALSE);
+	g_return_val_if_fail(GMPD_IS_BATCH(batch), FALSE);
+	g_return_val_if_fail(!batch->sent, FALSE);
+	g_return_val_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable), FALSE);
 	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
 
-	task = G_TASK(self);
-	g_return_val_if_fail(g_task_get_source_object(task) == self, FALSE);
-
-	response = g_task_propagate_pointer(task, &err);
-	g_return_val_if_fail(response == NULL || GMPD_IS_VOID_RESPONSE(response), FALSE);
+	response = gmpd_client_run_task(self,
+	                                FALSE,
+	                                gmpd_protocol_batch(batch),
+	                                cancellable,
+	                                &err);
 
 	g_clear_object(&response);
 
@@ -1048,19 +2170,185 @@ gmpd_client_finish_void_response(GMpdClient   *self,
 	return retval;
 }
 
-GMpdReplayGainStatus *
-gmpd_client_finish_replay_gain_status_response(GMpdClient   *self,
-                                               GAsyncResult *result,
-                                               GError      **error)
+void
+gmpd_client_batch_async(GMpdClient         *self,
+                        GMpdBatch          *batch,
+                        GCancellable       *cancellable,
+                        GAsyncReadyCallback callback,
+                        gpointer            user_data)
 {
-	GTask *task;
-	GMpdReplayGainStatus *response;
+	g_return_if_fail(GMPD_IS_CLIENT(self));
+	g_return_if_fail(GMPD_IS_BATCH(batch));
+	g_return_if_fail(!batch->sent);
+	g_return_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable));
+	g_return_if_fail(callback != NULL || user_data == NULL);
 
-	g_return_val_if_fail(GMPD_IS_CLIENT(self), NULL);
-	g_return_val_if_fail(G_IS_TASK(result), NULL);
-	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+	gmpd_client_run_task_async(self,
+	                           FALSE,
+	                           gmpd_protocol_batch(batch),
+	                           cancellable,
+	                           callback,
+	                           user_data);
+}
 
-	task = G_TASK(result);
+GMpdBatch *
+gmpd_client_finish_batch_response(GMpdClient   *self,
+                                  GAsyncResult *result,
+                                  GError      **error)
+{
+	GTask *task;
+	gpointer retval;
+
+	g_return_val_if_fail(GMPD_IS_CLIENT(self), NULL);
+	g_return_val_if_fail(G_IS_TASK(result), NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	task = G_TASK(result);
+	g_return_val_if_fail(g_task_get_source_object(task) == self, NULL);
+
+	retval = g_task_propagate_pointer(task, error);
+	g_return_val_if_fail(retval == NULL || GMPD_IS_BATCH(retval), NULL);
+
+	return retval ? GMPD_BATCH(retval) : NULL;
+}
+
+GMpdSong *
+gmpd_client_finish_song_response(GMpdClient   *self,
+                                 GAsyncResult *result,
+                                 GError      **error)
+{
+	GTask *task;
+	gpointer retval;
+
+	g_return_val_if_fail(GMPD_IS_CLIENT(self), NULL);
+	g_return_val_if_fail(G_IS_TASK(result), NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	task = G_TASK(result);
+	g_return_val_if_fail(g_task_get_source_object(task) == self, NULL);
+
+	retval = g_task_propagate_pointer(task, error);
+	g_return_val_if_fail(retval == NULL || GMPD_IS_SONG(retval), NULL);
+
+	return retval ? GMPD_SONG(retval) : NULL;
+}
+
+GMpdIdle
+gmpd_client_finish_idle_response(GMpdClient   *self,
+                                 GAsyncResult *result,
+                                 GError      **error)
+{
+	GTask *task;
+	gpointer idle_resp;
+	GMpdIdle retval;
+
+	g_return_val_if_fail(GMPD_IS_CLIENT(self), GMPD_IDLE_NONE);
+	g_return_val_if_fail(G_IS_TASK(result), GMPD_IDLE_NONE);
+	g_return_val_if_fail(error == NULL || *error == NULL, GMPD_IDLE_NONE);
+
+	task = G_TASK(result);
+	g_return_val_if_fail(g_task_get_source_object(task) == self, GMPD_IDLE_NONE);
+
+	idle_resp = g_task_propagate_pointer(task, error);
+	g_return_val_if_fail(idle_resp == NULL || GMPD_IS_IDLE_RESPONSE(idle_resp), GMPD_IDLE_NONE);
+
+	if (!idle_resp)
+		return GMPD_IDLE_NONE;
+
+	retval = gmpd_idle_response_get_changed(GMPD_IDLE_RESPONSE(idle_resp));
+
+	g_object_unref(idle_resp);
+
+	return retval;
+}
+
+GMpdStatus *
+gmpd_client_finish_status_response(GMpdClient   *self,
+                                   GAsyncResult *result,
+                                   GError      **error)
+{
+	GTask *task;
+	gpointer retval;
+
+	g_return_val_if_fail(GMPD_IS_CLIENT(self), NULL);
+	g_return_val_if_fail(G_IS_TASK(result), NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	task = G_TASK(result);
+	g_return_val_if_fail(g_task_get_source_object(task) == self, NULL);
+
+	retval = g_task_propagate_pointer(task, error);
+	g_return_val_if_fail(retval == NULL || GMPD_IS_STATUS(retval), NULL);
+
+	return retval ? GMPD_STATUS(retval) : NULL;
+}
+
+GMpdStats *
+gmpd_client_finish_stats_response(GMpdClient   *self,
+                                  GAsyncResult *result,
+                                  GError      **error)
+{
+	GTask *task;
+	gpointer retval;
+
+	g_return_val_if_fail(GMPD_IS_CLIENT(self), NULL);
+	g_return_val_if_fail(G_IS_TASK(result), NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	task = G_TASK(result);
+	g_return_val_if_fail(g_task_get_source_object(task) == self, NULL);
+
+	retval = g_task_propagate_pointer(task, error);
+	g_return_val_if_fail(retval == NULL || GMPD_IS_STATS(retval), NULL);
+
+	return retval ? GMPD_STATS(retval) : NULL;
+}
+
+gboolean
+gmpd_client_finish_void_response(GMpdClient   *self,
+                                 GAsyncResult *result,
+                                 GError      **error)
+{
+	GTask *task;
+	GMpdVoidResponse *response;
+	GError *err = NULL;
+	gboolean retval;
+
+	g_return_val_if_fail(GMPD_IS_CLIENT(self), FALSE);
+	g_return_val_if_fail(G_IS_TASK(result), FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	task = G_TASK(self);
+	g_return_val_if_fail(g_task_get_source_object(task) == self, FALSE);
+
+	response = g_task_propagate_pointer(task, &err);
+	g_return_val_if_fail(response == NULL || GMPD_IS_VOID_RESPONSE(response), FALSE);
+
+	g_clear_object(&response);
+
+	if (err) {
+		retval = FALSE;
+		g_propagate_error(error, err);
+	} else {
+		retval = TRUE;
+	}
+
+	return retval;
+}
+
+GMpdReplayGainStatus *
+gmpd_client_finish_replay_gain_status_response(GMpdClient   *self,
+                                               GAsyncResult *result,
+                                               GError      **error)
+{
+	GTask *task;
+	GMpdReplayGainStatus *response;
+
+	g_return_val_if_fail(GMPD_IS_CLIENT(self), NULL);
+	g_return_val_if_fail(G_IS_TASK(result), NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	task = G_TASK(result);
 	g_return_val_if_fail(g_task_get_source_object(task) == self, FALSE);
 
 	response = g_task_propagate_pointer(task, error);
@@ -1069,6 +2357,55 @@ gmpd_client_finish_replay_gain_status_response(GMpdClient   *self,
 	return response;
 }
 
+/* The entities are only collected when no function was given, so after
+ * a foreach the array is empty.
+ */
+GPtrArray *
+gmpd_client_finish_entity_list_response(GMpdClient   *self,
+                                        GAsyncResult *result,
+                                        GError      **error)
+{
+	GTask *task;
+	gpointer response;
+	GPtrArray *retval;
+
+	g_return_val_if_fail(GMPD_IS_CLIENT(self), NULL);
+	g_return_val_if_fail(G_IS_TASK(result), NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	task = G_TASK(result);
+	g_return_val_if_fail(g_task_get_source_object(task) == self, NULL);
+
+	response = g_task_propagate_pointer(task, error);
+	g_return_val_if_fail(response == NULL || GMPD_IS_ENTITY_LIST(response), NULL);
+
+	if (!response)
+		return NULL;
+
+	retval = gmpd_entity_list_steal_entities(GMPD_ENTITY_LIST(response));
+
+	g_object_unref(response);
+
+	return retval;
+}
+
+GBytes *
+gmpd_client_finish_binary_response(GMpdClient   *self,
+                                   GAsyncResult *result,
+                                   GError      **error)
+{
+	GTask *task;
+
+	g_return_val_if_fail(GMPD_IS_CLIENT(self), NULL);
+	g_return_val_if_fail(G_IS_TASK(result), NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	task = G_TASK(result);
+	g_return_val_if_fail(g_task_get_source_object(task) == self, NULL);
+
+	return g_task_propagate_pointer(task, error);
+}
+
 static void
 gmpd_client_do_set_hostname(GMpdClient  *self,
                             const gchar *hostname,
@@ -1167,6 +2504,106 @@ gmpd_client_do_set_timeout(GMpdClient *self,
 		UNLOCK(self);
 }
 
+static void
+gmpd_client_do_set_max_pending_commands(GMpdClient *self,
+                                        guint       max_pending_commands,
+                                        gboolean    have_lock)
+{
+	g_return_if_fail(GMPD_IS_CLIENT(self));
+
+	if (!have_lock)
+		LOCK(self);
+
+	if (self->max_pending_commands != max_pending_commands) {
+		self->max_pending_commands = max_pending_commands;
+		gmpd_client_release_tasks(self);
+		NOTIFY(self, PROP_MAX_PENDING_COMMANDS);
+	}
+
+	if (!have_lock)
+		UNLOCK(self);
+}
+
+static void
+gmpd_client_do_set_max_pending_bytes(GMpdClient *self,
+                                     guint       max_pending_bytes,
+                                     gboolean    have_lock)
+{
+	g_return_if_fail(GMPD_IS_CLIENT(self));
+
+	if (!have_lock)
+		LOCK(self);
+
+	if (self->max_pending_bytes != max_pending_bytes) {
+		self->max_pending_bytes = max_pending_bytes;
+		gmpd_client_release_tasks(self);
+		NOTIFY(self, PROP_MAX_PENDING_BYTES);
+	}
+
+	if (!have_lock)
+		UNLOCK(self);
+}
+
+static void
+gmpd_client_do_set_metrics_enabled(GMpdClient *self,
+                                   gboolean    metrics_enabled,
+                                   gboolean    have_lock)
+{
+	g_return_if_fail(GMPD_IS_CLIENT(self));
+
+	if (!have_lock)
+		LOCK(self);
+
+	if ((self->metrics != NULL) != metrics_enabled) {
+		if (metrics_enabled)
+			self->metrics = gmpd_metrics_new();
+		else
+			g_clear_object(&self->metrics);
+
+		NOTIFY(self, PROP_METRICS_ENABLED);
+	}
+
+	if (!have_lock)
+		UNLOCK(self);
+}
+
+static void
+gmpd_client_do_set_reconnect(GMpdClient *self,
+                             gboolean    reconnect,
+                             gboolean    have_lock)
+{
+	g_return_if_fail(GMPD_IS_CLIENT(self));
+
+	if (!have_lock)
+		LOCK(self);
+
+	if (self->reconnect != reconnect) {
+		self->reconnect = reconnect;
+
+		/* gives up on a pending reconnect and fails the held tasks */
+		if (!self->reconnect && self->reconnecting)
+			gmpd_client_do_disconnect(self);
+
+		NOTIFY(self, PROP_RECONNECT);
+	}
+
+	if (!have_lock)
+		UNLOCK(self);
+}
+
+static void
+gmpd_client_set_connection_state(GMpdClient         *self,
+                                 GMpdConnectionState connection_state)
+{
+	g_return_if_fail(GMPD_IS_CLIENT(self));
+	g_return_if_fail(GMPD_IS_CONNECTION_STATE(connection_state));
+
+	if (self->connection_state != connection_state) {
+		self->connection_state = connection_state;
+		NOTIFY(self, PROP_CONNECTION_STATE);
+	}
+}
+
 static void
 gmpd_client_do_set_version(GMpdClient  *self,
                            GMpdVersion *version,
@@ -1259,42 +2696,104 @@ gmpd_client_connect_to_server(GMpdClient   *self,
 {
 	GSocketConnectable *socket_connectable;
 	GSocketClient *socket_client;
+	GSocketConnection *socket_connection;
 	GError *err = NULL;
-	GInputStream *input_stream;
-	GOutputStream *output_stream;
-	GSocket *socket;
 
-	if (self->hostname[0] == '/')
-		socket_connectable = G_SOCKET_CONNECTABLE(g_unix_socket_address_new(self->hostname));
-	else
-		socket_connectable = g_network_address_new(self->hostname, self->port);
+	socket_connectable = gmpd_client_new_connectable(self);
 
 	socket_client = g_socket_client_new();
-	self->socket_connection = g_socket_client_connect(socket_client,
-	                                                  socket_connectable,
-	                                                  cancellable,
-	                                                  &err);
+	socket_connection = g_socket_client_connect(socket_client,
+	                                            socket_connectable,
+	                                            cancellable,
+	                                            &err);
 
 	g_object_unref(socket_connectable);
 	g_object_unref(socket_client);
 
-	if (!self->socket_connection) {
+	if (!socket_connection) {
 		g_propagate_error(error, err);
 		return FALSE;
 	}
 
-	input_stream = g_io_stream_get_input_stream(G_IO_STREAM(self->socket_connection));
+	gmpd_client_setup_connection(self, socket_connection);
+	g_object_unref(socket_connection);
+
+	return TRUE;
+}
+
+static GSocketConnectable *
+gmpd_client_new_connectable(GMpdClient *self)
+{
+	g_return_val_if_fail(GMPD_IS_CLIENT(self), NULL);
+
+	if (self->hostname[0] == '/')
+		return G_SOCKET_CONNECTABLE(g_unix_socket_address_new(self->hostname));
+	else
+		return g_network_address_new(self->hostname, self->port);
+}
+
+static void
+gmpd_client_setup_connection(GMpdClient        *self,
+                             GSocketConnection *socket_connection)
+{
+	GOutputStream *output_stream;
+	GSocket *socket;
+
+	g_return_if_fail(GMPD_IS_CLIENT(self));
+	g_return_if_fail(G_IS_SOCKET_CONNECTION(socket_connection));
+
+	self->socket_connection = g_object_ref(socket_connection);
+
+	socket = g_socket_connection_get_socket(self->socket_connection);
 	output_stream = g_io_stream_get_output_stream(G_IO_STREAM(self->socket_connection));
 
-	self->input_stream = g_data_input_stream_new(input_stream);
+	self->input_buffer = gmpd_input_buffer_new(socket);
 	self->output_stream = G_BUFFERED_OUTPUT_STREAM(g_buffered_output_stream_new(output_stream));
 
-	socket = g_socket_connection_get_socket(self->socket_connection);
 	g_socket_set_blocking(socket, TRUE);
 	g_socket_set_keepalive(socket, self->keepalive);
 	g_socket_set_timeout(socket, self->timeout);
 
 	g_buffered_output_stream_set_auto_grow(self->output_stream, TRUE);
+}
+
+/* Reads the welcome line for a pending async init or reconnect. Returns
+ * FALSE until the line has been read or the connection has failed.
+ */
+static gboolean
+gmpd_client_finish_init(GMpdClient *self,
+                        GError    **error)
+{
+	GError *err = NULL;
+	GTask *task;
+
+	g_return_val_if_fail(GMPD_IS_CLIENT(self), FALSE);
+	g_return_val_if_fail(self->init_task != NULL || self->reconnecting, FALSE);
+
+	if (!gmpd_client_receive_version(self, NULL, &err)) {
+		if (IS_WOULD_BLOCK(err)) {
+			g_propagate_error(error, err);
+			return FALSE;
+		}
+
+		if (self->init_task) {
+			task = g_steal_pointer(&self->init_task);
+			g_task_set_task_data(task, g_error_copy(err), (GDestroyNotify)g_error_free);
+			gmpd_object_run_in_context(GMPD_OBJECT(self), return_init_task, task, g_object_unref);
+		}
+
+		g_propagate_error(error, err);
+		gmpd_client_do_disconnect(self);
+
+		return FALSE;
+	}
+
+	if (self->init_task) {
+		task = g_steal_pointer(&self->init_task);
+		gmpd_object_run_in_context(GMPD_OBJECT(self), return_init_task, task, g_object_unref);
+	}
+
+	gmpd_client_set_connected(self);
 
 	return TRUE;
 }
@@ -1308,7 +2807,7 @@ gmpd_client_receive_version(GMpdClient   *self,
 	gchar *line;
 	GMpdVersion *version;
 
-	line = g_data_input_stream_read_line_utf8(self->input_stream, NULL, cancellable, &err);
+	line = gmpd_input_buffer_read_line(self->input_buffer, NULL, cancellable, &err);
 	if (!line) {
 		g_propagate_error(error, err);
 		return FALSE;
@@ -1321,13 +2820,11 @@ gmpd_client_receive_version(GMpdClient   *self,
 		            G_IO_ERROR_INVALID_DATA,
 		            "invalid welcome string: %s", line);
 
-		g_free(line);
 		return FALSE;
 	}
 
 	gmpd_client_do_set_version(self, version, TRUE);
 
-	g_free(line);
 	g_object_unref(version);
 
 	return TRUE;
@@ -1404,35 +2901,33 @@ gmpd_client_run_task(GMpdClient   *self,
                      GCancellable *cancellable,
                      GError      **error)
 {
-	GTask *task;
-	gboolean result;
+	GMpdClient *idle_client;
 	GMpdResponse *response;
+	GTask *task;
+
+	task = gmpd_client_new_task(self, data, cancellable, NULL, NULL);
 
 	if (!have_lock)
 		LOCK(self);
 
-	task = gmpd_client_start_task(self, TRUE, data, cancellable, NULL, NULL);
-
-	result = gmpd_client_do_sync(self, G_IO_IN | G_IO_OUT, TRUE, cancellable, error);
-	if (!result) {
-		g_object_unref(task);
-
-		if (!have_lock)
-			UNLOCK(self);
+	/* idle blocks until the server reports a change, so it is run on the
+	 * idle connection without holding our lock. This lets other threads
+	 * keep using the command connection in the meantime.
+	 */
+	idle_client = have_lock ? NULL : gmpd_client_ref_idle_client(self, data);
+	if (idle_client) {
+		UNLOCK(self);
 
-		return NULL;
-	}
+		LOCK(idle_client);
+		response = gmpd_client_sync_task(idle_client, task, cancellable, error);
+		UNLOCK(idle_client);
 
-	if (data->error) {
-		if (error)
-			*error = g_error_copy(data->error);
+		g_object_unref(idle_client);
 
-		response = NULL;
-	} else {
-		response = data->response ? g_object_ref(data->response) : NULL;
+		return response;
 	}
 
-	g_object_unref(task);
+	response = gmpd_client_sync_task(self, task, cancellable, error);
 
 	if (!have_lock)
 		UNLOCK(self);
@@ -1455,118 +2950,1076 @@ gmpd_client_run_task_async(GMpdClient         *self,
 	                                     callback,
 	                                     user_data);
 
-	g_object_unref(task);
+	g_object_unref(task);
+}
+
+static BinaryTransfer *
+binary_transfer_new(BinaryTaskFunc  new_task,
+                    const gchar    *uri,
+                    gsize           offset)
+{
+	BinaryTransfer *transfer = g_slice_new(BinaryTransfer);
+
+	transfer->new_task = new_task;
+	transfer->uri = g_strdup(uri);
+	transfer->buffer = g_byte_array_new();
+	transfer->base = offset;
+	transfer->size = 0;
+	transfer->chunk_size = 0;
+	transfer->n_pending = 0;
+	transfer->error = NULL;
+
+	transfer->start_time = g_get_monotonic_time();
+	transfer->round_trip_time = 0;
+
+	return transfer;
+}
+
+static void
+binary_transfer_free(BinaryTransfer *transfer)
+{
+	g_clear_pointer(&transfer->uri, g_free);
+	g_clear_pointer(&transfer->buffer, g_byte_array_unref);
+	g_clear_error(&transfer->error);
+
+	g_slice_free(BinaryTransfer, transfer);
+}
+
+static GMpdTaskData *
+binary_transfer_new_task(BinaryTransfer *transfer,
+                         gsize           offset,
+                         gsize           end)
+{
+	GMpdBinaryResponse *response = gmpd_binary_response_new(transfer->buffer,
+	                                                        transfer->base,
+	                                                        offset,
+	                                                        end);
+
+	return transfer->new_task(transfer->uri, response);
+}
+
+/* Adds the ranges that still have to be requested after response to
+ * ranges. The chunk size is only known once the first chunk is in,
+ * and a chunk that comes back short is requested again from where it
+ * stopped.
+ */
+static gboolean
+binary_transfer_complete_chunk(BinaryTransfer     *transfer,
+                               GMpdBinaryResponse *response,
+                               GArray             *ranges,
+                               GError            **error)
+{
+	BinaryRange range;
+	gsize end;
+
+	if (transfer->chunk_size == 0) {
+		transfer->size = response->size;
+		transfer->chunk_size = response->length;
+		transfer->round_trip_time = g_get_monotonic_time() - transfer->start_time;
+	}
+
+	if (response->size != transfer->size) {
+		g_set_error_literal(error,
+		                    G_IO_ERROR,
+		                    G_IO_ERROR_INVALID_DATA,
+		                    "The file changed during the transfer");
+		return FALSE;
+	}
+
+	end = MIN(response->end, transfer->size);
+	if (response->offset + response->length >= end)
+		return TRUE;
+
+	if (response->length == 0) {
+		g_set_error_literal(error,
+		                    G_IO_ERROR,
+		                    G_IO_ERROR_INVALID_DATA,
+		                    "The server sent an empty chunk");
+		return FALSE;
+	}
+
+	/* the first chunk covers the whole file */
+	if (response->end == G_MAXSIZE) {
+		for (range.offset = response->offset + response->length;
+		     range.offset < end;
+		     range.offset = range.end) {
+			range.end = MIN(range.offset + transfer->chunk_size, end);
+			g_array_append_val(ranges, range);
+		}
+
+	} else {
+		range.offset = response->offset + response->length;
+		range.end = end;
+		g_array_append_val(ranges, range);
+	}
+
+	return TRUE;
+}
+
+/* All but the last chunk of each round are queued without waiting for
+ * them, so they are pipelined, and only the last one is waited for.
+ * Tasks complete in order, so by then the others are done as well.
+ */
+static GBytes *
+gmpd_client_run_binary_transfer(GMpdClient     *self,
+                                BinaryTaskFunc  new_task,
+                                const gchar    *uri,
+                                gsize           offset,
+                                GCancellable   *cancellable,
+                                GError        **error)
+{
+	BinaryTransfer *transfer;
+	GPtrArray *tasks;
+	GArray *ranges;
+	GBytes *retval = NULL;
+	BinaryRange range;
+
+	transfer = binary_transfer_new(new_task, uri, offset);
+	tasks = g_ptr_array_new_with_free_func(g_object_unref);
+	ranges = g_array_new(FALSE, FALSE, sizeof(BinaryRange));
+
+	range.offset = offset;
+	range.end = G_MAXSIZE;
+	g_array_append_val(ranges, range);
+
+	while (ranges->len && !transfer->error) {
+		GMpdResponse *response;
+		guint i;
+
+		LOCK(self);
+
+		if (!transfer->chunk_size)
+			gmpd_client_start_binary_transfer(self);
+
+		for (i = 0; i < ranges->len; i++) {
+			range = g_array_index(ranges, BinaryRange, i);
+			g_ptr_array_add(tasks, gmpd_client_new_task(self,
+			                                            binary_transfer_new_task(transfer,
+			                                                                     range.offset,
+			                                                                     range.end),
+			                                            cancellable,
+			                                            NULL,
+			                                            NULL));
+		}
+
+		for (i = 0; i + 1 < tasks->len; i++)
+			gmpd_client_queue_task(self, TRUE, g_ptr_array_index(tasks, i));
+
+		response = gmpd_client_sync_task(self,
+		                                 g_object_ref(g_ptr_array_index(tasks, tasks->len - 1)),
+		                                 cancellable,
+		                                 &transfer->error);
+		g_clear_object(&response);
+
+		UNLOCK(self);
+
+		g_array_set_size(ranges, 0);
+
+		for (i = 0; i < tasks->len && !transfer->error; i++) {
+			GMpdTaskData *data = g_task_get_task_data(g_ptr_array_index(tasks, i));
+
+			if (data->error)
+				transfer->error = g_error_copy(data->error);
+			else
+				binary_transfer_complete_chunk(transfer,
+				                               GMPD_BINARY_RESPONSE(data->response),
+				                               ranges,
+				                               &transfer->error);
+		}
+
+		g_ptr_array_set_size(tasks, 0);
+	}
+
+	if (transfer->error) {
+		g_propagate_error(error, g_steal_pointer(&transfer->error));
+	} else {
+		gmpd_client_finish_binary_transfer(self, transfer);
+		retval = g_byte_array_free_to_bytes(g_steal_pointer(&transfer->buffer));
+	}
+
+	g_array_unref(ranges);
+	g_ptr_array_unref(tasks);
+	binary_transfer_free(transfer);
+
+	return retval;
+}
+
+static void
+gmpd_client_run_binary_transfer_async(GMpdClient         *self,
+                                      BinaryTaskFunc      new_task,
+                                      const gchar        *uri,
+                                      gsize               offset,
+                                      GCancellable       *cancellable,
+                                      GAsyncReadyCallback callback,
+                                      gpointer            user_data)
+{
+	GTask *task;
+	GArray *ranges;
+	BinaryRange range;
+
+	task = g_task_new(self, cancellable, callback, user_data);
+	g_task_set_task_data(task,
+	                     binary_transfer_new(new_task, uri, offset),
+	                     (GDestroyNotify)binary_transfer_free);
+
+	ranges = g_array_new(FALSE, FALSE, sizeof(BinaryRange));
+
+	range.offset = offset;
+	range.end = G_MAXSIZE;
+	g_array_append_val(ranges, range);
+
+	gmpd_client_queue_binary_chunks(self, task, ranges);
+
+	g_array_unref(ranges);
+	g_object_unref(task);
+}
+
+/* binarylimit is kept for the rest of the connection, so it is only
+ * sent when the chunk size changed since the last transfer.
+ */
+static void
+gmpd_client_start_binary_transfer(GMpdClient *self)
+{
+	g_return_if_fail(GMPD_IS_CLIENT(self));
+
+	if (self->binary_limit == self->binary_chunk_size)
+		return;
+
+	if (!gmpd_client_check_version(self, 0, 22, 4))
+		return;
+
+	self->binary_limit = self->binary_chunk_size;
+
+	gmpd_client_run_task_async(self,
+	                           TRUE,
+	                           gmpd_protocol_binarylimit(self->binary_limit),
+	                           NULL,
+	                           NULL,
+	                           NULL);
+}
+
+/* Chunks are pipelined, so they only need to be big enough to keep the
+ * link busy for one round trip, which is the bandwidth-delay product.
+ * The round trip of the first chunk includes sending the chunk itself,
+ * so that part is taken off again.
+ */
+static void
+gmpd_client_finish_binary_transfer(GMpdClient     *self,
+                                   BinaryTransfer *transfer)
+{
+	gint64 elapsed;
+	gdouble bandwidth;
+	gdouble delay;
+	guint chunk_size;
+
+	g_return_if_fail(GMPD_IS_CLIENT(self));
+
+	elapsed = g_get_monotonic_time() - transfer->start_time;
+
+	/* a transfer of a single chunk says nothing about the bandwidth */
+	if (elapsed <= 0 || transfer->buffer->len <= transfer->chunk_size)
+		return;
+
+	bandwidth = (gdouble) transfer->buffer->len / elapsed;
+	delay = transfer->round_trip_time - transfer->chunk_size / bandwidth;
+
+	if (delay <= 0)
+		chunk_size = BINARY_CHUNK_MIN_SIZE;
+	else if (bandwidth * delay >= BINARY_CHUNK_MAX_SIZE)
+		chunk_size = BINARY_CHUNK_MAX_SIZE;
+	else
+		chunk_size = MAX(bandwidth * delay, BINARY_CHUNK_MIN_SIZE);
+
+	/* whole powers of two keep small fluctuations from changing the
+	 * limit on every transfer */
+	chunk_size = 1u << g_bit_storage(chunk_size - 1);
+
+	LOCK(self);
+	self->binary_chunk_size = MIN(chunk_size, BINARY_CHUNK_MAX_SIZE);
+	UNLOCK(self);
+}
+
+static void
+gmpd_client_queue_binary_chunks(GMpdClient *self,
+                                GTask      *task,
+                                GArray     *ranges)
+{
+	BinaryTransfer *transfer = g_task_get_task_data(task);
+	guint i;
+
+	LOCK(self);
+
+	if (!transfer->chunk_size)
+		gmpd_client_start_binary_transfer(self);
+
+	for (i = 0; i < ranges->len; i++) {
+		BinaryRange range = g_array_index(ranges, BinaryRange, i);
+
+		transfer->n_pending++;
+		gmpd_client_run_task_async(self,
+		                           TRUE,
+		                           binary_transfer_new_task(transfer, range.offset, range.end),
+		                           g_task_get_cancellable(task),
+		                           on_binary_chunk_ready,
+		                           g_object_ref(task));
+	}
+
+	UNLOCK(self);
+}
+
+static void
+on_binary_chunk_ready(GObject      *source_object,
+                      GAsyncResult *result,
+                      gpointer      user_data)
+{
+	GMpdClient *self = GMPD_CLIENT(source_object);
+	GTask *task = G_TASK(user_data);
+	BinaryTransfer *transfer = g_task_get_task_data(task);
+	GMpdResponse *response;
+	GError *error = NULL;
+
+	transfer->n_pending--;
+
+	response = g_task_propagate_pointer(G_TASK(result), &error);
+
+	/* after an error the chunks still in flight are only drained */
+	if (transfer->error) {
+		g_clear_error(&error);
+
+	} else if (error) {
+		transfer->error = error;
+
+	} else {
+		GArray *ranges = g_array_new(FALSE, FALSE, sizeof(BinaryRange));
+
+		if (binary_transfer_complete_chunk(transfer,
+		                                   GMPD_BINARY_RESPONSE(response),
+		                                   ranges,
+		                                   &transfer->error))
+			gmpd_client_queue_binary_chunks(self, task, ranges);
+
+		g_array_unref(ranges);
+	}
+
+	g_clear_object(&response);
+
+	if (transfer->n_pending == 0) {
+		if (transfer->error) {
+			g_task_return_error(task, g_steal_pointer(&transfer->error));
+		} else {
+			gmpd_client_finish_binary_transfer(self, transfer);
+			g_task_return_pointer(task,
+			                      g_byte_array_free_to_bytes(g_steal_pointer(&transfer->buffer)),
+			                      (GDestroyNotify)g_bytes_unref);
+		}
+	}
+
+	g_object_unref(task);
+}
+
+static void
+gmpd_client_noidle(GMpdClient *self)
+{
+	GTask *tail_task;
+	GMpdTaskData *tail_data;
+
+	g_return_if_fail(GMPD_IS_CLIENT(self));
+
+	if (!self->socket_connection)
+		return;
+
+	tail_task = g_queue_peek_tail(self->task_queue);
+	tail_data = tail_task ? g_task_get_task_data(tail_task) : NULL;
+
+	if (tail_data && GMPD_IS_IDLE_RESPONSE(tail_data->response)) {
+		static const gchar noidle_command[] = "noidle\n";
+		static const gsize noidle_len = G_N_ELEMENTS(noidle_command) - 1;
+
+		g_output_stream_write(G_OUTPUT_STREAM(self->output_stream),
+		                      noidle_command,
+		                      noidle_len,
+		                      NULL,
+		                      NULL);
+	}
+}
+
+static GTask *
+gmpd_client_start_task(GMpdClient         *self,
+                       gboolean            have_lock,
+                       GMpdTaskData       *task_data,
+                       GCancellable       *cancellable,
+                       GAsyncReadyCallback callback,
+                       gpointer            user_data)
+{
+	GMpdClient *idle_client;
+	GTask *task;
+
+	g_return_val_if_fail(GMPD_IS_CLIENT(self), NULL);
+	g_return_val_if_fail(task_data != NULL, NULL);
+	g_return_val_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable), NULL);
+	g_return_val_if_fail(callback != NULL || user_data == NULL, NULL);
+
+	task = gmpd_client_new_task(self, task_data, cancellable, callback, user_data);
+
+	if (!have_lock)
+		LOCK(self);
+
+	idle_client = gmpd_client_ref_idle_client(self, task_data);
+	if (!idle_client)
+		gmpd_client_queue_task(self, TRUE, task);
+
+	if (!have_lock)
+		UNLOCK(self);
+
+	if (idle_client) {
+		gmpd_client_queue_task(idle_client, FALSE, task);
+		g_object_unref(idle_client);
+	}
+
+	return task;
+}
+
+static GTask *
+gmpd_client_new_task(GMpdClient         *self,
+                     GMpdTaskData       *task_data,
+                     GCancellable       *cancellable,
+                     GAsyncReadyCallback callback,
+                     gpointer            user_data)
+{
+	GTask *task;
+
+	g_return_val_if_fail(GMPD_IS_CLIENT(self), NULL);
+	g_return_val_if_fail(task_data != NULL, NULL);
+
+	task = g_task_new(self, cancellable, callback, user_data);
+	g_task_set_task_data(task, task_data, (GDestroyNotify)gmpd_task_data_unref);
+
+	return task;
+}
+
+/* The task may belong to a different client when self is an idle
+ * connection, so only the task data is used here.
+ */
+static void
+gmpd_client_queue_task(GMpdClient *self,
+                       gboolean    have_lock,
+                       GTask      *task)
+{
+	GMpdTaskData *task_data;
+
+	g_return_if_fail(GMPD_IS_CLIENT(self));
+	g_return_if_fail(G_IS_TASK(task));
+
+	task_data = g_task_get_task_data(task);
+
+	if (!have_lock)
+		LOCK(self);
+
+	/* close has no response */
+	if (!task_data->response)
+		self->closing = TRUE;
+
+	if (!self->socket_connection && self->reconnecting && self->closing) {
+		/* there is nothing to close, so just give up on reconnecting */
+		gmpd_client_do_disconnect(self);
+		RETURN_TASK(self, g_object_ref(task));
+
+		if (!have_lock)
+			UNLOCK(self);
+
+		return;
+	}
+
+	if (!self->socket_connection && !self->reconnecting) {
+		task_data->error = g_error_new_literal(G_IO_ERROR,
+		                                       G_IO_ERROR_CLOSED,
+		                                       "The client is closed");
+
+		RETURN_TASK(self, g_object_ref(task));
+
+		if (!have_lock)
+			UNLOCK(self);
+
+		return;
+	}
+
+	if (self->metrics)
+		task_data->queue_time = g_get_monotonic_time();
+
+	/* while reconnecting, tasks wait until the connection is back */
+	if (!self->socket_connection ||
+	    self->wait_queue->length ||
+	    !gmpd_client_has_room(self, strlen(task_data->command))) {
+		/* the window only drains if a pending idle is ended */
+		gmpd_client_noidle(self);
+		g_queue_push_tail(self->wait_queue, g_object_ref(task));
+		gmpd_client_update_pipeline_full(self);
+
+	} else {
+		gmpd_client_write_task(self, task);
+		gmpd_client_update_pipeline_full(self);
+		gmpd_client_enable_timeout(self);
+	}
+
+	if (!have_lock)
+		UNLOCK(self);
+}
+
+static void
+gmpd_client_write_task(GMpdClient *self,
+                       GTask      *task)
+{
+	GMpdTaskData *task_data;
+	gsize command_len;
+
+	g_return_if_fail(GMPD_IS_CLIENT(self));
+	g_return_if_fail(G_IS_TASK(task));
+
+	task_data = g_task_get_task_data(task);
+	command_len = strlen(task_data->command);
+
+	gmpd_client_noidle(self);
+
+	g_queue_push_tail(self->task_queue, g_object_ref(task));
+	self->task_bytes += command_len;
+
+	if (self->metrics)
+		task_data->send_time = g_get_monotonic_time();
+
+	g_output_stream_write(G_OUTPUT_STREAM(self->output_stream),
+	                      task_data->command,
+	                      command_len,
+	                      NULL,
+	                      NULL);
+
+	gmpd_client_attach_output_source(self);
+	gmpd_client_attach_input_source(self);
+}
+
+static GTask *
+gmpd_client_pop_task(GMpdClient *self)
+{
+	GTask *task;
+	GMpdTaskData *task_data;
+
+	g_return_val_if_fail(GMPD_IS_CLIENT(self), NULL);
+
+	task = g_queue_pop_head(self->task_queue);
+	if (!task)
+		return NULL;
+
+	task_data = g_task_get_task_data(task);
+	self->task_bytes -= MIN(self->task_bytes, strlen(task_data->command));
+
+	return task;
+}
+
+/* A command is always let through when nothing else is pending, so a
+ * command larger than max-pending-bytes can't stall the client.
+ */
+static gboolean
+gmpd_client_has_room(GMpdClient *self,
+                     gsize       n_bytes)
+{
+	g_return_val_if_fail(GMPD_IS_CLIENT(self), FALSE);
+
+	if (!self->task_queue->length)
+		return TRUE;
+
+	if (self->max_pending_commands && self->task_queue->length >= self->max_pending_commands)
+		return FALSE;
+
+	if (self->max_pending_bytes && self->task_bytes + n_bytes > self->max_pending_bytes)
+		return FALSE;
+
+	return TRUE;
+}
+
+/* Moves waiting tasks into the window and writes their commands.
+ * Returns TRUE if anything was written.
+ */
+static gboolean
+gmpd_client_release_tasks(GMpdClient *self)
+{
+	GTask *task;
+	gboolean released = FALSE;
+
+	g_return_val_if_fail(GMPD_IS_CLIENT(self), FALSE);
+
+	if (!self->socket_connection)
+		return FALSE;
+
+	while ((task = g_queue_peek_head(self->wait_queue))) {
+		GMpdTaskData *task_data = g_task_get_task_data(task);
+
+		if (!gmpd_client_has_room(self, strlen(task_data->command)))
+			break;
+
+		g_queue_pop_head(self->wait_queue);
+		gmpd_client_write_task(self, task);
+		g_object_unref(task);
+
+		released = TRUE;
+	}
+
+	gmpd_client_update_pipeline_full(self);
+
+	return released;
+}
+
+static void
+gmpd_client_record_task(GMpdClient *self,
+                        GTask      *task)
+{
+	GMpdTaskData *data;
+
+	g_return_if_fail(GMPD_IS_CLIENT(self));
+	g_return_if_fail(G_IS_TASK(task));
+
+	data = g_task_get_task_data(task);
+
+	/* tasks queued before metrics were enabled have no timestamps */
+	if (!self->metrics || !data->queue_time || !data->send_time)
+		return;
+
+	gmpd_metrics_add_command(self->metrics,
+	                         data->command,
+	                         data->send_time - data->queue_time,
+	                         g_get_monotonic_time() - data->send_time,
+	                         data->parse_time,
+	                         strlen(data->command),
+	                         data->bytes_in);
+}
+
+static void
+gmpd_client_update_pipeline_full(GMpdClient *self)
+{
+	gboolean pipeline_full;
+
+	g_return_if_fail(GMPD_IS_CLIENT(self));
+
+	pipeline_full = self->wait_queue->length ||
+	                (self->max_pending_commands &&
+	                 self->task_queue->length >= self->max_pending_commands) ||
+	                (self->max_pending_bytes &&
+	                 self->task_bytes >= self->max_pending_bytes);
+
+	if (self->pipeline_full != pipeline_full) {
+		self->pipeline_full = pipeline_full;
+		NOTIFY(self, PROP_PIPELINE_FULL);
+	}
+}
+
+static GMpdResponse *
+gmpd_client_sync_task(GMpdClient   *self,
+                      GTask        *task,
+                      GCancellable *cancellable,
+                      GError      **error)
+{
+	GMpdTaskData *data;
+	GMpdResponse *response;
+	gboolean result;
+
+	g_return_val_if_fail(GMPD_IS_CLIENT(self), NULL);
+	g_return_val_if_fail(G_IS_TASK(task), NULL);
+
+	data = g_task_get_task_data(task);
+
+	/* there is no point in waiting for the backoff to expire when the
+	 * caller is blocking anyway, unless it is closing the client */
+	if (self->reconnecting && self->reconnect_source && data->response &&
+	    !gmpd_client_reconnect_sync(self, cancellable, error)) {
+		g_object_unref(task);
+		return NULL;
+	}
+
+	gmpd_client_queue_task(self, TRUE, task);
+
+	if (self->socket_connection) {
+		result = gmpd_client_do_sync(self, G_IO_IN | G_IO_OUT, TRUE, cancellable, error);
+	} else if (self->reconnecting) {
+		g_set_error_literal(error,
+		                    G_IO_ERROR,
+		                    G_IO_ERROR_NOT_CONNECTED,
+		                    "The client is reconnecting");
+		result = FALSE;
+	} else {
+		result = TRUE;
+	}
+
+	if (!result) {
+		/* the task may have been held for a reconnect */
+		if (g_queue_remove(self->wait_queue, task))
+			g_object_unref(task);
+
+		g_object_unref(task);
+		return NULL;
+	}
+
+	if (data->error) {
+		if (error)
+			*error = g_error_copy(data->error);
+
+		response = NULL;
+	} else {
+		response = data->response ? g_object_ref(data->response) : NULL;
+	}
+
+	g_object_unref(task);
+
+	return response;
+}
+
+/* The idle client's lock may be held for as long as a blocking idle
+ * runs, so it is never taken while our own lock is held. Its socket is
+ * used instead to find out whether it is still connected.
+ */
+static GMpdClient *
+gmpd_client_ref_idle_client(GMpdClient   *self,
+                            GMpdTaskData *task_data)
+{
+	g_return_val_if_fail(GMPD_IS_CLIENT(self), NULL);
+	g_return_val_if_fail(task_data != NULL, NULL);
+
+	if (!self->idle_client || !GMPD_IS_IDLE_RESPONSE(task_data->response))
+		return NULL;
+
+	/* if the idle connection was lost, idle falls back to the
+	 * command connection */
+	if (g_socket_is_closed(self->idle_socket))
+		return NULL;
+
+	return g_object_ref(self->idle_client);
+}
+
+static void
+gmpd_client_set_idle_client(GMpdClient *self,
+                            GMpdClient *idle_client)
+{
+	GSocket *idle_socket;
+
+	g_return_if_fail(GMPD_IS_CLIENT(self));
+	g_return_if_fail(idle_client == NULL || GMPD_IS_CLIENT(idle_client));
+
+	/* idle_client is not shared with anyone yet */
+	idle_socket = idle_client && idle_client->socket_connection
+	            ? g_socket_connection_get_socket(idle_client->socket_connection)
+	            : NULL;
+
+	LOCK(self);
+
+	gmpd_client_close_idle_client(self);
+
+	if (idle_socket && self->socket_connection) {
+		self->idle_client = g_object_ref(idle_client);
+		self->idle_socket = g_object_ref(idle_socket);
+
+	} else if (idle_socket) {
+		g_socket_shutdown(idle_socket, TRUE, TRUE, NULL);
+	}
+
+	UNLOCK(self);
+}
+
+/* Shutting down the socket wakes up a blocking idle, after which the
+ * idle client disconnects itself and fails its pending tasks.
+ */
+static void
+gmpd_client_close_idle_client(GMpdClient *self)
+{
+	g_return_if_fail(GMPD_IS_CLIENT(self));
+
+	if (self->idle_socket)
+		g_socket_shutdown(self->idle_socket, TRUE, TRUE, NULL);
+
+	g_clear_object(&self->idle_socket);
+	g_clear_object(&self->idle_client);
+}
+
+/* When the client is set to reconnect, a lost connection keeps the
+ * tasks that can safely be sent again and schedules a reconnect.
+ * Otherwise, or once the client is being closed, every task fails.
+ */
+static void
+gmpd_client_do_disconnect(GMpdClient *self)
+{
+	gboolean reconnect;
+	GTask *task;
+
+	g_return_if_fail(GMPD_IS_CLIENT(self));
+
+	reconnect = gmpd_client_will_reconnect(self);
+
+	if (self->socket_connection)
+		g_io_stream_close(G_IO_STREAM(self->socket_connection), NULL, NULL);
+
+	gmpd_client_destroy_input_source(self);
+	gmpd_client_destroy_output_source(self);
+
+	g_clear_object(&self->socket_connection);
+	g_clear_pointer(&self->input_buffer, gmpd_input_buffer_free);
+	g_clear_object(&self->output_stream);
+
+	gmpd_client_do_set_version(self, NULL, TRUE);
+
+	if (reconnect)
+		gmpd_client_hold_tasks(self);
+
+	gmpd_client_fail_tasks(self, self->task_queue);
+
+	if (!reconnect)
+		gmpd_client_fail_tasks(self, self->wait_queue);
+
+	self->task_bytes = 0;
+	gmpd_client_update_pipeline_full(self);
+
+	if (self->init_task) {
+		task = g_steal_pointer(&self->init_task);
+
+		g_task_set_task_data(task,
+		                     g_error_new_literal(G_IO_ERROR,
+		                                         G_IO_ERROR_CLOSED,
+		                                         "The client is closed"),
+		                     (GDestroyNotify)g_error_free);
+
+		gmpd_object_run_in_context(GMPD_OBJECT(self), return_init_task, task, g_object_unref);
+	}
+
+	gmpd_client_close_idle_client(self);
+
+	if (self->reconnect_source) {
+		g_source_destroy(self->reconnect_source);
+		g_clear_pointer(&self->reconnect_source, g_source_unref);
+	}
+
+	if (reconnect) {
+		gmpd_client_schedule_reconnect(self);
+	} else {
+		self->reconnecting = FALSE;
+		self->n_reconnect_attempts = 0;
+		gmpd_client_set_connection_state(self, GMPD_CONNECTION_DISCONNECTED);
+	}
+}
+
+static gboolean
+gmpd_client_will_reconnect(GMpdClient *self)
+{
+	g_return_val_if_fail(GMPD_IS_CLIENT(self), FALSE);
+
+	return self->reconnect &&
+	       !self->closing &&
+	       GMPD_OBJECT(self)->context &&
+	       (self->connection_state == GMPD_CONNECTION_CONNECTED || self->reconnecting);
+}
+
+/* Moves the tasks that can be sent again in front of the waiting ones.
+ * A task qualifies if sending it twice does no harm and none of its
+ * response has been read yet.
+ */
+static void
+gmpd_client_hold_tasks(GMpdClient *self)
+{
+	GList *link;
+
+	g_return_if_fail(GMPD_IS_CLIENT(self));
+
+	link = self->task_queue->tail;
+
+	while (link) {
+		GList *prev = link->prev;
+		GTask *task = link->data;
+		GMpdTaskData *data = g_task_get_task_data(task);
+
+		if (data->idempotent && data->response && !data->bytes_in) {
+			g_queue_delete_link(self->task_queue, link);
+			g_queue_push_head(self->wait_queue, task);
+		}
+
+		link = prev;
+	}
+}
+
+static void
+gmpd_client_fail_tasks(GMpdClient *self,
+                       GQueue     *queue)
+{
+	GTask *task;
+
+	g_return_if_fail(GMPD_IS_CLIENT(self));
+	g_return_if_fail(queue != NULL);
+
+	while ((task = g_queue_pop_head(queue))) {
+		GMpdTaskData *data = g_task_get_task_data(task);
+
+		data->error = g_error_new_literal(G_IO_ERROR,
+		                                  G_IO_ERROR_CLOSED,
+		                                  "The client is closed");
+
+		RETURN_TASK(self, task);
+	}
+}
+
+static void
+gmpd_client_set_connected(GMpdClient *self)
+{
+	g_return_if_fail(GMPD_IS_CLIENT(self));
+
+	if (self->reconnecting && self->metrics)
+		gmpd_metrics_add_reconnect(self->metrics);
+
+	self->reconnecting = FALSE;
+	self->n_reconnect_attempts = 0;
+
+	/* a new connection starts out with the server's default limit */
+	self->binary_limit = 0;
+
+	/* goes ahead of any tasks held over from the lost connection */
+	if (self->have_tag_types) {
+		GTask *task = gmpd_client_new_tag_types_task(self);
+
+		if (task) {
+			g_queue_push_head(self->wait_queue, task);
+			gmpd_client_release_tasks(self);
+		}
+	}
+
+	gmpd_client_set_connection_state(self, GMPD_CONNECTION_CONNECTED);
+}
+
+static gboolean
+gmpd_client_check_version(GMpdClient *self,
+                          gint        major,
+                          gint        minor,
+                          gint        patch)
+{
+	GMpdVersion *required;
+	gboolean result;
+
+	g_return_val_if_fail(GMPD_IS_CLIENT(self), FALSE);
+
+	if (!self->version)
+		return FALSE;
+
+	required = gmpd_version_new(major, minor, patch);
+	result = gmpd_version_compare(self->version, required) >= 0;
+
+	g_object_unref(required);
+
+	return result;
+}
+
+static GTask *
+gmpd_client_new_tag_types_task(GMpdClient *self)
+{
+	g_return_val_if_fail(GMPD_IS_CLIENT(self), NULL);
+
+	/* tagtypes clear and all are new in 0.21 */
+	if (!gmpd_client_check_version(self, 0, 21, 0))
+		return NULL;
+
+	return gmpd_client_new_task(self,
+	                            gmpd_protocol_tagtypes(self->tag_types),
+	                            NULL,
+	                            NULL,
+	                            NULL);
 }
 
+/* The first attempt is made right away, so a restarted server is picked
+ * up as soon as it listens again. After that the delay doubles up to
+ * RECONNECT_MAX_DELAY, with jitter so that many clients don't all hit
+ * the server at once.
+ */
 static void
-gmpd_client_noidle(GMpdClient *self)
+gmpd_client_schedule_reconnect(GMpdClient *self)
 {
-	GTask *tail_task;
-	GMpdTaskData *tail_data;
+	guint delay = 0;
 
 	g_return_if_fail(GMPD_IS_CLIENT(self));
+	g_return_if_fail(self->reconnect_source == NULL);
 
-	if (!self->socket_connection)
-		return;
+	if (self->n_reconnect_attempts) {
+		guint shift = MIN(self->n_reconnect_attempts - 1, 16);
 
-	tail_task = g_queue_peek_tail(self->task_queue);
-	tail_data = tail_task ? g_task_get_task_data(tail_task) : NULL;
+		delay = MIN((guint) RECONNECT_MIN_DELAY << shift, RECONNECT_MAX_DELAY);
+		delay = g_random_int_range(delay / 2, delay + 1);
+	}
 
-	if (tail_data && GMPD_IS_IDLE_RESPONSE(tail_data->response)) {
-		static const gchar noidle_command[] = "noidle\n";
-		static const gsize noidle_len = G_N_ELEMENTS(noidle_command) - 1;
+	self->reconnecting = TRUE;
+	self->n_reconnect_attempts++;
 
-		g_output_stream_write(G_OUTPUT_STREAM(self->output_stream),
-		                      noidle_command,
-		                      noidle_len,
-		                      NULL,
-		                      NULL);
-	}
-}
+	self->reconnect_source = g_timeout_source_new(delay);
 
-static GTask *
-gmpd_client_start_task(GMpdClient         *self,
-                       gboolean            have_lock,
-                       GMpdTaskData       *task_data,
-                       GCancellable       *cancellable,
-                       GAsyncReadyCallback callback,
-                       gpointer            user_data)
-{
-	GTask *task;
+	g_source_set_callback(self->reconnect_source,
+	                      G_SOURCE_FUNC(gmpd_client_on_reconnect_timeout),
+	                      g_object_ref(self),
+	                      g_object_unref);
 
-	g_return_val_if_fail(GMPD_IS_CLIENT(self), NULL);
-	g_return_val_if_fail(task_data != NULL, NULL);
-	g_return_val_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable), NULL);
-	g_return_val_if_fail(callback != NULL || user_data == NULL, NULL);
+	g_source_attach(self->reconnect_source, GMPD_OBJECT(self)->context);
 
-	task = g_task_new(self, cancellable, callback, user_data);
-	g_task_set_task_data(task, task_data, (GDestroyNotify)gmpd_task_data_unref);
+	gmpd_client_set_connection_state(self, GMPD_CONNECTION_WAITING);
+}
 
-	if (!have_lock)
-		LOCK(self);
+static gboolean
+gmpd_client_reconnect_sync(GMpdClient   *self,
+                           GCancellable *cancellable,
+                           GError      **error)
+{
+	GError *err = NULL;
 
-	if (!self->socket_connection) {
-		task_data->error = g_error_new_literal(G_IO_ERROR,
-		                                       G_IO_ERROR_CLOSED,
-		                                       "The client is closed");
+	g_return_val_if_fail(GMPD_IS_CLIENT(self), FALSE);
+	g_return_val_if_fail(self->reconnecting, FALSE);
 
-		RETURN_TASK(self, g_object_ref(task), TRUE);
+	g_source_destroy(self->reconnect_source);
+	g_clear_pointer(&self->reconnect_source, g_source_unref);
 
-		if (!have_lock)
-			UNLOCK(self);
+	gmpd_client_set_connection_state(self, GMPD_CONNECTION_CONNECTING);
 
-		return task;
+	if (!gmpd_client_connect_to_server(self, cancellable, &err) ||
+	    !gmpd_client_receive_version(self, cancellable, &err)) {
+		g_propagate_error(error, err);
+		gmpd_client_do_disconnect(self);
+		return FALSE;
 	}
 
-	gmpd_client_noidle(self);
+	gmpd_client_set_connected(self);
 
-	g_queue_push_tail(self->task_queue, g_object_ref(task));
+	return TRUE;
+}
 
-	g_output_stream_write(G_OUTPUT_STREAM(self->output_stream),
-	                      task_data->command,
-	                      strlen(task_data->command),
-	                      NULL,
-	                      NULL);
+static gboolean
+gmpd_client_on_reconnect_timeout(GMpdClient *self)
+{
+	GSocketConnectable *socket_connectable;
+	GSocketClient *socket_client;
 
-	gmpd_client_attach_output_source(self);
-	gmpd_client_attach_input_source(self);
+	g_return_val_if_fail(GMPD_IS_CLIENT(self), G_SOURCE_REMOVE);
 
-	gmpd_client_enable_timeout(self);
+	LOCK(self);
 
-	if (!have_lock)
+	if (g_source_is_destroyed(g_main_current_source())) {
 		UNLOCK(self);
+		return G_SOURCE_REMOVE;
+	}
 
-	return task;
-}
-
-static void
-gmpd_client_do_disconnect(GMpdClient *self)
-{
-	GTask *task;
-
-	g_return_if_fail(GMPD_IS_CLIENT(self));
-
-	if (self->socket_connection)
-		g_io_stream_close(G_IO_STREAM(self->socket_connection), NULL, NULL);
+	g_clear_pointer(&self->reconnect_source, g_source_unref);
 
-	gmpd_client_destroy_input_source(self);
-	gmpd_client_destroy_output_source(self);
+	gmpd_client_set_connection_state(self, GMPD_CONNECTION_CONNECTING);
 
-	g_clear_object(&self->socket_connection);
-	g_clear_object(&self->input_stream);
-	g_clear_object(&self->output_stream);
+	socket_connectable = gmpd_client_new_connectable(self);
 
-	gmpd_client_do_set_version(self, NULL, TRUE);
+	UNLOCK(self);
 
-	while ((task = g_queue_pop_head(self->task_queue))) {
-		GMpdTaskData *data = g_task_get_task_data(task);
+	socket_client = g_socket_client_new();
+	g_socket_client_connect_async(socket_client,
+	                              socket_connectable,
+	                              NULL,
+	                              on_reconnect_ready,
+	                              g_object_ref(self));
 
-		data->error = g_error_new_literal(G_IO_ERROR,
-		                                  G_IO_ERROR_CLOSED,
-		                                  "The client is closed");
+	g_object_unref(socket_connectable);
+	g_object_unref(socket_client);
 
-		RETURN_TASK(self, task, TRUE);
-	}
+	return G_SOURCE_REMOVE;
 }
 
 static void
@@ -1665,13 +4118,15 @@ gmpd_client_do_flush(GMpdClient   *self,
 			return FALSE;
 		}
 
-		task = G_TASK(g_queue_pop_head(self->task_queue));
-		data = g_task_get_task_data(task);
+		/* when reconnecting, the tasks are held or failed as a whole */
+		if (!gmpd_client_will_reconnect(self) && (task = gmpd_client_pop_task(self))) {
+			data = g_task_get_task_data(task);
+			data->error = g_error_copy(err);
 
-		data->error = g_error_copy(err);
-		g_propagate_error(error, err);
+			RETURN_TASK(self, task);
+		}
 
-		RETURN_TASK(self, task, TRUE);
+		g_propagate_error(error, err);
 		gmpd_client_do_disconnect(self);
 
 		return FALSE;
@@ -1694,25 +4149,66 @@ gmpd_client_do_fill(GMpdClient   *self,
 	g_return_val_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable), FALSE);
 	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
 
-	while ((task = g_queue_peek_head(self->task_queue))) {
-		GMpdTaskData *data = g_task_get_task_data(task);
+	if ((self->init_task || self->reconnecting) && !gmpd_client_finish_init(self, error))
+		return FALSE;
+
+	while (TRUE) {
+		GMpdTaskData *data;
 		GError *err = NULL;
 		gboolean result;
+		guint64 n_consumed;
+		gint64 start_time = 0;
+		gint64 receive_time = 0;
+
+		/* a blocking sync only reads from here on, so released commands
+		 * are flushed right away */
+		if (gmpd_client_release_tasks(self) &&
+		    !gmpd_client_do_flush(self, cancellable, &err)) {
+			if (!IS_WOULD_BLOCK(err)) {
+				g_propagate_error(error, err);
+				return FALSE;
+			}
+
+			g_clear_error(&err);
+		}
+
+		task = g_queue_peek_head(self->task_queue);
+		if (!task)
+			break;
+
+		data = g_task_get_task_data(task);
 
 		if (!data->response) {
-			g_queue_pop_head(self->task_queue);
-			RETURN_TASK(self, task, TRUE);
+			gmpd_client_pop_task(self);
+			RETURN_TASK(self, task);
 
 			gmpd_client_do_disconnect(self);
 
 			return TRUE;
 		}
 
+		/* bytes_in also tells whether the task can be sent again
+		 * after a reconnect, so it is counted regardless of metrics */
+		n_consumed = gmpd_input_buffer_get_n_consumed(self->input_buffer);
+
+		if (self->metrics) {
+			start_time = g_get_monotonic_time();
+			receive_time = gmpd_input_buffer_get_receive_time(self->input_buffer);
+		}
+
 		result = gmpd_response_deserialize(data->response,
 		                                   self->version,
-		                                   self->input_stream,
+		                                   self->input_buffer,
 		                                   cancellable,
 		                                   &err);
+
+		data->bytes_in += gmpd_input_buffer_get_n_consumed(self->input_buffer) - n_consumed;
+
+		if (self->metrics) {
+			receive_time = gmpd_input_buffer_get_receive_time(self->input_buffer) - receive_time;
+			data->parse_time += g_get_monotonic_time() - start_time - receive_time;
+		}
+
 		if (!result) {
 			if (IS_WOULD_BLOCK(err) || IS_CANCELLED(err)) {
 				g_propagate_error(error, err);
@@ -1720,9 +4216,18 @@ gmpd_client_do_fill(GMpdClient   *self,
 				return FALSE;
 			}
 
+			if (err->domain != GMPD_ERROR && gmpd_client_will_reconnect(self)) {
+				g_propagate_error(error, err);
+				gmpd_client_do_disconnect(self);
+				return FALSE;
+			}
+
+			if (err->domain == GMPD_ERROR)
+				gmpd_client_record_task(self, task);
+
 			data->error = g_error_copy(err);
-			g_queue_pop_head(self->task_queue);
-			RETURN_TASK(self, task, TRUE);
+			gmpd_client_pop_task(self);
+			RETURN_TASK(self, task);
 
 			if (err->domain != GMPD_ERROR) {
 				g_propagate_error(error, err);
@@ -1735,8 +4240,9 @@ gmpd_client_do_fill(GMpdClient   *self,
 			continue;
 		}
 
-		g_queue_pop_head(self->task_queue);
-		RETURN_TASK(self, task, TRUE);
+		gmpd_client_record_task(self, task);
+		gmpd_client_pop_task(self);
+		RETURN_TASK(self, task);
 	}
 
 	gmpd_client_destroy_input_source(self);
@@ -1786,6 +4292,117 @@ gmpd_client_on_socket_ready(GSocket     *socket,
 	return G_SOURCE_CONTINUE;
 }
 
+static void
+on_socket_client_ready(GObject      *source_object,
+                       GAsyncResult *result,
+                       gpointer      user_data)
+{
+	GTask *task = G_TASK(user_data);
+	GMpdClient *self = GMPD_CLIENT(g_task_get_source_object(task));
+	GSocketConnection *socket_connection;
+	GError *error = NULL;
+
+	socket_connection = g_socket_client_connect_finish(G_SOCKET_CLIENT(source_object),
+	                                                   result,
+	                                                   &error);
+	if (!socket_connection) {
+		LOCK(self);
+		gmpd_client_set_connection_state(self, GMPD_CONNECTION_DISCONNECTED);
+		UNLOCK(self);
+
+		g_task_return_error(task, error);
+		g_object_unref(task);
+		return;
+	}
+
+	LOCK(self);
+
+	gmpd_client_setup_connection(self, socket_connection);
+	g_object_unref(socket_connection);
+
+	self->init_task = task;
+	gmpd_client_attach_input_source(self);
+
+	UNLOCK(self);
+}
+
+static void
+on_reconnect_ready(GObject      *source_object,
+                   GAsyncResult *result,
+                   gpointer      user_data)
+{
+	GMpdClient *self = GMPD_CLIENT(user_data);
+	GSocketConnection *socket_connection;
+
+	socket_connection = g_socket_client_connect_finish(G_SOCKET_CLIENT(source_object),
+	                                                   result,
+	                                                   NULL);
+
+	LOCK(self);
+
+	/* the reconnect was given up on, or a blocking call beat us to it */
+	if (!self->reconnecting || self->reconnect_source || self->socket_connection) {
+		if (socket_connection)
+			g_io_stream_close(G_IO_STREAM(socket_connection), NULL, NULL);
+
+	} else if (!socket_connection) {
+		gmpd_client_schedule_reconnect(self);
+
+	} else {
+		gmpd_client_setup_connection(self, socket_connection);
+		gmpd_client_attach_input_source(self);
+	}
+
+	UNLOCK(self);
+
+	g_clear_object(&socket_connection);
+	g_object_unref(self);
+}
+
+static gboolean
+return_init_task(gpointer data)
+{
+	GTask *task;
+	GError *error;
+
+	g_return_val_if_fail(G_IS_TASK(data), G_SOURCE_REMOVE);
+
+	task = G_TASK(data);
+	error = g_task_get_task_data(task);
+
+	if (error)
+		g_task_return_error(task, g_error_copy(error));
+
+	else if (!g_task_return_error_if_cancelled(task))
+		g_task_return_boolean(task, TRUE);
+
+	return G_SOURCE_REMOVE;
+}
+
+static void
+on_idle_client_ready(GObject      *source_object,
+                     GAsyncResult *result,
+                     gpointer      user_data)
+{
+	GTask *task = G_TASK(user_data);
+	GMpdClient *self = GMPD_CLIENT(g_task_get_source_object(task));
+	GObject *idle_client;
+	GError *error = NULL;
+
+	idle_client = g_async_initable_new_finish(G_ASYNC_INITABLE(source_object), result, &error);
+
+	if (idle_client) {
+		gmpd_client_set_idle_client(self, GMPD_CLIENT(idle_client));
+		g_object_unref(idle_client);
+
+		g_task_return_boolean(task, TRUE);
+	} else {
+		g_task_return_error(task, error);
+	}
+
+	g_object_unref(task);
+}
+
 static gboolean
 return_task(gpointer data)
 {
@@ -1809,3 +4426,129 @@ return_task(gpointer data)
 	return G_SOURCE_REMOVE;
 }
 
+static void
+gmpd_client_end_idle(GMpdClient *self)
+{
+	g_return_if_fail(GMPD_IS_CLIENT(self));
+
+	if (!self->socket_connection)
+		return;
+
+	gmpd_client_noidle(self);
+	gmpd_client_attach_output_source(self);
+}
+
+static gboolean
+end_idle_in_context(gpointer data)
+{
+	GMpdClient *self = data;
+
+	LOCK(self);
+	gmpd_client_end_idle(self);
+	UNLOCK(self);
+
+	return G_SOURCE_REMOVE;
+}
+
+static void
+gmpd_client_emit_idle(GMpdClient *self,
+                      GMpdIdle    changed)
+{
+	GFlagsClass *flags_class;
+	guint i;
+
+	g_return_if_fail(GMPD_IS_CLIENT(self));
+
+	if (changed == GMPD_IDLE_NONE)
+		return;
+
+	flags_class = g_type_class_ref(GMPD_TYPE_IDLE);
+
+	for (i = 0; i < flags_class->n_values; i++) {
+		const GFlagsValue *value = &flags_class->values[i];
+
+		if (!(changed & value->value))
+			continue;
+
+		g_signal_emit(self,
+		              SIGNALS[SIGNAL_IDLE],
+		              g_quark_from_static_string(value->value_nick + strlen("idle-")),
+		              (GMpdIdle) value->value);
+	}
+
+	g_type_class_unref(flags_class);
+}
+
+static gboolean
+gmpd_client_on_idle_window(GMpdClient *self)
+{
+	GMpdIdle changed;
+
+	LOCK(self);
+
+	changed = self->idle_changed;
+	self->idle_changed = GMPD_IDLE_NONE;
+
+	g_clear_pointer(&self->idle_window_source, g_source_unref);
+
+	UNLOCK(self);
+
+	gmpd_client_emit_idle(self, changed);
+
+	return G_SOURCE_REMOVE;
+}
+
+static void
+on_idle_watch_ready(GObject      *source_object,
+                    GAsyncResult *result,
+                    gpointer      user_data G_GNUC_UNUSED)
+{
+	GMpdClient *self = GMPD_CLIENT(source_object);
+	GMpdIdle changed;
+	GError *error = NULL;
+	gboolean rearm;
+
+	changed = gmpd_client_finish_idle_response(self, result, &error);
+
+	LOCK(self);
+
+	/* the watch ends with the connection */
+	if (error)
+		self->idle_watchers = 0;
+
+	rearm = self->idle_watchers > 0;
+	self->idle_armed = rearm;
+
+	if (!rearm) {
+		changed = GMPD_IDLE_NONE;
+
+	} else if (self->idle_window && changed != GMPD_IDLE_NONE) {
+		self->idle_changed |= changed;
+		changed = GMPD_IDLE_NONE;
+
+		if (!self->idle_window_source) {
+			self->idle_window_source = g_timeout_source_new(self->idle_window);
+
+			g_source_set_callback(self->idle_window_source,
+			                      G_SOURCE_FUNC(gmpd_client_on_idle_window),
+			                      g_object_ref(self),
+			                      g_object_unref);
+
+			g_source_attach(self->idle_window_source, GMPD_OBJECT(self)->context);
+		}
+	}
+
+	UNLOCK(self);
+
+	if (error) {
+		if (!g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CLOSED))
+			g_warning("idle watch stopped: %s", error->message);
+
+		g_error_free(error);
+	}
+
+	if (rearm)
+		gmpd_client_idle_async(self, GMPD_IDLE_ALL, NULL, on_idle_watch_ready, NULL);
+
+	gmpd_client_emit_idle(self, changed);
+}
@@ -24,12 +24,17 @@
 #endif
 
 #include <gio/gio.h>
+#include <gmpd-batch.h>
+#include <gmpd-connection-state.h>
+#include <gmpd-entity.h>
 #include <gmpd-idle.h>
+#include <gmpd-metrics.h>
 #include <gmpd-replay-gain-mode.h>
 #include <gmpd-replay-gain-status.h>
 #include <gmpd-song.h>
 #include <gmpd-stats.h>
 #include <gmpd-status.h>
+#include <gmpd-tag.h>
 #include <gmpd-version.h>
 
 G_BEGIN_DECLS
@@ -84,6 +89,19 @@ gboolean        gmpd_client_close_finish            (GMpdClient          *self,
                                                      GAsyncResult        *callback,
                                                      GError             **error);
 
+gboolean        gmpd_client_open_idle_connection        (GMpdClient          *self,
+                                                         GCancellable        *cancellable,
+                                                         GError             **error);
+
+void            gmpd_client_open_idle_connection_async  (GMpdClient          *self,
+                                                         GCancellable        *cancellable,
+                                                         GAsyncReadyCallback  callback,
+                                                         gpointer             user_data);
+
+gboolean        gmpd_client_open_idle_connection_finish (GMpdClient          *self,
+                                                         GAsyncResult        *result,
+                                                         GError             **error);
+
 /*
  * Properties
  */
@@ -93,11 +111,42 @@ void            gmpd_client_set_keepalive           (GMpdClient          *self,
 void            gmpd_client_set_timeout             (GMpdClient          *self,
                                                      guint                timeout);
 
+void            gmpd_client_set_max_pending_commands (GMpdClient         *self,
+                                                      guint               max_pending_commands);
+
+void            gmpd_client_set_max_pending_bytes   (GMpdClient          *self,
+                                                     guint                max_pending_bytes);
+
+void            gmpd_client_set_metrics_enabled     (GMpdClient          *self,
+                                                     gboolean             metrics_enabled);
+
+void            gmpd_client_set_reconnect           (GMpdClient          *self,
+                                                     gboolean             reconnect);
+
+void            gmpd_client_set_tag_types           (GMpdClient          *self,
+                                                     const GMpdTag       *tags,
+                                                     gsize                n_tags);
+
+void            gmpd_client_reset_tag_types         (GMpdClient          *self);
+
+void            gmpd_client_set_idle_window         (GMpdClient          *self,
+                                                     guint                idle_window);
+
 GMainContext *  gmpd_client_get_context             (GMpdClient          *self);
 gchar *         gmpd_client_get_hostname            (GMpdClient          *self);
 guint16         gmpd_client_get_port                (GMpdClient          *self);
 gboolean        gmpd_client_get_keepalive           (GMpdClient          *self);
 guint           gmpd_client_get_timeout             (GMpdClient          *self);
+guint           gmpd_client_get_max_pending_commands (GMpdClient         *self);
+guint           gmpd_client_get_max_pending_bytes   (GMpdClient          *self);
+gboolean        gmpd_client_get_pipeline_full       (GMpdClient          *self);
+gboolean        gmpd_client_get_metrics_enabled     (GMpdClient          *self);
+GMpdMetrics *   gmpd_client_get_metrics             (GMpdClient          *self);
+gboolean        gmpd_client_get_reconnect           (GMpdClient          *self);
+guint           gmpd_client_get_idle_window         (GMpdClient          *self);
+
+GMpdConnectionState gmpd_client_get_connection_state (GMpdClient         *self);
+
 GMpdVersion *   gmpd_client_get_version             (GMpdClient          *self);
 
 
@@ -134,6 +183,10 @@ void            gmpd_client_idle_async              (GMpdClient          *self,
                                                      GAsyncReadyCallback  callback,
                                                      gpointer             user_data);
 
+void            gmpd_client_start_idle_watch        (GMpdClient          *self);
+void            gmpd_client_stop_idle_watch         (GMpdClient          *self);
+gboolean        gmpd_client_get_idle_watching       (GMpdClient          *self);
+
 GMpdStatus *    gmpd_client_status                  (GMpdClient          *self,
                                                      GCancellable        *cancellable,
                                                      GError             **error);
@@ -143,6 +196,17 @@ void            gmpd_client_status_async            (GMpdClient          *self,
                                                      GAsyncReadyCallback  callback,
                                                      gpointer             user_data);
 
+gboolean        gmpd_client_status_into             (GMpdClient          *self,
+                                                     GMpdStatus          *status,
+                                                     GCancellable        *cancellable,
+                                                     GError             **error);
+
+void            gmpd_client_status_into_async       (GMpdClient          *self,
+                                                     GMpdStatus          *status,
+                                                     GCancellable        *cancellable,
+                                                     GAsyncReadyCallback  callback,
+                                                     gpointer             user_data);
+
 GMpdStats *     gmpd_client_stats                   (GMpdClient          *self,
                                                      GCancellable        *cancellable,
                                                      GError             **error);
@@ -176,9 +240,91 @@ void                   gmpd_client_replay_gain_status_async (GMpdClient
                                                              GAsyncReadyCallback  callback,
                                                              gpointer             user_data);
 
+/*
+ * Database
+ */
+GPtrArray *     gmpd_client_playlistinfo            (GMpdClient          *self,
+                                                     GCancellable        *cancellable,
+                                                     GError             **error);
+
+void            gmpd_client_playlistinfo_async      (GMpdClient          *self,
+                                                     GCancellable        *cancellable,
+                                                     GAsyncReadyCallback  callback,
+                                                     gpointer             user_data);
+
+void            gmpd_client_playlistinfo_foreach_async (GMpdClient          *self,
+                                                        GMpdEntityFunc       func,
+                                                        gpointer             func_data,
+                                                        GCancellable        *cancellable,
+                                                        GAsyncReadyCallback  callback,
+                                                        gpointer             user_data);
+
+GPtrArray *     gmpd_client_listallinfo             (GMpdClient          *self,
+                                                     const gchar         *path,
+                                                     GCancellable        *cancellable,
+                                                     GError             **error);
+
+void            gmpd_client_listallinfo_async       (GMpdClient          *self,
+                                                     const gchar         *path,
+                                                     GCancellable        *cancellable,
+                                                     GAsyncReadyCallback  callback,
+                                                     gpointer             user_data);
+
+void            gmpd_client_listallinfo_foreach_async (GMpdClient          *self,
+                                                       const gchar         *path,
+                                                       GMpdEntityFunc       func,
+                                                       gpointer             func_data,
+                                                       GCancellable        *cancellable,
+                                                       GAsyncReadyCallback  callback,
+                                                       gpointer             user_data);
+
+GBytes *        gmpd_client_albumart                (GMpdClient          *self,
+                                                     const gchar         *uri,
+                                                     gsize                offset,
+                                                     GCancellable        *cancellable,
+                                                     GError             **error);
+
+void            gmpd_client_albumart_async          (GMpdClient          *self,
+                                                     const gchar         *uri,
+                                                     gsize                offset,
+                                                     GCancellable        *cancellable,
+                                                     GAsyncReadyCallback  callback,
+                                                     gpointer             user_data);
+
+GBytes *        gmpd_client_readpicture             (GMpdClient          *self,
+                                                     const gchar         *uri,
+                                                     gsize                offset,
+                                                     GCancellable        *cancellable,
+                                                     GError             **error);
+
+void            gmpd_client_readpicture_async       (GMpdClient          *self,
+                                                     const gchar         *uri,
+                                                     gsize                offset,
+                                                     GCancellable        *cancellable,
+                                                     GAsyncReadyCallback  callback,
+                                                     gpointer             user_data);
+
+/*
+ * Command Lists
+ */
+gboolean        gmpd_client_batch                   (GMpdClient          *self,
+                                                     GMpdBatch           *batch,
+                                                     GCancellable        *cancellable,
+                                                     GError             **error);
+
+void            gmpd_client_batch_async             (GMpdClient          *self,
+                                                     GMpdBatch           *batch,
+                                                     GCancellable        *cancellable,
+                                                     GAsyncReadyCallback  callback,
+                                                     gpointer             user_data);
+
 /*
  * Responses
  */
+GMpdBatch *     gmpd_client_finish_batch_response   (GMpdClient          *self,
+                                                     GAsyncResult        *result,
+                                                     GError             **error);
+
 GMpdSong *      gmpd_client_finish_song_response    (GMpdClient          *self,
                                                      GAsyncResult        *result,
                                                      GError             **error);
@@ -203,6 +349,14 @@ GMpdReplayGainStatus * gmpd_client_finish_replay_gain_status_response (GMpdClien
                                                                        GAsyncResult  *result,
                                                                        GError       **error);
 
+GPtrArray *     gmpd_client_finish_entity_list_response (GMpdClient          *self,
+                                                         GAsyncResult        *result,
+                                                         GError             **error);
+
+GBytes *        gmpd_client_finish_binary_response  (GMpdClient          *self,
+                                                     GAsyncResult        *result,
+                                                     GError             **error);
+
 G_END_DECLS
 
 #endif /* __GMPD_CLIENT_H__ */
@@ -0,0 +1,42 @@
+/* libgmpd: MPD protocol implementation for GLib
+ * Copyright (C) 2020 Patrick Keating <binarydrifter@protonmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <gio/gio.h>
+#include "gmpd-connection-state.h"
+
+static const GEnumValue CONNECTION_STATE_VALUES[] = {
+	{GMPD_CONNECTION_DISCONNECTED, "GMPD_CONNECTION_DISCONNECTED", "connection-disconnected"},
+	{GMPD_CONNECTION_WAITING,      "GMPD_CONNECTION_WAITING",      "connection-waiting"},
+	{GMPD_CONNECTION_CONNECTING,   "GMPD_CONNECTION_CONNECTING",   "connection-connecting"},
+	{GMPD_CONNECTION_CONNECTED,    "GMPD_CONNECTION_CONNECTED",    "connection-connected"},
+	{0, NULL, NULL}
+};
+
+GType
+gmpd_connection_state_get_type(void)
+{
+	static gsize init = 0;
+	static GType type = 0;
+
+	if (g_once_init_enter(&init)) {
+		type = g_enum_register_static("GMpdConnectionState", CONNECTION_STATE_VALUES);
+		g_once_init_leave(&init, 1);
+	}
+
+	return type;
+}
@@ -0,0 +1,47 @@
+/* libgmpd: MPD protocol implementation for GLib
+ * Copyright (C) 2020 Patrick Keating <binarydrifter@protonmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef __GMPD_CONNECTION_STATE_H__
+#define __GMPD_CONNECTION_STATE_H__
+
+#if !defined(__GMPD_H_INSIDE__) && !defined(__GMPD_BUILD__)
+#   error "Only <gmpd.h> can be included directly."
+#endif
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+#define GMPD_TYPE_CONNECTION_STATE \
+	(gmpd_connection_state_get_type())
+
+#define GMPD_IS_CONNECTION_STATE(state) \
+	((state) >= GMPD_CONNECTION_DISCONNECTED && (state) <= GMPD_CONNECTION_CONNECTED)
+
+typedef enum _GMpdConnectionState {
+	GMPD_CONNECTION_DISCONNECTED,
+	GMPD_CONNECTION_WAITING,
+	GMPD_CONNECTION_CONNECTING,
+	GMPD_CONNECTION_CONNECTED,
+} GMpdConnectionState;
+
+GType  gmpd_connection_state_get_type  (void);
+
+G_END_DECLS
+
+#endif /* __GMPD_CONNECTION_STATE_H__ */
@@ -0,0 +1,822 @@
+/* libgmpd: MPD protocol implementation for GLib
+ * Copyright (C) 2020 Patrick Keating <binarydrifter@protonmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <string.h>
+#include <gio/gio.h>
+#include "gmpd-audio-format.h"
+#include "gmpd-db-snapshot.h"
+#include "gmpd-directory.h"
+#include "gmpd-entity.h"
+#include "gmpd-entity-priv.h"
+#include "gmpd-response.h"
+#include "gmpd-song.h"
+#include "gmpd-stats.h"
+#include "gmpd-tag.h"
+#include "gmpd-version.h"
+
+/* A snapshot is a single file laid out so it can be used straight from
+ * a read-only mapping:
+ *
+ *   Header
+ *   string table      NUL terminated strings, referenced by offset
+ *   Directory[]       breadth first, so the subdirectories of one
+ *                     directory are contiguous, index 0 is the root
+ *   Song[]            grouped by directory in directory order
+ *   Tag[]             tag values of the songs, grouped by song and
+ *                     then by tag
+ *
+ * Every section starts at an 8 byte boundary and the records are in
+ * host byte order, a snapshot from a host of another byte order is
+ * refused and has to be recreated. Tags are stored by name, so adding
+ * a tag to GMpdTag does not invalidate existing snapshots, and tags a
+ * reader does not know are skipped. Records are bounds checked when they
+ * are read, so opening a snapshot touches nothing but the header.
+ */
+#define SNAPSHOT_MAGIC      "GMPDSNAP"
+#define SNAPSHOT_VERSION    2
+#define SNAPSHOT_BYTE_ORDER 0x01020304
+
+#define NO_INDEX G_MAXUINT32
+#define NO_TIME  G_MININT64
+
+#define ALIGN(n) \
+	(((n) + 7) & ~(gsize) 7)
+
+typedef struct _Header {
+	gchar   magic[8];
+	guint32 version;
+	guint32 byte_order;
+	gint64  db_update;
+	guint32 server;
+	guint32 strings_len;
+	guint32 n_directories;
+	guint32 n_songs;
+	guint32 n_tags;
+	guint32 reserved;
+} Header;
+
+typedef struct _Directory {
+	gint64  last_modified;
+	guint32 path;
+	guint32 parent;
+	guint32 first_child;
+	guint32 n_children;
+	guint32 first_song;
+	guint32 n_songs;
+} Directory;
+
+typedef struct _Song {
+	gint64  last_modified;
+	guint32 path;
+	guint32 directory;
+	gfloat  duration;
+	gfloat  range_start;
+	gfloat  range_end;
+	guint32 sample_rate;
+	guint8  bit_depth;
+	guint8  channels;
+	guint8  has_format;
+	guint8  reserved;
+	guint32 first_tag;
+	guint32 n_tags;
+	guint32 padding;
+} Song;
+
+typedef struct _Tag {
+	guint32 name;
+	guint32 value;
+} Tag;
+
+G_STATIC_ASSERT(sizeof(Header) == 48);
+G_STATIC_ASSERT(sizeof(Directory) == 32);
+G_STATIC_ASSERT(sizeof(Song) == 48);
+G_STATIC_ASSERT(sizeof(Tag) == 8);
+
+enum {
+	PROP_NONE,
+	PROP_SERVER,
+	PROP_DB_UPDATE,
+	N_PROPERTIES,
+};
+
+/* Songs are filled through their response interface like parsed ones.
+ * The interface wants the version of the server, which a snapshot does
+ * not keep, the song parser does not look at it.
+ */
+struct _GMpdDbSnapshot {
+	GObject          __base__;
+	GMappedFile     *file;
+	GMpdVersion     *version;
+	const Header    *header;
+	const gchar     *strings;
+	const Directory *directories;
+	const Song      *songs;
+	const Tag       *tags;
+};
+
+struct _GMpdDbSnapshotClass {
+	GObjectClass __base__;
+};
+
+G_DEFINE_TYPE(GMpdDbSnapshot, gmpd_db_snapshot, G_TYPE_OBJECT)
+
+static GParamSpec *PROPERTIES[N_PROPERTIES] = {NULL};
+
+static void
+gmpd_db_snapshot_get_property(GObject    *object,
+                              guint       prop_id,
+                              GValue     *value,
+                              GParamSpec *pspec)
+{
+	GMpdDbSnapshot *self = GMPD_DB_SNAPSHOT(object);
+
+	switch (prop_id) {
+	case PROP_SERVER:
+		g_value_take_string(value, gmpd_db_snapshot_get_server(self));
+		break;
+
+	case PROP_DB_UPDATE:
+		g_value_take_boxed(value, gmpd_db_snapshot_get_db_update(self));
+		break;
+
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+	}
+}
+
+static void
+gmpd_db_snapshot_finalize(GObject *object)
+{
+	GMpdDbSnapshot *self = GMPD_DB_SNAPSHOT(object);
+
+	g_clear_pointer(&self->file, g_mapped_file_unref);
+	g_clear_object(&self->version);
+
+	G_OBJECT_CLASS(gmpd_db_snapshot_parent_class)->finalize(object);
+}
+
+static void
+gmpd_db_snapshot_class_init(GMpdDbSnapshotClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(klass);
+
+	object_class->get_property = gmpd_db_snapshot_get_property;
+	object_class->finalize = gmpd_db_snapshot_finalize;
+
+	PROPERTIES[PROP_SERVER] =
+		g_param_spec_string("server",
+		                    "Server",
+		                    "Identity of the server the snapshot was taken from",
+		                    NULL,
+		                    G_PARAM_READABLE |
+		                    G_PARAM_STATIC_STRINGS);
+
+	PROPERTIES[PROP_DB_UPDATE] =
+		g_param_spec_boxed("db-update",
+		                   "Database Update",
+		                   "Time of the database update the snapshot was taken after",
+		                   G_TYPE_DATE_TIME,
+		                   G_PARAM_READABLE |
+		                   G_PARAM_STATIC_STRINGS);
+
+	g_object_class_install_properties(object_class, N_PROPERTIES, PROPERTIES);
+}
+
+static void
+gmpd_db_snapshot_init(GMpdDbSnapshot *self)
+{
+	self->file = NULL;
+	self->version = gmpd_version_new(0, 0, 0);
+	self->header = NULL;
+	self->strings = NULL;
+	self->directories = NULL;
+	self->songs = NULL;
+	self->tags = NULL;
+}
+
+/* cannot overflow, every count is 32 bits wide */
+static guint64
+snapshot_size(const Header *header)
+{
+	return ALIGN((guint64) sizeof(Header) + header->strings_len) +
+	       (guint64) header->n_directories * sizeof(Directory) +
+	       (guint64) header->n_songs * sizeof(Song) +
+	       (guint64) header->n_tags * sizeof(Tag);
+}
+
+GMpdDbSnapshot *
+gmpd_db_snapshot_new_from_file(const gchar  *filename,
+                               GError      **error)
+{
+	GMpdDbSnapshot *self;
+	GMappedFile *file;
+	const Header *header;
+	const gchar *contents;
+	gsize length;
+
+	g_return_val_if_fail(filename != NULL, NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	file = g_mapped_file_new(filename, FALSE, error);
+	if (!file)
+		return NULL;
+
+	contents = g_mapped_file_get_contents(file);
+	length = g_mapped_file_get_length(file);
+	header = (const Header *) contents;
+
+	if (length < sizeof(Header) || memcmp(header->magic, SNAPSHOT_MAGIC, 8) != 0) {
+		g_set_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+		            "%s is not a database snapshot", filename);
+		g_mapped_file_unref(file);
+		return NULL;
+	}
+
+	if (header->version != SNAPSHOT_VERSION || header->byte_order != SNAPSHOT_BYTE_ORDER) {
+		g_set_error(error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+		            "%s was written in an unsupported format", filename);
+		g_mapped_file_unref(file);
+		return NULL;
+	}
+
+	/* the string table must be terminated, so that any offset into it
+	 * yields a valid string */
+	if (snapshot_size(header) > G_MAXSIZE ||
+	    length != snapshot_size(header) ||
+	    header->strings_len == 0 ||
+	    contents[sizeof(Header) + header->strings_len - 1] != '\0' ||
+	    header->server >= header->strings_len ||
+	    header->n_directories == 0) {
+		g_set_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+		            "%s is truncated or corrupted", filename);
+		g_mapped_file_unref(file);
+		return NULL;
+	}
+
+	self = g_object_new(GMPD_TYPE_DB_SNAPSHOT, NULL);
+
+	self->file = file;
+	self->header = header;
+	self->strings = contents + sizeof(Header);
+	self->directories = (const Directory *) (contents + ALIGN(sizeof(Header) + header->strings_len));
+	self->songs = (const Song *) (self->directories + header->n_directories);
+	self->tags = (const Tag *) (self->songs + header->n_songs);
+
+	return self;
+}
+
+static const gchar *
+gmpd_db_snapshot_peek_string(GMpdDbSnapshot *self,
+                             guint32         offset)
+{
+	if (offset >= self->header->strings_len) {
+		g_warning("string offset %u out of range", offset);
+		return "";
+	}
+
+	return self->strings + offset;
+}
+
+static GDateTime *
+date_time_new_from_snapshot(gint64 time)
+{
+	return time != NO_TIME ? g_date_time_new_from_unix_utc(time) : NULL;
+}
+
+gboolean
+gmpd_db_snapshot_is_current(GMpdDbSnapshot *self,
+                            const gchar    *server,
+                            GMpdStats      *stats)
+{
+	GDateTime *db_update;
+	gboolean retval;
+
+	g_return_val_if_fail(GMPD_IS_DB_SNAPSHOT(self), FALSE);
+	g_return_val_if_fail(server != NULL, FALSE);
+	g_return_val_if_fail(GMPD_IS_STATS(stats), FALSE);
+
+	if (g_strcmp0(gmpd_db_snapshot_peek_string(self, self->header->server), server) != 0)
+		return FALSE;
+
+	db_update = gmpd_stats_get_db_update(stats);
+	if (!db_update)
+		return FALSE;
+
+	retval = g_date_time_to_unix(db_update) == self->header->db_update;
+
+	g_date_time_unref(db_update);
+
+	return retval;
+}
+
+gchar *
+gmpd_db_snapshot_get_server(GMpdDbSnapshot *self)
+{
+	g_return_val_if_fail(GMPD_IS_DB_SNAPSHOT(self), NULL);
+	return g_strdup(gmpd_db_snapshot_peek_string(self, self->header->server));
+}
+
+GDateTime *
+gmpd_db_snapshot_get_db_update(GMpdDbSnapshot *self)
+{
+	g_return_val_if_fail(GMPD_IS_DB_SNAPSHOT(self), NULL);
+	return date_time_new_from_snapshot(self->header->db_update);
+}
+
+guint
+gmpd_db_snapshot_get_n_songs(GMpdDbSnapshot *self)
+{
+	g_return_val_if_fail(GMPD_IS_DB_SNAPSHOT(self), 0);
+	return self->header->n_songs;
+}
+
+GMpdSong *
+gmpd_db_snapshot_get_song(GMpdDbSnapshot *self,
+                          guint           index)
+{
+	const Song *record;
+	GMpdSong *song;
+	GDateTime *last_modified;
+	guint i;
+
+	g_return_val_if_fail(GMPD_IS_DB_SNAPSHOT(self), NULL);
+	g_return_val_if_fail(index < self->header->n_songs, NULL);
+
+	record = &self->songs[index];
+	song = gmpd_song_new();
+
+	gmpd_entity_set_path(GMPD_ENTITY(song), gmpd_db_snapshot_peek_string(self, record->path));
+
+	last_modified = date_time_new_from_snapshot(record->last_modified);
+	if (last_modified) {
+		gmpd_entity_set_last_modified(GMPD_ENTITY(song), last_modified);
+		g_date_time_unref(last_modified);
+	}
+
+	gmpd_song_set_duration(song, record->duration);
+	gmpd_song_set_range_start(song, record->range_start);
+	gmpd_song_set_range_end(song, record->range_end);
+
+	if (record->has_format) {
+		GMpdAudioFormat *format = gmpd_audio_format_new();
+
+		gmpd_audio_format_set_sample_rate(format, record->sample_rate);
+		gmpd_audio_format_set_bit_depth(format, record->bit_depth);
+		gmpd_audio_format_set_channels(format, record->channels);
+
+		gmpd_song_set_format(song, format);
+		g_object_unref(format);
+	}
+
+	if (record->first_tag > self->header->n_tags ||
+	    record->n_tags > self->header->n_tags - record->first_tag) {
+		g_warning("tags of song %u out of range", index);
+		return song;
+	}
+
+	/* fed like a parsed response, so the tag block is built in one
+	 * pass, tags this build does not know are skipped */
+	for (i = 0; i < record->n_tags; i++) {
+		const Tag *tag = &self->tags[record->first_tag + i];
+		const gchar *name = gmpd_db_snapshot_peek_string(self, tag->name);
+
+		if (GMPD_TAG_IS_VALID(gmpd_tag_from_string(name))) {
+			gmpd_response_feed_pair(GMPD_RESPONSE(song),
+			                        self->version,
+			                        name,
+			                        gmpd_db_snapshot_peek_string(self, tag->value));
+		}
+	}
+
+	gmpd_response_finish(GMPD_RESPONSE(song), self->version);
+
+	return song;
+}
+
+const gchar *
+gmpd_db_snapshot_peek_song_path(GMpdDbSnapshot *self,
+                                guint           index)
+{
+	g_return_val_if_fail(GMPD_IS_DB_SNAPSHOT(self), NULL);
+	g_return_val_if_fail(index < self->header->n_songs, NULL);
+	return gmpd_db_snapshot_peek_string(self, self->songs[index].path);
+}
+
+guint
+gmpd_db_snapshot_get_n_directories(GMpdDbSnapshot *self)
+{
+	g_return_val_if_fail(GMPD_IS_DB_SNAPSHOT(self), 0);
+	return self->header->n_directories;
+}
+
+GMpdDirectory *
+gmpd_db_snapshot_get_directory(GMpdDbSnapshot *self,
+                               guint           index)
+{
+	const Directory *record;
+	GMpdDirectory *directory;
+	GDateTime *last_modified;
+
+	g_return_val_if_fail(GMPD_IS_DB_SNAPSHOT(self), NULL);
+	g_return_val_if_fail(index < self->header->n_directories, NULL);
+
+	record = &self->directories[index];
+	directory = gmpd_directory_new();
+
+	gmpd_entity_set_path(GMPD_ENTITY(directory), gmpd_db_snapshot_peek_string(self, record->path));
+
+	last_modified = date_time_new_from_snapshot(record->last_modified);
+	if (last_modified) {
+		gmpd_entity_set_last_modified(GMPD_ENTITY(directory), last_modified);
+		g_date_time_unref(last_modified);
+	}
+
+	return directory;
+}
+
+const gchar *
+gmpd_db_snapshot_peek_directory_path(GMpdDbSnapshot *self,
+                                     guint           index)
+{
+	g_return_val_if_fail(GMPD_IS_DB_SNAPSHOT(self), NULL);
+	g_return_val_if_fail(index < self->header->n_directories, NULL);
+	return gmpd_db_snapshot_peek_string(self, self->directories[index].path);
+}
+
+/* Returns GMPD_DB_SNAPSHOT_NO_DIRECTORY for the root. */
+guint
+gmpd_db_snapshot_get_directory_parent(GMpdDbSnapshot *self,
+                                      guint           index)
+{
+	guint32 parent;
+
+	g_return_val_if_fail(GMPD_IS_DB_SNAPSHOT(self), GMPD_DB_SNAPSHOT_NO_DIRECTORY);
+	g_return_val_if_fail(index < self->header->n_directories, GMPD_DB_SNAPSHOT_NO_DIRECTORY);
+
+	parent = self->directories[index].parent;
+
+	return parent < self->header->n_directories ? parent : GMPD_DB_SNAPSHOT_NO_DIRECTORY;
+}
+
+static void
+get_range(guint32  first,
+          guint32  n,
+          guint32  limit,
+          guint   *first_out,
+          guint   *n_out)
+{
+	if (first > limit || n > limit - first) {
+		g_warning("range %u+%u out of bounds", first, n);
+		first = 0;
+		n = 0;
+	}
+
+	if (first_out)
+		*first_out = first;
+
+	if (n_out)
+		*n_out = n;
+}
+
+void
+gmpd_db_snapshot_get_directory_children(GMpdDbSnapshot *self,
+                                        guint           index,
+                                        guint          *first,
+                                        guint          *n_children)
+{
+	const Directory *record;
+
+	g_return_if_fail(GMPD_IS_DB_SNAPSHOT(self));
+	g_return_if_fail(index < self->header->n_directories);
+
+	record = &self->directories[index];
+	get_range(record->first_child, record->n_children, self->header->n_directories, first, n_children);
+}
+
+void
+gmpd_db_snapshot_get_directory_songs(GMpdDbSnapshot *self,
+                                     guint           index,
+                                     guint          *first,
+                                     guint          *n_songs)
+{
+	const Directory *record;
+
+	g_return_if_fail(GMPD_IS_DB_SNAPSHOT(self));
+	g_return_if_fail(index < self->header->n_directories);
+
+	record = &self->directories[index];
+	get_range(record->first_song, record->n_songs, self->header->n_songs, first, n_songs);
+}
+
+/*
+ * Writing snapshots
+ */
+typedef struct _BuildDirectory {
+	gchar       *path;
+	gint64       last_modified;
+	GArray      *children;
+	GPtrArray   *songs;
+} BuildDirectory;
+
+typedef struct _Builder {
+	GByteArray *strings;
+	GHashTable *string_offsets;
+	GPtrArray  *directories;
+	GHashTable *directory_indices;
+} Builder;
+
+static void
+build_directory_free(BuildDirectory *directory)
+{
+	g_free(directory->path);
+	g_array_unref(directory->children);
+	g_ptr_array_unref(directory->songs);
+	g_free(directory);
+}
+
+static BuildDirectory *
+build_directory_new(const gchar *path)
+{
+	BuildDirectory *directory = g_new0(BuildDirectory, 1);
+
+	directory->path = g_strdup(path);
+	directory->last_modified = NO_TIME;
+	directory->children = g_array_new(FALSE, FALSE, sizeof(guint));
+	directory->songs = g_ptr_array_new();
+
+	return directory;
+}
+
+static guint32
+builder_add_string(Builder     *builder,
+                   const gchar *s)
+{
+	gpointer offset;
+
+	if (!s)
+		s = "";
+
+	if (g_hash_table_lookup_extended(builder->string_offsets, s, NULL, &offset))
+		return GPOINTER_TO_UINT(offset);
+
+	offset = GUINT_TO_POINTER(builder->strings->len);
+	g_byte_array_append(builder->strings, (const guint8 *) s, strlen(s) + 1);
+	g_hash_table_insert(builder->string_offsets, (gpointer) s, offset);
+
+	return GPOINTER_TO_UINT(offset);
+}
+
+static guint
+builder_get_directory(Builder     *builder,
+                      const gchar *path)
+{
+	BuildDirectory *directory;
+	BuildDirectory *parent;
+	gpointer index;
+	const gchar *slash;
+	gchar *parent_path;
+	guint n;
+
+	if (g_hash_table_lookup_extended(builder->directory_indices, path, NULL, &index))
+		return GPOINTER_TO_UINT(index);
+
+	slash = strrchr(path, '/');
+	parent_path = slash ? g_strndup(path, slash - path) : g_strdup("");
+	parent = builder->directories->pdata[builder_get_directory(builder, parent_path)];
+	g_free(parent_path);
+
+	directory = build_directory_new(path);
+
+	n = builder->directories->len;
+	g_ptr_array_add(builder->directories, directory);
+	g_hash_table_insert(builder->directory_indices, directory->path, GUINT_TO_POINTER(n));
+	g_array_append_val(parent->children, n);
+
+	return n;
+}
+
+static gint64
+date_time_to_snapshot(GDateTime *date_time)
+{
+	return date_time ? g_date_time_to_unix(date_time) : NO_TIME;
+}
+
+static void
+builder_add_song(Builder   *builder,
+                 GArray    *songs,
+                 GArray    *tags,
+                 GMpdSong  *song,
+                 guint32    directory)
+{
+	GMpdEntity *entity = GMPD_ENTITY(song);
+	GMpdAudioFormat *format;
+	Song record;
+	GMpdTag tag;
+
+	memset(&record, 0, sizeof(record));
+
+	record.path = builder_add_string(builder, entity->path);
+	record.directory = directory;
+	record.last_modified = date_time_to_snapshot(entity->last_modified);
+	record.duration = gmpd_song_get_duration(song);
+	record.range_start = gmpd_song_get_range_start(song);
+	record.range_end = gmpd_song_get_range_end(song);
+
+	format = gmpd_song_get_format(song);
+	if (format) {
+		record.has_format = TRUE;
+		record.sample_rate = gmpd_audio_format_get_sample_rate(format);
+		record.bit_depth = gmpd_audio_format_get_bit_depth(format);
+		record.channels = gmpd_audio_format_get_channels(format);
+		g_object_unref(format);
+	}
+
+	record.first_tag = tags->len;
+
+	for (tag = 0; tag < GMPD_N_TAGS; tag++) {
+		const gchar *value;
+		guint32 name = 0;
+		guint i;
+
+		for (i = 0; (value = gmpd_song_peek_tag(song, tag, i)); i++) {
+			Tag tag_record;
+
+			/* the quark's string lives as long as the string table */
+			if (i == 0)
+				name = builder_add_string(builder, g_quark_to_string(gmpd_tag_to_quark(tag)));
+
+			tag_record.name = name;
+			tag_record.value = builder_add_string(builder, value);
+			g_array_append_val(tags, tag_record);
+		}
+	}
+
+	record.n_tags = tags->len - record.first_tag;
+
+	g_array_append_val(songs, record);
+}
+
+/* Writes the result of listallinfo for the whole database as a snapshot.
+ * server identifies the server, like "host:port", and db_update is the
+ * database update time from the stats, together they decide whether the
+ * snapshot can be reused. Playlists are not part of the snapshot.
+ */
+gboolean
+gmpd_db_snapshot_save(const gchar  *filename,
+                      const gchar  *server,
+                      GDateTime    *db_update,
+                      GPtrArray    *entities,
+                      GError      **error)
+{
+	Builder builder;
+	Header header;
+	GArray *order;
+	GArray *directories;
+	GArray *songs;
+	GArray *tags;
+	GByteArray *contents;
+	gboolean retval;
+	guint i;
+
+	g_return_val_if_fail(filename != NULL, FALSE);
+	g_return_val_if_fail(server != NULL, FALSE);
+	g_return_val_if_fail(db_update != NULL, FALSE);
+	g_return_val_if_fail(entities != NULL, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	builder.strings = g_byte_array_new();
+	builder.string_offsets = g_hash_table_new(g_str_hash, g_str_equal);
+	builder.directories = g_ptr_array_new_with_free_func((GDestroyNotify) build_directory_free);
+	builder.directory_indices = g_hash_table_new(g_str_hash, g_str_equal);
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, SNAPSHOT_MAGIC, 8);
+	header.version = SNAPSHOT_VERSION;
+	header.byte_order = SNAPSHOT_BYTE_ORDER;
+	header.db_update = g_date_time_to_unix(db_update);
+	header.server = builder_add_string(&builder, server);
+
+	/* the root ends the recursion of builder_get_directory() */
+	g_ptr_array_add(builder.directories, build_directory_new(""));
+	g_hash_table_insert(builder.directory_indices,
+	                    ((BuildDirectory *) builder.directories->pdata[0])->path,
+	                    GUINT_TO_POINTER(0));
+
+	for (i = 0; i < entities->len; i++) {
+		GMpdEntity *entity = entities->pdata[i];
+		const gchar *path = entity->path ? entity->path : "";
+
+		if (GMPD_IS_DIRECTORY(entity)) {
+			BuildDirectory *directory;
+
+			directory = builder.directories->pdata[builder_get_directory(&builder, path)];
+			directory->last_modified = date_time_to_snapshot(entity->last_modified);
+		} else if (GMPD_IS_SONG(entity)) {
+			const gchar *slash = strrchr(path, '/');
+			gchar *parent_path = slash ? g_strndup(path, slash - path) : g_strdup("");
+			BuildDirectory *directory;
+
+			directory = builder.directories->pdata[builder_get_directory(&builder, parent_path)];
+			g_ptr_array_add(directory->songs, entity);
+
+			g_free(parent_path);
+		}
+	}
+
+	/* lay the directories out breadth first, order maps a position in
+	 * the file to the directory built at that index */
+	order = g_array_sized_new(FALSE, FALSE, sizeof(guint), builder.directories->len);
+	directories = g_array_sized_new(FALSE, TRUE, sizeof(Directory), builder.directories->len);
+	songs = g_array_new(FALSE, TRUE, sizeof(Song));
+	tags = g_array_new(FALSE, TRUE, sizeof(Tag));
+
+	i = 0;
+	g_array_append_val(order, i);
+
+	for (i = 0; i < order->len; i++) {
+		BuildDirectory *directory = builder.directories->pdata[g_array_index(order, guint, i)];
+		Directory record;
+		guint j;
+
+		memset(&record, 0, sizeof(record));
+
+		record.path = builder_add_string(&builder, directory->path);
+		record.last_modified = directory->last_modified;
+		record.parent = NO_INDEX;
+		record.first_child = order->len;
+		record.n_children = directory->children->len;
+		record.first_song = songs->len;
+		record.n_songs = directory->songs->len;
+
+		g_array_append_vals(order, directory->children->data, directory->children->len);
+		g_array_append_val(directories, record);
+
+		for (j = 0; j < directory->songs->len; j++)
+			builder_add_song(&builder, songs, tags, directory->songs->pdata[j], i);
+	}
+
+	for (i = 0; i < directories->len; i++) {
+		Directory *record = &g_array_index(directories, Directory, i);
+		guint j;
+
+		for (j = 0; j < record->n_children; j++)
+			g_array_index(directories, Directory, record->first_child + j).parent = i;
+	}
+
+	header.strings_len = builder.strings->len;
+	header.n_directories = directories->len;
+	header.n_songs = songs->len;
+	header.n_tags = tags->len;
+
+	/* the whole file is built in one GByteArray */
+	if (snapshot_size(&header) > G_MAXUINT) {
+		g_set_error(error, G_IO_ERROR, G_IO_ERROR_NO_SPACE,
+		            "The database is too large for a snapshot");
+		retval = FALSE;
+		goto out;
+	}
+
+	contents = g_byte_array_sized_new(snapshot_size(&header));
+	g_byte_array_append(contents, (const guint8 *) &header, sizeof(header));
+	g_byte_array_append(contents, builder.strings->data, builder.strings->len);
+	g_byte_array_set_size(contents, ALIGN(contents->len));
+	memset(contents->data + sizeof(header) + builder.strings->len, 0,
+	       contents->len - sizeof(header) - builder.strings->len);
+	g_byte_array_append(contents, (const guint8 *) directories->data, directories->len * sizeof(Directory));
+	g_byte_array_append(contents, (const guint8 *) songs->data, songs->len * sizeof(Song));
+	g_byte_array_append(contents, (const guint8 *) tags->data, tags->len * sizeof(Tag));
+
+	/* written to a temporary file and renamed over the old snapshot, so
+	 * a reader never maps a half written one */
+	retval = g_file_set_contents(filename, (const gchar *) contents->data, contents->len, error);
+
+	g_byte_array_unref(contents);
+
+out:
+	g_array_unref(tags);
+	g_array_unref(songs);
+	g_array_unref(directories);
+	g_array_unref(order);
+	g_hash_table_unref(builder.string_offsets);
+	g_hash_table_unref(builder.directory_indices);
+	g_ptr_array_unref(builder.directories);
+	g_byte_array_unref(builder.strings);
+
+	return retval;
+}
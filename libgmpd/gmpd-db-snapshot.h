@@ -0,0 +1,101 @@
+/* libgmpd: MPD protocol implementation for GLib
+ * Copyright (C) 2020 Patrick Keating <binarydrifter@protonmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef __GMPD_DB_SNAPSHOT_H__
+#define __GMPD_DB_SNAPSHOT_H__
+
+#if !defined(__GMPD_H_INSIDE__) && !defined(__GMPD_BUILD__)
+#   error "Only <gmpd.h> can be included directly."
+#endif
+
+#include <gio/gio.h>
+#include <gmpd-directory.h>
+#include <gmpd-song.h>
+#include <gmpd-stats.h>
+
+G_BEGIN_DECLS
+
+#define GMPD_TYPE_DB_SNAPSHOT \
+	(gmpd_db_snapshot_get_type())
+
+#define GMPD_DB_SNAPSHOT(inst) \
+	(G_TYPE_CHECK_INSTANCE_CAST((inst), GMPD_TYPE_DB_SNAPSHOT, GMpdDbSnapshot))
+
+#define GMPD_DB_SNAPSHOT_CLASS(klass) \
+	(G_TYPE_CHECK_CLASS_CAST((klass), GMPD_TYPE_DB_SNAPSHOT, GMpdDbSnapshotClass))
+
+#define GMPD_IS_DB_SNAPSHOT(inst) \
+	(G_TYPE_CHECK_INSTANCE_TYPE((inst), GMPD_TYPE_DB_SNAPSHOT))
+
+#define GMPD_IS_DB_SNAPSHOT_CLASS(klass) \
+	(G_TYPE_CHECK_CLASS_TYPE((klass), GMPD_TYPE_DB_SNAPSHOT))
+
+#define GMPD_DB_SNAPSHOT_GET_CLASS(inst) \
+	(G_TYPE_INSTANCE_GET_CLASS((inst), GMPD_TYPE_DB_SNAPSHOT, GMpdDbSnapshotClass))
+
+#define GMPD_DB_SNAPSHOT_NO_DIRECTORY G_MAXUINT
+
+typedef struct _GMpdDbSnapshot      GMpdDbSnapshot;
+typedef struct _GMpdDbSnapshotClass GMpdDbSnapshotClass;
+
+GType             gmpd_db_snapshot_get_type               (void);
+
+GMpdDbSnapshot *  gmpd_db_snapshot_new_from_file          (const gchar     *filename,
+                                                           GError         **error);
+
+gboolean          gmpd_db_snapshot_save                   (const gchar     *filename,
+                                                           const gchar     *server,
+                                                           GDateTime       *db_update,
+                                                           GPtrArray       *entities,
+                                                           GError         **error);
+
+gboolean          gmpd_db_snapshot_is_current             (GMpdDbSnapshot  *self,
+                                                           const gchar     *server,
+                                                           GMpdStats       *stats);
+
+gchar *           gmpd_db_snapshot_get_server             (GMpdDbSnapshot  *self);
+GDateTime *       gmpd_db_snapshot_get_db_update          (GMpdDbSnapshot  *self);
+
+guint             gmpd_db_snapshot_get_n_songs            (GMpdDbSnapshot  *self);
+GMpdSong *        gmpd_db_snapshot_get_song               (GMpdDbSnapshot  *self,
+                                                           guint            index);
+const gchar *     gmpd_db_snapshot_peek_song_path         (GMpdDbSnapshot  *self,
+                                                           guint            index);
+
+guint             gmpd_db_snapshot_get_n_directories      (GMpdDbSnapshot  *self);
+GMpdDirectory *   gmpd_db_snapshot_get_directory          (GMpdDbSnapshot  *self,
+                                                           guint            index);
+const gchar *     gmpd_db_snapshot_peek_directory_path    (GMpdDbSnapshot  *self,
+                                                           guint            index);
+guint             gmpd_db_snapshot_get_directory_parent   (GMpdDbSnapshot  *self,
+                                                           guint            index);
+
+void              gmpd_db_snapshot_get_directory_children (GMpdDbSnapshot  *self,
+                                                           guint            index,
+                                                           guint           *first,
+                                                           guint           *n_children);
+
+void              gmpd_db_snapshot_get_directory_songs    (GMpdDbSnapshot  *self,
+                                                           guint            index,
+                                                           guint           *first,
+                                                           guint           *n_songs);
+
+G_END_DECLS
+
+#endif /* __GMPD_DB_SNAPSHOT_H__ */
@@ -0,0 +1,48 @@
+/* libgmpd: MPD protocol implementation for GLib
+ * Copyright (C) 2020 Patrick Keating <binarydrifter@protonmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <gio/gio.h>
+#include "gmpd-directory.h"
+#include "gmpd-entity.h"
+#include "gmpd-entity-priv.h"
+
+struct _GMpdDirectory {
+	GMpdEntity __base__;
+};
+
+struct _GMpdDirectoryClass {
+	GMpdEntityClass __base__;
+};
+
+G_DEFINE_TYPE(GMpdDirectory, gmpd_directory, GMPD_TYPE_ENTITY)
+
+static void
+gmpd_directory_class_init(GMpdDirectoryClass *klass G_GNUC_UNUSED)
+{
+}
+
+static void
+gmpd_directory_init(GMpdDirectory *self G_GNUC_UNUSED)
+{
+}
+
+GMpdDirectory *
+gmpd_directory_new(void)
+{
+	return g_object_new(GMPD_TYPE_DIRECTORY, NULL);
+}
@@ -0,0 +1,241 @@
+/* libgmpd: MPD protocol implementation for GLib
+ * Copyright (C) 2020 Patrick Keating <binarydrifter@protonmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <gio/gio.h>
+#include "gmpd-directory.h"
+#include "gmpd-entity.h"
+#include "gmpd-entity-priv.h"
+#include "gmpd-entity-list.h"
+#include "gmpd-key.h"
+#include "gmpd-object.h"
+#include "gmpd-object-priv.h"
+#include "gmpd-playlist.h"
+#include "gmpd-response.h"
+#include "gmpd-song.h"
+#include "gmpd-version.h"
+
+static void gmpd_entity_list_response_iface_init(GMpdResponseIface *iface);
+static void gmpd_entity_list_complete(GMpdEntityList *self, GMpdVersion *version);
+
+typedef struct _EntityCall {
+	GMpdEntityFunc  func;
+	gpointer        func_data;
+	GMpdEntity     *entity;
+} EntityCall;
+
+/* Entities are collected into an array, unless a function was set, in
+ * which case each one is handed to it in the owner's context as soon
+ * as the next one starts.
+ */
+struct _GMpdEntityList {
+	GObject         __base__;
+	GMpdEntity     *current;
+	GPtrArray      *entities;
+
+	GMpdObject     *owner;
+	GMpdEntityFunc  func;
+	gpointer        func_data;
+};
+
+struct _GMpdEntityListClass {
+	GObjectClass __base__;
+};
+
+G_DEFINE_TYPE_WITH_CODE(GMpdEntityList, gmpd_entity_list, G_TYPE_OBJECT,
+                        G_IMPLEMENT_INTERFACE(GMPD_TYPE_RESPONSE,
+                                              gmpd_entity_list_response_iface_init))
+
+static void
+gmpd_entity_list_response_feed_pair(GMpdResponse *response,
+                                    GMpdVersion  *version,
+                                    const gchar  *key,
+                                    const gchar  *value)
+{
+	GMpdEntityList *self;
+	GMpdKey entity_key;
+
+	g_return_if_fail(GMPD_IS_ENTITY_LIST(response));
+	g_return_if_fail(GMPD_IS_VERSION(version));
+	g_return_if_fail(key != NULL);
+	g_return_if_fail(value != NULL);
+
+	self = GMPD_ENTITY_LIST(response);
+	entity_key = gmpd_key_from_string(key);
+
+	switch (entity_key) {
+	case GMPD_KEY_FILE:
+		gmpd_entity_list_complete(self, version);
+		self->current = GMPD_ENTITY(gmpd_song_new());
+		self->current->path = g_strdup(value);
+		break;
+
+	case GMPD_KEY_DIRECTORY:
+		gmpd_entity_list_complete(self, version);
+		self->current = GMPD_ENTITY(gmpd_directory_new());
+		self->current->path = g_strdup(value);
+		break;
+
+	case GMPD_KEY_PLAYLIST:
+		gmpd_entity_list_complete(self, version);
+		self->current = GMPD_ENTITY(gmpd_playlist_new());
+		self->current->path = g_strdup(value);
+		break;
+
+	default:
+		if (!self->current) {
+			g_warning("%s: pair before the first entity: %s", __func__, key);
+
+		} else if (GMPD_IS_SONG(self->current)) {
+			gmpd_response_feed_pair(GMPD_RESPONSE(self->current), version, key, value);
+
+		} else if (entity_key == GMPD_KEY_LAST_MODIFIED) {
+			g_clear_pointer(&self->current->last_modified, g_date_time_unref);
+			self->current->last_modified = g_date_time_new_from_iso8601(value, NULL);
+
+		} else {
+			g_warning("%s: unknown key: %s", __func__, key);
+		}
+	}
+}
+
+static void
+gmpd_entity_list_response_finish(GMpdResponse *response,
+                                 GMpdVersion  *version)
+{
+	g_return_if_fail(GMPD_IS_ENTITY_LIST(response));
+	gmpd_entity_list_complete(GMPD_ENTITY_LIST(response), version);
+}
+
+static void
+gmpd_entity_list_response_iface_init(GMpdResponseIface *iface)
+{
+	iface->feed_pair = gmpd_entity_list_response_feed_pair;
+	iface->finish = gmpd_entity_list_response_finish;
+}
+
+static gboolean
+entity_call_invoke(gpointer data)
+{
+	EntityCall *call = data;
+
+	call->func(call->entity, call->func_data);
+
+	return G_SOURCE_REMOVE;
+}
+
+static void
+entity_call_free(gpointer data)
+{
+	EntityCall *call = data;
+
+	g_object_unref(call->entity);
+	g_slice_free(EntityCall, call);
+}
+
+/* Responses are fed with the owner locked. */
+static void
+gmpd_entity_list_complete(GMpdEntityList *self,
+                          GMpdVersion    *version)
+{
+	EntityCall *call;
+
+	g_return_if_fail(GMPD_IS_ENTITY_LIST(self));
+
+	if (!self->current)
+		return;
+
+	if (GMPD_IS_RESPONSE(self->current))
+		gmpd_response_finish(GMPD_RESPONSE(self->current), version);
+
+	if (!self->func) {
+		g_ptr_array_add(self->entities, g_steal_pointer(&self->current));
+		return;
+	}
+
+	call = g_slice_new(EntityCall);
+	call->func = self->func;
+	call->func_data = self->func_data;
+	call->entity = g_steal_pointer(&self->current);
+
+	gmpd_object_run_in_context(self->owner, entity_call_invoke, call, entity_call_free);
+}
+
+static void
+gmpd_entity_list_finalize(GObject *object)
+{
+	GMpdEntityList *self = GMPD_ENTITY_LIST(object);
+
+	g_clear_object(&self->current);
+	g_clear_pointer(&self->entities, g_ptr_array_unref);
+	g_clear_object(&self->owner);
+
+	G_OBJECT_CLASS(gmpd_entity_list_parent_class)->finalize(object);
+}
+
+static void
+gmpd_entity_list_class_init(GMpdEntityListClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(klass);
+
+	object_class->finalize = gmpd_entity_list_finalize;
+}
+
+static void
+gmpd_entity_list_init(GMpdEntityList *self)
+{
+	self->current = NULL;
+	self->entities = g_ptr_array_new_with_free_func(g_object_unref);
+
+	self->owner = NULL;
+	self->func = NULL;
+	self->func_data = NULL;
+}
+
+GMpdEntityList *
+gmpd_entity_list_new(void)
+{
+	return g_object_new(GMPD_TYPE_ENTITY_LIST, NULL);
+}
+
+void
+gmpd_entity_list_set_func(GMpdEntityList *self,
+                          GMpdObject     *owner,
+                          GMpdEntityFunc  func,
+                          gpointer        func_data)
+{
+	g_return_if_fail(GMPD_IS_ENTITY_LIST(self));
+	g_return_if_fail(GMPD_IS_OBJECT(owner));
+	g_return_if_fail(func != NULL);
+
+	g_set_object(&self->owner, owner);
+	self->func = func;
+	self->func_data = func_data;
+}
+
+GPtrArray *
+gmpd_entity_list_steal_entities(GMpdEntityList *self)
+{
+	GPtrArray *entities;
+
+	g_return_val_if_fail(GMPD_IS_ENTITY_LIST(self), NULL);
+
+	entities = g_steal_pointer(&self->entities);
+	self->entities = g_ptr_array_new_with_free_func(g_object_unref);
+
+	return entities;
+}
@@ -0,0 +1,66 @@
+/* libgmpd: MPD protocol implementation for GLib
+ * Copyright (C) 2020 Patrick Keating <binarydrifter@protonmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef __GMPD_ENTITY_LIST_H__
+#define __GMPD_ENTITY_LIST_H__
+
+#if !defined(__GMPD_BUILD__)
+#   error "This file is private to libgmpd and should not be included."
+#endif
+
+#include <gio/gio.h>
+#include <gmpd-entity.h>
+#include <gmpd-object.h>
+
+G_BEGIN_DECLS
+
+#define GMPD_TYPE_ENTITY_LIST \
+	(gmpd_entity_list_get_type())
+
+#define GMPD_ENTITY_LIST(inst) \
+	(G_TYPE_CHECK_INSTANCE_CAST((inst), GMPD_TYPE_ENTITY_LIST, GMpdEntityList))
+
+#define GMPD_ENTITY_LIST_CLASS(klass) \
+	(G_TYPE_CHECK_CLASS_CAST((klass), GMPD_TYPE_ENTITY_LIST, GMpdEntityListClass))
+
+#define GMPD_IS_ENTITY_LIST(inst) \
+	(G_TYPE_CHECK_INSTANCE_TYPE((inst), GMPD_TYPE_ENTITY_LIST))
+
+#define GMPD_IS_ENTITY_LIST_CLASS(klass) \
+	(G_TYPE_CHECK_CLASS_TYPE((klass), GMPD_TYPE_ENTITY_LIST))
+
+#define GMPD_ENTITY_LIST_GET_CLASS(inst) \
+	(G_TYPE_INSTANCE_GET_CLASS((inst), GMPD_TYPE_ENTITY_LIST, GMpdEntityListClass))
+
+typedef struct _GMpdEntityList      GMpdEntityList;
+typedef struct _GMpdEntityListClass GMpdEntityListClass;
+
+GType             gmpd_entity_list_get_type        (void);
+
+GMpdEntityList *  gmpd_entity_list_new             (void);
+
+void              gmpd_entity_list_set_func        (GMpdEntityList *self,
+                                                    GMpdObject     *owner,
+                                                    GMpdEntityFunc  func,
+                                                    gpointer        func_data);
+
+GPtrArray *       gmpd_entity_list_steal_entities  (GMpdEntityList *self);
+
+G_END_DECLS
+
+#endif /* __GMPD_ENTITY_LIST_H__ */
@@ -48,6 +48,9 @@ G_BEGIN_DECLS
 typedef struct _GMpdEntity      GMpdEntity;
 typedef struct _GMpdEntityClass GMpdEntityClass;
 
+typedef void (*GMpdEntityFunc) (GMpdEntity *entity,
+                                gpointer    user_data);
+
 GType        gmpd_entity_get_type           (void);
 
 void         gmpd_entity_set_path           (GMpdEntity  *self,
@@ -16,12 +16,21 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
  */
 
+#include <string.h>
 #include <gio/gio.h>
 #include "gmpd-error.h"
 
 G_DEFINE_QUARK(GMPD_ERROR, gmpd_error)
 
-static GRegex *gmpd_error_regex(void);
+typedef struct _ErrorMatch {
+	const gchar *code;
+	const gchar *command;
+	gsize        command_len;
+	const gchar *message;
+	gsize        message_len;
+} ErrorMatch;
+
+static gboolean gmpd_error_match(const gchar *s, ErrorMatch *match);
 
 static const GEnumValue GMPD_ERROR_ENUM_VALUES[] = {
 	{GMPD_ERROR_UNKNOWN,
@@ -96,62 +105,83 @@ gmpd_error_enum_get_type(void)
 GError *
 gmpd_error_from_string(const gchar *s)
 {
-	GRegex *regex;
-	GMatchInfo *match_info;
-	gchar *pos_1;
-	gchar *pos_3;
-	gchar *pos_4;
+	ErrorMatch match;
 	gint code;
-	GError *error;
 
 	g_return_val_if_fail(s != NULL, NULL);
 
-	regex = gmpd_error_regex();
-
-	if (!g_regex_match(regex, s, 0, &match_info)) {
-		g_match_info_unref(match_info);
-
+	if (!gmpd_error_match(s, &match)) {
 		return g_error_new(GMPD_ERROR,
 		                   GMPD_ERROR_UNKNOWN,
 		                   "invalid error string: %s", s);
 	}
 
-	pos_1 = g_match_info_fetch(match_info, 1);
-	pos_3 = g_match_info_fetch(match_info, 3);
-	pos_4 = g_match_info_fetch(match_info, 4);
-
-	code = g_ascii_strtoll(pos_1, NULL, 10);
+	code = g_ascii_strtoll(match.code, NULL, 10);
 	if (!GMPD_IS_ERROR_ENUM(code)) {
 		g_warning("unknown error code returned from MPD: %d", code);
 		code = GMPD_ERROR_UNKNOWN;
 	}
 
-	error = g_error_new(GMPD_ERROR, code, "%s: %s", pos_3, pos_4);
+	return g_error_new(GMPD_ERROR, code, "%.*s: %.*s",
+	                   (gint) match.command_len, match.command,
+	                   (gint) match.message_len, match.message);
+}
 
-	g_free(pos_1);
-	g_free(pos_3);
-	g_free(pos_4);
-	g_match_info_unref(match_info);
+static const gchar *
+skip_digits(const gchar *s)
+{
+	const gchar *p = s;
 
-	return error;
+	while (g_ascii_isdigit(*p))
+		p++;
+
+	return p > s ? p : NULL;
 }
 
-static GRegex *
-gmpd_error_regex(void)
+/* Matches "ACK [<digits>@<digits>] {<command>} <message>" anywhere in s.
+ * The command can not contain '}' and the message ends at the end of
+ * the line.
+ */
+static gboolean
+gmpd_error_try_match(const gchar *s,
+                     ErrorMatch  *match)
 {
-	static const gchar *const regex_str = "ACK \\[(\\d+)@(\\d+)\\] {([^}]+)} (.*)";
-	static GRegex *regex = NULL;
-	static gsize initialized = 0;
+	const gchar *p;
 
-	if (g_once_init_enter(&initialized)) {
-		regex = g_regex_new(regex_str, G_REGEX_OPTIMIZE, 0, NULL);
-		if (!regex) {
-			g_error("unable to compile regex string: %s", regex_str);
-		}
+	if (!g_str_has_prefix(s, "ACK ["))
+		return FALSE;
 
-		g_once_init_leave(&initialized, 1);
-	}
+	match->code = s + 5;
 
-	return regex;
+	if (!(p = skip_digits(match->code)) || *p != '@')
+		return FALSE;
+
+	if (!(p = skip_digits(p + 1)) || *p != ']')
+		return FALSE;
+
+	if (p[1] != ' ' || p[2] != '{' || p[3] == '}' || p[3] == '\0')
+		return FALSE;
+
+	match->command = p + 3;
+
+	if (!(p = strchr(match->command, '}')) || p[1] != ' ')
+		return FALSE;
+
+	match->command_len = p - match->command;
+	match->message = p + 2;
+	match->message_len = strcspn(match->message, "\n");
+
+	return TRUE;
 }
 
+static gboolean
+gmpd_error_match(const gchar *s,
+                 ErrorMatch  *match)
+{
+	for (s = strstr(s, "ACK ["); s; s = strstr(s + 1, "ACK [")) {
+		if (gmpd_error_try_match(s, match))
+			return TRUE;
+	}
+
+	return FALSE;
+}
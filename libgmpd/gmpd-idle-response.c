@@ -62,7 +62,7 @@ gmpd_idle_response_feed_pair(GMpdResponse *response,
 		return;
 	}
 
-	gmpd_idle_response_set_changed(self, self->changed | idle);
+	self->changed |= idle;
 }
 
 
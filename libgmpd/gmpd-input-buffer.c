@@ -0,0 +1,222 @@
+/* libgmpd: MPD protocol implementation for GLib
+ * Copyright (C) 2020 Patrick Keating <binarydrifter@protonmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <string.h>
+#include <gio/gio.h>
+#include "gmpd-input-buffer.h"
+
+static const gsize INITIAL_SIZE = 64 * 1024;
+
+/* Unread data lives in data[start, end). Lines are handed out as pointers
+ * into the buffer, so the unread data is moved back to the start of the
+ * buffer instead of wrapping around when space runs out at the end.
+ * Everything before scan is known not to contain a newline.
+ */
+struct _GMpdInputBuffer {
+	GSocket *socket;
+	gchar   *data;
+	gsize    size;
+	gsize    start;
+	gsize    end;
+	gsize    scan;
+
+	guint64  n_consumed;
+	gint64   receive_time;
+};
+
+GMpdInputBuffer *
+gmpd_input_buffer_new(GSocket *socket)
+{
+	GMpdInputBuffer *self;
+
+	g_return_val_if_fail(G_IS_SOCKET(socket), NULL);
+
+	self = g_slice_new(GMpdInputBuffer);
+	self->socket = g_object_ref(socket);
+	self->data = g_malloc(INITIAL_SIZE);
+	self->size = INITIAL_SIZE;
+	self->start = 0;
+	self->end = 0;
+	self->scan = 0;
+
+	self->n_consumed = 0;
+	self->receive_time = 0;
+
+	return self;
+}
+
+void
+gmpd_input_buffer_free(GMpdInputBuffer *self)
+{
+	g_return_if_fail(self != NULL);
+
+	g_clear_object(&self->socket);
+	g_clear_pointer(&self->data, g_free);
+
+	g_slice_free(GMpdInputBuffer, self);
+}
+
+static void
+gmpd_input_buffer_consume(GMpdInputBuffer *self,
+                          gsize            count)
+{
+	self->start += count;
+	self->n_consumed += count;
+
+	if (self->start == self->end) {
+		self->start = 0;
+		self->end = 0;
+	}
+
+	self->scan = self->start;
+}
+
+static gboolean
+gmpd_input_buffer_fill(GMpdInputBuffer *self,
+                       GCancellable    *cancellable,
+                       GError         **error)
+{
+	gssize n_read;
+	gint64 start_time;
+
+	if (self->end == self->size) {
+		if (self->start) {
+			memmove(self->data, self->data + self->start, self->end - self->start);
+
+			self->end -= self->start;
+			self->scan -= self->start;
+			self->start = 0;
+
+		} else {
+			self->size *= 2;
+			self->data = g_realloc(self->data, self->size);
+		}
+	}
+
+	start_time = g_get_monotonic_time();
+
+	n_read = g_socket_receive(self->socket,
+	                          self->data + self->end,
+	                          self->size - self->end,
+	                          cancellable,
+	                          error);
+
+	self->receive_time += g_get_monotonic_time() - start_time;
+	if (n_read < 0)
+		return FALSE;
+
+	if (n_read == 0) {
+		g_set_error_literal(error,
+		                    G_IO_ERROR,
+		                    G_IO_ERROR_CONNECTION_CLOSED,
+		                    "The connection was closed by the server");
+		return FALSE;
+	}
+
+	self->end += n_read;
+
+	return TRUE;
+}
+
+gchar *
+gmpd_input_buffer_read_line(GMpdInputBuffer *self,
+                            gsize           *length,
+                            GCancellable    *cancellable,
+                            GError         **error)
+{
+	g_return_val_if_fail(self != NULL, NULL);
+	g_return_val_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable), NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	while (TRUE) {
+		gchar *newline = memchr(self->data + self->scan, '\n', self->end - self->scan);
+
+		if (newline) {
+			gchar *line = self->data + self->start;
+			gsize line_len = newline - line;
+
+			*newline = '\0';
+			gmpd_input_buffer_consume(self, line_len + 1);
+
+			if (!g_utf8_validate(line, line_len, NULL)) {
+				g_set_error(error,
+				            G_IO_ERROR,
+				            G_IO_ERROR_INVALID_DATA,
+				            "invalid UTF-8 in line: %s", line);
+				return NULL;
+			}
+
+			if (length)
+				*length = line_len;
+
+			return line;
+		}
+
+		self->scan = self->end;
+
+		if (!gmpd_input_buffer_fill(self, cancellable, error))
+			return NULL;
+	}
+
+	g_return_val_if_reached(NULL);
+}
+
+const guint8 *
+gmpd_input_buffer_read_bytes(GMpdInputBuffer *self,
+                             gsize            count,
+                             gsize           *length,
+                             GCancellable    *cancellable,
+                             GError         **error)
+{
+	const guint8 *bytes;
+	gsize n_bytes;
+
+	g_return_val_if_fail(self != NULL, NULL);
+	g_return_val_if_fail(count > 0, NULL);
+	g_return_val_if_fail(length != NULL, NULL);
+	g_return_val_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable), NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	if (self->start == self->end && !gmpd_input_buffer_fill(self, cancellable, error))
+		return NULL;
+
+	bytes = (const guint8 *) self->data + self->start;
+	n_bytes = MIN(count, self->end - self->start);
+
+	gmpd_input_buffer_consume(self, n_bytes);
+
+	*length = n_bytes;
+	return bytes;
+}
+
+guint64
+gmpd_input_buffer_get_n_consumed(GMpdInputBuffer *self)
+{
+	g_return_val_if_fail(self != NULL, 0);
+	return self->n_consumed;
+}
+
+/* Time spent waiting in g_socket_receive(), which lets callers tell
+ * parsing apart from waiting for the server.
+ */
+gint64
+gmpd_input_buffer_get_receive_time(GMpdInputBuffer *self)
+{
+	g_return_val_if_fail(self != NULL, 0);
+	return self->receive_time;
+}
@@ -0,0 +1,51 @@
+/* libgmpd: MPD protocol implementation for GLib
+ * Copyright (C) 2020 Patrick Keating <binarydrifter@protonmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef __GMPD_INPUT_BUFFER_H__
+#define __GMPD_INPUT_BUFFER_H__
+
+#if !defined(__GMPD_BUILD__)
+#   error "This file is private to libgmpd and should not be included."
+#endif
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GMpdInputBuffer GMpdInputBuffer;
+
+GMpdInputBuffer * gmpd_input_buffer_new               (GSocket          *socket);
+void              gmpd_input_buffer_free              (GMpdInputBuffer  *self);
+
+gchar *           gmpd_input_buffer_read_line         (GMpdInputBuffer  *self,
+                                                       gsize            *length,
+                                                       GCancellable     *cancellable,
+                                                       GError          **error);
+
+const guint8 *    gmpd_input_buffer_read_bytes        (GMpdInputBuffer  *self,
+                                                       gsize             count,
+                                                       gsize            *length,
+                                                       GCancellable     *cancellable,
+                                                       GError          **error);
+
+guint64           gmpd_input_buffer_get_n_consumed    (GMpdInputBuffer  *self);
+gint64            gmpd_input_buffer_get_receive_time  (GMpdInputBuffer  *self);
+
+G_END_DECLS
+
+#endif /* __GMPD_INPUT_BUFFER_H__ */
@@ -0,0 +1,290 @@
+#!/usr/bin/env python3
+#
+# libgmpd: MPD protocol implementation for GLib
+# Copyright (C) 2020 Patrick Keating <binarydrifter@protonmail.com>
+#
+# This library is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Lesser General Public
+# License as published by the Free Software Foundation; either
+# version 2.1 of the License, or (at your option) any later version.
+#
+# This library is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public
+# License along with this library; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+#
+# Generates gmpd-key.h and gmpd-key.c, which map the keys of the pairs
+# sent by MPD to a GMpdKey using a perfect hash. Run it from this
+# directory after changing KEYS and commit the result.
+
+import os
+
+# The tags must come first and be in the same order as GMpdTag.
+TAGS = [
+    ('ARTIST', 'Artist'),
+    ('ARTIST_SORT', 'ArtistSort'),
+    ('ALBUM', 'Album'),
+    ('ALBUM_SORT', 'AlbumSort'),
+    ('ALBUM_ARTIST', 'AlbumArtist'),
+    ('ALBUM_ARTIST_SORT', 'AlbumArtistSort'),
+    ('TITLE', 'Title'),
+    ('TRACK', 'Track'),
+    ('NAME', 'Name'),
+    ('GENRE', 'Genre'),
+    ('DATE', 'Date'),
+    ('ORIGINAL_DATE', 'OriginalDate'),
+    ('COMPOSER', 'Composer'),
+    ('PERFORMER', 'Performer'),
+    ('CONDUCTOR', 'Conductor'),
+    ('WORK', 'Work'),
+    ('GROUPING', 'Grouping'),
+    ('COMMENT', 'Comment'),
+    ('DISC', 'Disc'),
+    ('LABEL', 'Label'),
+    ('MUSICBRAINZ_ARTIST_ID', 'MUSICBRAINZ_ARTISTID'),
+    ('MUSICBRAINZ_ALBUM_ID', 'MUSICBRAINZ_ALBUMID'),
+    ('MUSICBRAINZ_ALBUM_ARTIST_ID', 'MUSICBRAINZ_ALBUMARTISTID'),
+    ('MUSICBRAINZ_TRACK_ID', 'MUSICBRAINZ_TRACKID'),
+    ('MUSICBRAINZ_RELEASE_TRACK_ID', 'MUSICBRAINZ_RELEASETRACKID'),
+    ('MUSICBRAINZ_WORK_ID', 'MUSICBRAINZ_WORKID'),
+]
+
+KEYS = TAGS + [
+    # songs
+    ('FILE', 'file'),
+    ('LAST_MODIFIED', 'Last-Modified'),
+    ('POS', 'Pos'),
+    ('ID', 'Id'),
+    ('PRIO', 'Prio'),
+    ('SONG_TIME', 'Time'),
+    ('DURATION', 'duration'),
+    ('RANGE', 'Range'),
+    ('FORMAT', 'Format'),
+
+    # status
+    ('PARTITION', 'partition'),
+    ('VOLUME', 'volume'),
+    ('REPEAT', 'repeat'),
+    ('RANDOM', 'random'),
+    ('SINGLE', 'single'),
+    ('CONSUME', 'consume'),
+    ('PLAYLIST', 'playlist'),
+    ('PLAYLIST_LENGTH', 'playlistlength'),
+    ('STATE', 'state'),
+    ('SONG', 'song'),
+    ('SONG_ID', 'songid'),
+    ('NEXT_SONG', 'nextsong'),
+    ('NEXT_SONG_ID', 'nextsongid'),
+    ('TIME', 'time'),
+    ('ELAPSED', 'elapsed'),
+    ('BITRATE', 'bitrate'),
+    ('XFADE', 'xfade'),
+    ('MIXRAMP_DB', 'mixrampdb'),
+    ('MIXRAMP_DELAY', 'mixrampdelay'),
+    ('AUDIO', 'audio'),
+    ('UPDATING_DB', 'updating_db'),
+    ('ERROR', 'error'),
+
+    # stats
+    ('ARTISTS', 'artists'),
+    ('ALBUMS', 'albums'),
+    ('SONGS', 'songs'),
+    ('UPTIME', 'uptime'),
+    ('DB_PLAYTIME', 'db_playtime'),
+    ('DB_UPDATE', 'db_update'),
+    ('PLAYTIME', 'playtime'),
+
+    # database
+    ('DIRECTORY', 'directory'),
+
+    # misc
+    ('REPLAY_GAIN_MODE', 'replay_gain_mode'),
+    ('CHANGED', 'changed'),
+]
+
+LICENSE = '''/* libgmpd: MPD protocol implementation for GLib
+ * Copyright (C) 2020 Patrick Keating <binarydrifter@protonmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* This file is generated by gmpd-key-gen.py, do not edit. */
+'''
+
+
+def fnv1a(seed, s):
+    h = (seed ^ 2166136261) & 0xffffffff
+    for c in s.encode():
+        h ^= c
+        h = (h * 16777619) & 0xffffffff
+    return h
+
+
+def build(keys):
+    n_slots = 1
+    while n_slots < 2 * len(keys):
+        n_slots *= 2
+
+    n_buckets = n_slots // 4
+
+    buckets = [[] for _ in range(n_buckets)]
+    for i, (_, string) in enumerate(keys):
+        buckets[fnv1a(0, string) % n_buckets].append(i)
+
+    seeds = [0] * n_buckets
+    slots = [-1] * n_slots
+
+    for b in sorted(range(n_buckets), key=lambda b: -len(buckets[b])):
+        if not buckets[b]:
+            break
+
+        seed = 1
+        while True:
+            wanted = [fnv1a(seed, keys[i][1]) % n_slots for i in buckets[b]]
+
+            if len(set(wanted)) == len(wanted) and all(slots[w] < 0 for w in wanted):
+                break
+
+            seed += 1
+
+        seeds[b] = seed
+        for i, w in zip(buckets[b], wanted):
+            slots[w] = i
+
+    return seeds, slots
+
+
+def write_header(path):
+    width = max(len(name) for name, _ in KEYS) + len('GMPD_KEY_')
+
+    with open(path, 'w') as f:
+        f.write(LICENSE)
+        f.write('''
+#ifndef __GMPD_KEY_H__
+#define __GMPD_KEY_H__
+
+#if !defined(__GMPD_BUILD__)
+#   error "This file is private to libgmpd and should not be included."
+#endif
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+#define GMPD_KEY_IS_TAG(key) \\
+	((key) > GMPD_KEY_UNKNOWN && (key) < GMPD_N_TAG_KEYS)
+
+typedef enum _GMpdKey {
+	GMPD_KEY_UNKNOWN = -1,
+''')
+        for name, string in KEYS:
+            f.write('\t%-*s /* %s */\n' % (width + 1, 'GMPD_KEY_%s,' % name, string))
+
+            if name == TAGS[-1][0]:
+                f.write('\n')
+
+        f.write('''	GMPD_N_KEYS,
+
+	GMPD_N_TAG_KEYS = GMPD_KEY_%s + 1,
+} GMpdKey;
+
+GMpdKey  gmpd_key_from_string  (const gchar *s);
+
+G_END_DECLS
+
+#endif /* __GMPD_KEY_H__ */
+''' % TAGS[-1][0])
+
+
+def write_source(path):
+    seeds, slots = build(KEYS)
+
+    with open(path, 'w') as f:
+        f.write(LICENSE)
+        f.write('''
+#include <string.h>
+#include <glib.h>
+#include "gmpd-key.h"
+#include "gmpd-tag.h"
+
+''')
+        for name, _ in TAGS:
+            f.write('G_STATIC_ASSERT((gint) GMPD_KEY_%s == (gint) GMPD_TAG_%s);\n' % (name, name))
+
+        f.write('\nstatic const gchar *const KEY_NAMES[GMPD_N_KEYS] = {\n')
+        for name, string in KEYS:
+            f.write('\t[GMPD_KEY_%s] = "%s",\n' % (name, string))
+        f.write('};\n')
+
+        f.write('\nstatic const guint16 SEEDS[%d] = {' % len(seeds))
+        for i, seed in enumerate(seeds):
+            f.write('%s%d,' % ('\n\t' if i % 12 == 0 else ' ', seed))
+        f.write('\n};\n')
+
+        f.write('\nstatic const gint16 SLOTS[%d] = {' % len(slots))
+        for i, slot in enumerate(slots):
+            f.write('%s%d,' % ('\n\t' if i % 16 == 0 else ' ', slot))
+        f.write('\n};\n')
+
+        f.write('''
+static inline guint32
+gmpd_key_hash(guint32      seed,
+              const gchar *s)
+{
+	guint32 h = seed ^ 2166136261u;
+
+	for (; *s; s++) {
+		h ^= (guchar) *s;
+		h *= 16777619u;
+	}
+
+	return h;
+}
+
+/* The perfect hash picks the only slot the key can be in, so at most
+ * one string comparison is needed.
+ */
+GMpdKey
+gmpd_key_from_string(const gchar *s)
+{
+	guint32 seed;
+	gint key;
+
+	g_return_val_if_fail(s != NULL, GMPD_KEY_UNKNOWN);
+
+	seed = SEEDS[gmpd_key_hash(0, s) % G_N_ELEMENTS(SEEDS)];
+	key = SLOTS[gmpd_key_hash(seed, s) % G_N_ELEMENTS(SLOTS)];
+
+	if (key < 0 || strcmp(KEY_NAMES[key], s) != 0)
+		return GMPD_KEY_UNKNOWN;
+
+	return (GMpdKey) key;
+}
+''')
+
+
+def main():
+    os.chdir(os.path.dirname(os.path.abspath(__file__)))
+
+    write_header('gmpd-key.h')
+    write_source('gmpd-key.c')
+
+
+if __name__ == '__main__':
+    main()
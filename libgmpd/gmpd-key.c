@@ -0,0 +1,183 @@
+/* libgmpd: MPD protocol implementation for GLib
+ * Copyright (C) 2020 Patrick Keating <binarydrifter@protonmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* This file is generated by gmpd-key-gen.py, do not edit. */
+
+#include <string.h>
+#include <glib.h>
+#include "gmpd-key.h"
+#include "gmpd-tag.h"
+
+G_STATIC_ASSERT((gint) GMPD_KEY_ARTIST == (gint) GMPD_TAG_ARTIST);
+G_STATIC_ASSERT((gint) GMPD_KEY_ARTIST_SORT == (gint) GMPD_TAG_ARTIST_SORT);
+G_STATIC_ASSERT((gint) GMPD_KEY_ALBUM == (gint) GMPD_TAG_ALBUM);
+G_STATIC_ASSERT((gint) GMPD_KEY_ALBUM_SORT == (gint) GMPD_TAG_ALBUM_SORT);
+G_STATIC_ASSERT((gint) GMPD_KEY_ALBUM_ARTIST == (gint) GMPD_TAG_ALBUM_ARTIST);
+G_STATIC_ASSERT((gint) GMPD_KEY_ALBUM_ARTIST_SORT == (gint) GMPD_TAG_ALBUM_ARTIST_SORT);
+G_STATIC_ASSERT((gint) GMPD_KEY_TITLE == (gint) GMPD_TAG_TITLE);
+G_STATIC_ASSERT((gint) GMPD_KEY_TRACK == (gint) GMPD_TAG_TRACK);
+G_STATIC_ASSERT((gint) GMPD_KEY_NAME == (gint) GMPD_TAG_NAME);
+G_STATIC_ASSERT((gint) GMPD_KEY_GENRE == (gint) GMPD_TAG_GENRE);
+G_STATIC_ASSERT((gint) GMPD_KEY_DATE == (gint) GMPD_TAG_DATE);
+G_STATIC_ASSERT((gint) GMPD_KEY_ORIGINAL_DATE == (gint) GMPD_TAG_ORIGINAL_DATE);
+G_STATIC_ASSERT((gint) GMPD_KEY_COMPOSER == (gint) GMPD_TAG_COMPOSER);
+G_STATIC_ASSERT((gint) GMPD_KEY_PERFORMER == (gint) GMPD_TAG_PERFORMER);
+G_STATIC_ASSERT((gint) GMPD_KEY_CONDUCTOR == (gint) GMPD_TAG_CONDUCTOR);
+G_STATIC_ASSERT((gint) GMPD_KEY_WORK == (gint) GMPD_TAG_WORK);
+G_STATIC_ASSERT((gint) GMPD_KEY_GROUPING == (gint) GMPD_TAG_GROUPING);
+G_STATIC_ASSERT((gint) GMPD_KEY_COMMENT == (gint) GMPD_TAG_COMMENT);
+G_STATIC_ASSERT((gint) GMPD_KEY_DISC == (gint) GMPD_TAG_DISC);
+G_STATIC_ASSERT((gint) GMPD_KEY_LABEL == (gint) GMPD_TAG_LABEL);
+G_STATIC_ASSERT((gint) GMPD_KEY_MUSICBRAINZ_ARTIST_ID == (gint) GMPD_TAG_MUSICBRAINZ_ARTIST_ID);
+G_STATIC_ASSERT((gint) GMPD_KEY_MUSICBRAINZ_ALBUM_ID == (gint) GMPD_TAG_MUSICBRAINZ_ALBUM_ID);
+G_STATIC_ASSERT((gint) GMPD_KEY_MUSICBRAINZ_ALBUM_ARTIST_ID == (gint) GMPD_TAG_MUSICBRAINZ_ALBUM_ARTIST_ID);
+G_STATIC_ASSERT((gint) GMPD_KEY_MUSICBRAINZ_TRACK_ID == (gint) GMPD_TAG_MUSICBRAINZ_TRACK_ID);
+G_STATIC_ASSERT((gint) GMPD_KEY_MUSICBRAINZ_RELEASE_TRACK_ID == (gint) GMPD_TAG_MUSICBRAINZ_RELEASE_TRACK_ID);
+G_STATIC_ASSERT((gint) GMPD_KEY_MUSICBRAINZ_WORK_ID == (gint) GMPD_TAG_MUSICBRAINZ_WORK_ID);
+
+static const gchar *const KEY_NAMES[GMPD_N_KEYS] = {
+	[GMPD_KEY_ARTIST] = "Artist",
+	[GMPD_KEY_ARTIST_SORT] = "ArtistSort",
+	[GMPD_KEY_ALBUM] = "Album",
+	[GMPD_KEY_ALBUM_SORT] = "AlbumSort",
+	[GMPD_KEY_ALBUM_ARTIST] = "AlbumArtist",
+	[GMPD_KEY_ALBUM_ARTIST_SORT] = "AlbumArtistSort",
+	[GMPD_KEY_TITLE] = "Title",
+	[GMPD_KEY_TRACK] = "Track",
+	[GMPD_KEY_NAME] = "Name",
+	[GMPD_KEY_GENRE] = "Genre",
+	[GMPD_KEY_DATE] = "Date",
+	[GMPD_KEY_ORIGINAL_DATE] = "OriginalDate",
+	[GMPD_KEY_COMPOSER] = "Composer",
+	[GMPD_KEY_PERFORMER] = "Performer",
+	[GMPD_KEY_CONDUCTOR] = "Conductor",
+	[GMPD_KEY_WORK] = "Work",
+	[GMPD_KEY_GROUPING] = "Grouping",
+	[GMPD_KEY_COMMENT] = "Comment",
+	[GMPD_KEY_DISC] = "Disc",
+	[GMPD_KEY_LABEL] = "Label",
+	[GMPD_KEY_MUSICBRAINZ_ARTIST_ID] = "MUSICBRAINZ_ARTISTID",
+	[GMPD_KEY_MUSICBRAINZ_ALBUM_ID] = "MUSICBRAINZ_ALBUMID",
+	[GMPD_KEY_MUSICBRAINZ_ALBUM_ARTIST_ID] = "MUSICBRAINZ_ALBUMARTISTID",
+	[GMPD_KEY_MUSICBRAINZ_TRACK_ID] = "MUSICBRAINZ_TRACKID",
+	[GMPD_KEY_MUSICBRAINZ_RELEASE_TRACK_ID] = "MUSICBRAINZ_RELEASETRACKID",
+	[GMPD_KEY_MUSICBRAINZ_WORK_ID] = "MUSICBRAINZ_WORKID",
+	[GMPD_KEY_FILE] = "file",
+	[GMPD_KEY_LAST_MODIFIED] = "Last-Modified",
+	[GMPD_KEY_POS] = "Pos",
+	[GMPD_KEY_ID] = "Id",
+	[GMPD_KEY_PRIO] = "Prio",
+	[GMPD_KEY_SONG_TIME] = "Time",
+	[GMPD_KEY_DURATION] = "duration",
+	[GMPD_KEY_RANGE] = "Range",
+	[GMPD_KEY_FORMAT] = "Format",
+	[GMPD_KEY_PARTITION] = "partition",
+	[GMPD_KEY_VOLUME] = "volume",
+	[GMPD_KEY_REPEAT] = "repeat",
+	[GMPD_KEY_RANDOM] = "random",
+	[GMPD_KEY_SINGLE] = "single",
+	[GMPD_KEY_CONSUME] = "consume",
+	[GMPD_KEY_PLAYLIST] = "playlist",
+	[GMPD_KEY_PLAYLIST_LENGTH] = "playlistlength",
+	[GMPD_KEY_STATE] = "state",
+	[GMPD_KEY_SONG] = "song",
+	[GMPD_KEY_SONG_ID] = "songid",
+	[GMPD_KEY_NEXT_SONG] = "nextsong",
+	[GMPD_KEY_NEXT_SONG_ID] = "nextsongid",
+	[GMPD_KEY_TIME] = "time",
+	[GMPD_KEY_ELAPSED] = "elapsed",
+	[GMPD_KEY_BITRATE] = "bitrate",
+	[GMPD_KEY_XFADE] = "xfade",
+	[GMPD_KEY_MIXRAMP_DB] = "mixrampdb",
+	[GMPD_KEY_MIXRAMP_DELAY] = "mixrampdelay",
+	[GMPD_KEY_AUDIO] = "audio",
+	[GMPD_KEY_UPDATING_DB] = "updating_db",
+	[GMPD_KEY_ERROR] = "error",
+	[GMPD_KEY_ARTISTS] = "artists",
+	[GMPD_KEY_ALBUMS] = "albums",
+	[GMPD_KEY_SONGS] = "songs",
+	[GMPD_KEY_UPTIME] = "uptime",
+	[GMPD_KEY_DB_PLAYTIME] = "db_playtime",
+	[GMPD_KEY_DB_UPDATE] = "db_update",
+	[GMPD_KEY_PLAYTIME] = "playtime",
+	[GMPD_KEY_DIRECTORY] = "directory",
+	[GMPD_KEY_REPLAY_GAIN_MODE] = "replay_gain_mode",
+	[GMPD_KEY_CHANGED] = "changed",
+};
+
+static const guint16 SEEDS[64] = {
+	1, 1, 0, 1, 1, 0, 1, 1, 1, 1, 1, 1,
+	1, 1, 0, 1, 0, 2, 1, 1, 1, 2, 1, 1,
+	1, 1, 0, 1, 1, 1, 0, 1, 1, 0, 2, 1,
+	1, 1, 0, 2, 0, 1, 1, 1, 1, 0, 1, 0,
+	1, 3, 1, 1, 0, 1, 1, 0, 2, 2, 1, 0,
+	0, 0, 1, 1,
+};
+
+static const gint16 SLOTS[256] = {
+	-1, -1, 30, 10, -1, -1, -1, -1, -1, 33, 40, -1, -1, -1, 3, -1,
+	-1, -1, 6, -1, -1, -1, -1, 0, -1, 14, -1, -1, -1, -1, -1, 8,
+	39, -1, -1, -1, -1, -1, -1, 13, 38, -1, -1, -1, -1, -1, 12, -1,
+	21, 17, -1, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, 19, 9, 49, 48, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	23, -1, 35, -1, -1, -1, 36, 34, -1, -1, 62, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, 31, 25, -1, -1, 29, -1, -1, -1, -1, -1, -1,
+	-1, 15, 46, 22, -1, -1, -1, 11, -1, -1, -1, -1, 4, -1, -1, -1,
+	-1, -1, 59, -1, -1, -1, -1, -1, 61, -1, -1, -1, -1, -1, -1, -1,
+	-1, 18, 26, -1, -1, 50, -1, 56, -1, 43, -1, -1, 52, -1, -1, 1,
+	58, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 65, -1, -1, -1, 64,
+	-1, -1, -1, -1, -1, 55, -1, -1, -1, -1, 41, -1, -1, -1, 42, -1,
+	60, 16, -1, -1, -1, 44, -1, -1, -1, -1, -1, -1, 57, -1, -1, -1,
+	66, -1, -1, -1, -1, -1, -1, -1, -1, -1, 20, 37, -1, 5, 54, -1,
+	45, 47, -1, 24, -1, -1, -1, 63, 27, -1, -1, -1, 32, -1, 28, -1,
+	-1, -1, 51, -1, -1, -1, -1, -1, -1, 53, -1, 7, -1, -1, -1, -1,
+};
+
+static inline guint32
+gmpd_key_hash(guint32      seed,
+              const gchar *s)
+{
+	guint32 h = seed ^ 2166136261u;
+
+	for (; *s; s++) {
+		h ^= (guchar) *s;
+		h *= 16777619u;
+	}
+
+	return h;
+}
+
+/* The perfect hash picks the only slot the key can be in, so at most
+ * one string comparison is needed.
+ */
+GMpdKey
+gmpd_key_from_string(const gchar *s)
+{
+	guint32 seed;
+	gint key;
+
+	g_return_val_if_fail(s != NULL, GMPD_KEY_UNKNOWN);
+
+	seed = SEEDS[gmpd_key_hash(0, s) % G_N_ELEMENTS(SEEDS)];
+	key = SLOTS[gmpd_key_hash(seed, s) % G_N_ELEMENTS(SLOTS)];
+
+	if (key < 0 || strcmp(KEY_NAMES[key], s) != 0)
+		return GMPD_KEY_UNKNOWN;
+
+	return (GMpdKey) key;
+}
@@ -0,0 +1,114 @@
+/* libgmpd: MPD protocol implementation for GLib
+ * Copyright (C) 2020 Patrick Keating <binarydrifter@protonmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* This file is generated by gmpd-key-gen.py, do not edit. */
+
+#ifndef __GMPD_KEY_H__
+#define __GMPD_KEY_H__
+
+#if !defined(__GMPD_BUILD__)
+#   error "This file is private to libgmpd and should not be included."
+#endif
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+#define GMPD_KEY_IS_TAG(key) \
+	((key) > GMPD_KEY_UNKNOWN && (key) < GMPD_N_TAG_KEYS)
+
+typedef enum _GMpdKey {
+	GMPD_KEY_UNKNOWN = -1,
+	GMPD_KEY_ARTIST,                       /* Artist */
+	GMPD_KEY_ARTIST_SORT,                  /* ArtistSort */
+	GMPD_KEY_ALBUM,                        /* Album */
+	GMPD_KEY_ALBUM_SORT,                   /* AlbumSort */
+	GMPD_KEY_ALBUM_ARTIST,                 /* AlbumArtist */
+	GMPD_KEY_ALBUM_ARTIST_SORT,            /* AlbumArtistSort */
+	GMPD_KEY_TITLE,                        /* Title */
+	GMPD_KEY_TRACK,                        /* Track */
+	GMPD_KEY_NAME,                         /* Name */
+	GMPD_KEY_GENRE,                        /* Genre */
+	GMPD_KEY_DATE,                         /* Date */
+	GMPD_KEY_ORIGINAL_DATE,                /* OriginalDate */
+	GMPD_KEY_COMPOSER,                     /* Composer */
+	GMPD_KEY_PERFORMER,                    /* Performer */
+	GMPD_KEY_CONDUCTOR,                    /* Conductor */
+	GMPD_KEY_WORK,                         /* Work */
+	GMPD_KEY_GROUPING,                     /* Grouping */
+	GMPD_KEY_COMMENT,                      /* Comment */
+	GMPD_KEY_DISC,                         /* Disc */
+	GMPD_KEY_LABEL,                        /* Label */
+	GMPD_KEY_MUSICBRAINZ_ARTIST_ID,        /* MUSICBRAINZ_ARTISTID */
+	GMPD_KEY_MUSICBRAINZ_ALBUM_ID,         /* MUSICBRAINZ_ALBUMID */
+	GMPD_KEY_MUSICBRAINZ_ALBUM_ARTIST_ID,  /* MUSICBRAINZ_ALBUMARTISTID */
+	GMPD_KEY_MUSICBRAINZ_TRACK_ID,         /* MUSICBRAINZ_TRACKID */
+	GMPD_KEY_MUSICBRAINZ_RELEASE_TRACK_ID, /* MUSICBRAINZ_RELEASETRACKID */
+	GMPD_KEY_MUSICBRAINZ_WORK_ID,          /* MUSICBRAINZ_WORKID */
+
+	GMPD_KEY_FILE,                         /* file */
+	GMPD_KEY_LAST_MODIFIED,                /* Last-Modified */
+	GMPD_KEY_POS,                          /* Pos */
+	GMPD_KEY_ID,                           /* Id */
+	GMPD_KEY_PRIO,                         /* Prio */
+	GMPD_KEY_SONG_TIME,                    /* Time */
+	GMPD_KEY_DURATION,                     /* duration */
+	GMPD_KEY_RANGE,                        /* Range */
+	GMPD_KEY_FORMAT,                       /* Format */
+	GMPD_KEY_PARTITION,                    /* partition */
+	GMPD_KEY_VOLUME,                       /* volume */
+	GMPD_KEY_REPEAT,                       /* repeat */
+	GMPD_KEY_RANDOM,                       /* random */
+	GMPD_KEY_SINGLE,                       /* single */
+	GMPD_KEY_CONSUME,                      /* consume */
+	GMPD_KEY_PLAYLIST,                     /* playlist */
+	GMPD_KEY_PLAYLIST_LENGTH,              /* playlistlength */
+	GMPD_KEY_STATE,                        /* state */
+	GMPD_KEY_SONG,                         /* song */
+	GMPD_KEY_SONG_ID,                      /* songid */
+	GMPD_KEY_NEXT_SONG,                    /* nextsong */
+	GMPD_KEY_NEXT_SONG_ID,                 /* nextsongid */
+	GMPD_KEY_TIME,                         /* time */
+	GMPD_KEY_ELAPSED,                      /* elapsed */
+	GMPD_KEY_BITRATE,                      /* bitrate */
+	GMPD_KEY_XFADE,                        /* xfade */
+	GMPD_KEY_MIXRAMP_DB,                   /* mixrampdb */
+	GMPD_KEY_MIXRAMP_DELAY,                /* mixrampdelay */
+	GMPD_KEY_AUDIO,                        /* audio */
+	GMPD_KEY_UPDATING_DB,                  /* updating_db */
+	GMPD_KEY_ERROR,                        /* error */
+	GMPD_KEY_ARTISTS,                      /* artists */
+	GMPD_KEY_ALBUMS,                       /* albums */
+	GMPD_KEY_SONGS,                        /* songs */
+	GMPD_KEY_UPTIME,                       /* uptime */
+	GMPD_KEY_DB_PLAYTIME,                  /* db_playtime */
+	GMPD_KEY_DB_UPDATE,                    /* db_update */
+	GMPD_KEY_PLAYTIME,                     /* playtime */
+	GMPD_KEY_DIRECTORY,                    /* directory */
+	GMPD_KEY_REPLAY_GAIN_MODE,             /* replay_gain_mode */
+	GMPD_KEY_CHANGED,                      /* changed */
+	GMPD_N_KEYS,
+
+	GMPD_N_TAG_KEYS = GMPD_KEY_MUSICBRAINZ_WORK_ID + 1,
+} GMpdKey;
+
+GMpdKey  gmpd_key_from_string  (const gchar *s);
+
+G_END_DECLS
+
+#endif /* __GMPD_KEY_H__ */
@@ -0,0 +1,563 @@
+/* libgmpd: MPD protocol implementation for GLib
+ * Copyright (C) 2020 Patrick Keating <binarydrifter@protonmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <gio/gio.h>
+#include "gmpd-batch.h"
+#include "gmpd-client.h"
+#include "gmpd-idle.h"
+#include "gmpd-live-state.h"
+#include "gmpd-object.h"
+#include "gmpd-song.h"
+#include "gmpd-stats.h"
+#include "gmpd-status.h"
+#include "gmpd-tag.h"
+
+/* the subsystems whose changes each query picks up */
+#define STATUS_SUBSYSTEMS \
+	(GMPD_IDLE_PLAYER | GMPD_IDLE_MIXER | GMPD_IDLE_OPTIONS | \
+	 GMPD_IDLE_QUEUE | GMPD_IDLE_UPDATE | GMPD_IDLE_PARTITION)
+
+#define CURRENT_SONG_SUBSYSTEMS \
+	(GMPD_IDLE_PLAYER | GMPD_IDLE_QUEUE | GMPD_IDLE_PARTITION)
+
+#define STATS_SUBSYSTEMS \
+	(GMPD_IDLE_DATABASE)
+
+static void gmpd_live_state_set_client(GMpdLiveState *self,
+                                       GMpdClient    *client);
+
+static void on_client_idle(GMpdClient    *client,
+                           GMpdIdle       subsystem,
+                           GMpdLiveState *self);
+
+static void on_connection_state(GMpdClient    *client,
+                                GParamSpec    *pspec,
+                                GMpdLiveState *self);
+
+static void on_refresh_ready(GObject      *source_object,
+                             GAsyncResult *result,
+                             gpointer      user_data);
+
+static void on_auto_refresh_ready(GObject      *source_object,
+                                  GAsyncResult *result,
+                                  gpointer      user_data);
+
+enum {
+	PROP_NONE,
+	PROP_CLIENT,
+	PROP_STATUS,
+	PROP_CURRENT_SONG,
+	PROP_STATS,
+	N_PROPERTIES,
+};
+
+/* status, current_song and stats are created once and updated in place,
+ * so they can be held on to and watched with notify. Idle events of one
+ * burst are collected until the main loop is idle and answered with a
+ * single command list, and events arriving while it is on the way wait
+ * for the next one. Events missed while the connection was down are
+ * made up for by refreshing everything once it is back.
+ */
+struct _GMpdLiveState {
+	GObject     __base__;
+	GMpdClient *client;
+	gulong      idle_handler;
+	gulong      state_handler;
+
+	GMpdStatus *status;
+	GMpdSong   *current_song;
+	GMpdStats  *stats;
+
+	GMpdIdle    pending;
+	GSource    *flush_source;
+	gboolean    refreshing;
+};
+
+struct _GMpdLiveStateClass {
+	GObjectClass __base__;
+};
+
+G_DEFINE_TYPE(GMpdLiveState, gmpd_live_state, G_TYPE_OBJECT)
+
+static GParamSpec *PROPERTIES[N_PROPERTIES] = {NULL};
+
+static void
+gmpd_live_state_set_property(GObject      *object,
+                             guint         prop_id,
+                             const GValue *value,
+                             GParamSpec   *pspec)
+{
+	GMpdLiveState *self = GMPD_LIVE_STATE(object);
+
+	switch (prop_id) {
+	case PROP_CLIENT:
+		gmpd_live_state_set_client(self, g_value_get_object(value));
+		break;
+
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+	}
+}
+
+static void
+gmpd_live_state_get_property(GObject    *object,
+                             guint       prop_id,
+                             GValue     *value,
+                             GParamSpec *pspec)
+{
+	GMpdLiveState *self = GMPD_LIVE_STATE(object);
+
+	switch (prop_id) {
+	case PROP_CLIENT:
+		g_value_take_object(value, gmpd_live_state_get_client(self));
+		break;
+
+	case PROP_STATUS:
+		g_value_take_object(value, gmpd_live_state_get_status(self));
+		break;
+
+	case PROP_CURRENT_SONG:
+		g_value_take_object(value, gmpd_live_state_get_current_song(self));
+		break;
+
+	case PROP_STATS:
+		g_value_take_object(value, gmpd_live_state_get_stats(self));
+		break;
+
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+	}
+}
+
+static void
+gmpd_live_state_dispose(GObject *object)
+{
+	GMpdLiveState *self = GMPD_LIVE_STATE(object);
+
+	if (self->idle_handler) {
+		g_signal_handler_disconnect(self->client, self->idle_handler);
+		g_signal_handler_disconnect(self->client, self->state_handler);
+		gmpd_client_stop_idle_watch(self->client);
+
+		self->idle_handler = 0;
+		self->state_handler = 0;
+	}
+
+	if (self->flush_source) {
+		g_source_destroy(self->flush_source);
+		g_clear_pointer(&self->flush_source, g_source_unref);
+	}
+
+	g_clear_object(&self->client);
+
+	G_OBJECT_CLASS(gmpd_live_state_parent_class)->dispose(object);
+}
+
+static void
+gmpd_live_state_finalize(GObject *object)
+{
+	GMpdLiveState *self = GMPD_LIVE_STATE(object);
+
+	g_clear_object(&self->status);
+	g_clear_object(&self->current_song);
+	g_clear_object(&self->stats);
+
+	G_OBJECT_CLASS(gmpd_live_state_parent_class)->finalize(object);
+}
+
+static void
+gmpd_live_state_class_init(GMpdLiveStateClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(klass);
+
+	object_class->set_property = gmpd_live_state_set_property;
+	object_class->get_property = gmpd_live_state_get_property;
+	object_class->dispose = gmpd_live_state_dispose;
+	object_class->finalize = gmpd_live_state_finalize;
+
+	PROPERTIES[PROP_CLIENT] =
+		g_param_spec_object("client",
+		                    "Client",
+		                    "Client the state is read from",
+		                    GMPD_TYPE_CLIENT,
+		                    G_PARAM_READWRITE |
+		                    G_PARAM_CONSTRUCT_ONLY |
+		                    G_PARAM_STATIC_STRINGS);
+
+	PROPERTIES[PROP_STATUS] =
+		g_param_spec_object("status",
+		                    "Status",
+		                    "Last known status of the server",
+		                    GMPD_TYPE_STATUS,
+		                    G_PARAM_READABLE |
+		                    G_PARAM_STATIC_STRINGS);
+
+	PROPERTIES[PROP_CURRENT_SONG] =
+		g_param_spec_object("current-song",
+		                    "Current Song",
+		                    "Last known current song of the server",
+		                    GMPD_TYPE_SONG,
+		                    G_PARAM_READABLE |
+		                    G_PARAM_STATIC_STRINGS);
+
+	PROPERTIES[PROP_STATS] =
+		g_param_spec_object("stats",
+		                    "Stats",
+		                    "Last known statistics of the server",
+		                    GMPD_TYPE_STATS,
+		                    G_PARAM_READABLE |
+		                    G_PARAM_STATIC_STRINGS);
+
+	g_object_class_install_properties(object_class, N_PROPERTIES, PROPERTIES);
+}
+
+static void
+gmpd_live_state_init(GMpdLiveState *self)
+{
+	self->client = NULL;
+	self->idle_handler = 0;
+	self->state_handler = 0;
+
+	self->status = gmpd_status_new();
+	self->current_song = gmpd_song_new();
+	self->stats = gmpd_stats_new();
+
+	self->pending = GMPD_IDLE_NONE;
+	self->flush_source = NULL;
+	self->refreshing = FALSE;
+}
+
+/* Starts the idle watch of client, the state follows it until it is
+ * disposed. Call gmpd_live_state_refresh_async() with GMPD_IDLE_ALL to
+ * fill it in the first time.
+ */
+GMpdLiveState *
+gmpd_live_state_new(GMpdClient *client)
+{
+	g_return_val_if_fail(GMPD_IS_CLIENT(client), NULL);
+	return g_object_new(GMPD_TYPE_LIVE_STATE, "client", client, NULL);
+}
+
+static GMpdBatch *
+gmpd_live_state_new_batch(GMpdIdle subsystems)
+{
+	GMpdBatch *batch = gmpd_batch_new();
+
+	if (subsystems & STATUS_SUBSYSTEMS)
+		gmpd_batch_add_status(batch);
+
+	if (subsystems & CURRENT_SONG_SUBSYSTEMS)
+		gmpd_batch_add_currentsong(batch);
+
+	if (subsystems & STATS_SUBSYSTEMS)
+		gmpd_batch_add_stats(batch);
+
+	if (!gmpd_batch_get_length(batch))
+		g_clear_object(&batch);
+
+	return batch;
+}
+
+void
+gmpd_live_state_refresh_async(GMpdLiveState       *self,
+                              GMpdIdle             subsystems,
+                              GCancellable        *cancellable,
+                              GAsyncReadyCallback  callback,
+                              gpointer             user_data)
+{
+	GMpdBatch *batch;
+	GTask *task;
+
+	g_return_if_fail(GMPD_IS_LIVE_STATE(self));
+	g_return_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable));
+
+	task = g_task_new(self, cancellable, callback, user_data);
+	g_task_set_source_tag(task, gmpd_live_state_refresh_async);
+
+	batch = gmpd_live_state_new_batch(subsystems);
+	if (!batch) {
+		g_task_return_boolean(task, TRUE);
+		g_object_unref(task);
+		return;
+	}
+
+	gmpd_client_batch_async(self->client, batch, cancellable, on_refresh_ready, task);
+
+	g_object_unref(batch);
+}
+
+gboolean
+gmpd_live_state_refresh_finish(GMpdLiveState  *self,
+                               GAsyncResult   *result,
+                               GError        **error)
+{
+	g_return_val_if_fail(GMPD_IS_LIVE_STATE(self), FALSE);
+	g_return_val_if_fail(g_task_is_valid(result, self), FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	return g_task_propagate_boolean(G_TASK(result), error);
+}
+
+static void
+gmpd_live_state_set_client(GMpdLiveState *self,
+                           GMpdClient    *client)
+{
+	g_return_if_fail(GMPD_IS_LIVE_STATE(self));
+	g_return_if_fail(GMPD_IS_CLIENT(client));
+	g_return_if_fail(self->client == NULL);
+
+	self->client = g_object_ref(client);
+	self->idle_handler = g_signal_connect(client, "idle", G_CALLBACK(on_client_idle), self);
+	self->state_handler = g_signal_connect(client, "notify::connection-state",
+	                                       G_CALLBACK(on_connection_state), self);
+
+	gmpd_client_start_idle_watch(client);
+}
+
+GMpdClient *
+gmpd_live_state_get_client(GMpdLiveState *self)
+{
+	g_return_val_if_fail(GMPD_IS_LIVE_STATE(self), NULL);
+	return self->client ? g_object_ref(self->client) : NULL;
+}
+
+GMpdStatus *
+gmpd_live_state_get_status(GMpdLiveState *self)
+{
+	g_return_val_if_fail(GMPD_IS_LIVE_STATE(self), NULL);
+	return g_object_ref(self->status);
+}
+
+GMpdSong *
+gmpd_live_state_get_current_song(GMpdLiveState *self)
+{
+	g_return_val_if_fail(GMPD_IS_LIVE_STATE(self), NULL);
+	return g_object_ref(self->current_song);
+}
+
+GMpdStats *
+gmpd_live_state_get_stats(GMpdLiveState *self)
+{
+	g_return_val_if_fail(GMPD_IS_LIVE_STATE(self), NULL);
+	return g_object_ref(self->stats);
+}
+
+/* Copies every writable property of src that differs over to dst, so
+ * only the properties that really changed are notified.
+ */
+static void
+merge_properties(gpointer dst,
+                 gpointer src)
+{
+	GParamSpec **pspecs;
+	guint n_pspecs;
+	guint i;
+
+	pspecs = g_object_class_list_properties(G_OBJECT_GET_CLASS(dst), &n_pspecs);
+
+	g_object_freeze_notify(G_OBJECT(dst));
+
+	for (i = 0; i < n_pspecs; i++) {
+		GParamSpec *pspec = pspecs[i];
+		GValue old_value = G_VALUE_INIT;
+		GValue new_value = G_VALUE_INIT;
+
+		if ((pspec->flags & G_PARAM_READWRITE) != G_PARAM_READWRITE ||
+		    (pspec->flags & G_PARAM_CONSTRUCT_ONLY))
+			continue;
+
+		g_value_init(&old_value, pspec->value_type);
+		g_value_init(&new_value, pspec->value_type);
+
+		g_object_get_property(G_OBJECT(dst), pspec->name, &old_value);
+		g_object_get_property(G_OBJECT(src), pspec->name, &new_value);
+
+		if (g_param_values_cmp(pspec, &old_value, &new_value) != 0)
+			g_object_set_property(G_OBJECT(dst), pspec->name, &new_value);
+
+		g_value_unset(&old_value);
+		g_value_unset(&new_value);
+	}
+
+	g_object_thaw_notify(G_OBJECT(dst));
+
+	g_free(pspecs);
+}
+
+static gboolean
+song_tag_equal(GMpdSong *a,
+               GMpdSong *b,
+               GMpdTag   tag)
+{
+	const gchar *value;
+	guint i;
+
+	for (i = 0; (value = gmpd_song_peek_tag(a, tag, i)); i++) {
+		if (g_strcmp0(value, gmpd_song_peek_tag(b, tag, i)) != 0)
+			return FALSE;
+	}
+
+	return gmpd_song_peek_tag(b, tag, i) == NULL;
+}
+
+static void
+merge_song(GMpdSong *dst,
+           GMpdSong *src)
+{
+	GMpdTag tag;
+
+	merge_properties(dst, src);
+
+	for (tag = 0; tag < GMPD_N_TAGS; tag++) {
+		gchar **values;
+
+		if (song_tag_equal(dst, src, tag))
+			continue;
+
+		values = gmpd_song_get_tag(src, tag);
+		gmpd_song_set_tag(dst, tag, (const gchar *const *) values);
+		g_strfreev(values);
+	}
+}
+
+static void
+gmpd_live_state_merge(GMpdLiveState *self,
+                      GMpdBatch     *batch)
+{
+	guint i;
+
+	for (i = 0; i < gmpd_batch_get_length(batch); i++) {
+		gpointer response = gmpd_batch_get_response(batch, i);
+
+		if (GMPD_IS_STATUS(response))
+			gmpd_status_update(self->status, response);
+		else if (GMPD_IS_SONG(response))
+			merge_song(self->current_song, response);
+		else if (GMPD_IS_STATS(response))
+			merge_properties(self->stats, response);
+
+		g_clear_object(&response);
+	}
+}
+
+static void
+on_refresh_ready(GObject      *source_object,
+                 GAsyncResult *result,
+                 gpointer      user_data)
+{
+	GTask *task = user_data;
+	GMpdLiveState *self = g_task_get_source_object(task);
+	GMpdBatch *batch;
+	GError *error = NULL;
+
+	batch = gmpd_client_finish_batch_response(GMPD_CLIENT(source_object), result, &error);
+
+	if (batch) {
+		gmpd_live_state_merge(self, batch);
+		g_task_return_boolean(task, TRUE);
+		g_object_unref(batch);
+	} else {
+		g_task_return_error(task, error);
+	}
+
+	g_object_unref(task);
+}
+
+static void
+gmpd_live_state_flush(GMpdLiveState *self)
+{
+	GMpdIdle pending = self->pending;
+
+	self->pending = GMPD_IDLE_NONE;
+	self->refreshing = TRUE;
+
+	gmpd_live_state_refresh_async(self, pending, NULL, on_auto_refresh_ready, NULL);
+}
+
+static gboolean
+gmpd_live_state_on_flush(gpointer data)
+{
+	GMpdLiveState *self = data;
+
+	g_clear_pointer(&self->flush_source, g_source_unref);
+
+	if (!self->refreshing)
+		gmpd_live_state_flush(self);
+
+	return G_SOURCE_REMOVE;
+}
+
+static void
+on_auto_refresh_ready(GObject      *source_object,
+                      GAsyncResult *result,
+                      gpointer      user_data G_GNUC_UNUSED)
+{
+	GMpdLiveState *self = GMPD_LIVE_STATE(source_object);
+	GError *error = NULL;
+
+	if (!gmpd_live_state_refresh_finish(self, result, &error)) {
+		if (!g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CLOSED))
+			g_warning("unable to refresh state: %s", error->message);
+
+		g_error_free(error);
+	}
+
+	self->refreshing = FALSE;
+
+	if (self->pending != GMPD_IDLE_NONE && !self->flush_source)
+		gmpd_live_state_flush(self);
+}
+
+static void
+gmpd_live_state_schedule(GMpdLiveState *self,
+                         GMpdIdle       subsystems)
+{
+	GMainContext *context;
+
+	self->pending |= subsystems;
+
+	if (self->flush_source)
+		return;
+
+	context = gmpd_object_get_context(GMPD_OBJECT(self->client));
+
+	self->flush_source = g_idle_source_new();
+	g_source_set_callback(self->flush_source, gmpd_live_state_on_flush, self, NULL);
+	g_source_attach(self->flush_source, context);
+
+	if (context)
+		g_main_context_unref(context);
+}
+
+static void
+on_client_idle(GMpdClient    *client G_GNUC_UNUSED,
+               GMpdIdle       subsystem,
+               GMpdLiveState *self)
+{
+	gmpd_live_state_schedule(self, subsystem);
+}
+
+static void
+on_connection_state(GMpdClient    *client,
+                    GParamSpec    *pspec G_GNUC_UNUSED,
+                    GMpdLiveState *self)
+{
+	if (gmpd_client_get_connection_state(client) == GMPD_CONNECTION_CONNECTED)
+		gmpd_live_state_schedule(self, GMPD_IDLE_ALL);
+}
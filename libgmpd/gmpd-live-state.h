@@ -0,0 +1,78 @@
+/* libgmpd: MPD protocol implementation for GLib
+ * Copyright (C) 2020 Patrick Keating <binarydrifter@protonmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef __GMPD_LIVE_STATE_H__
+#define __GMPD_LIVE_STATE_H__
+
+#if !defined(__GMPD_H_INSIDE__) && !defined(__GMPD_BUILD__)
+#   error "Only <gmpd.h> can be included directly."
+#endif
+
+#include <gio/gio.h>
+#include <gmpd-client.h>
+#include <gmpd-idle.h>
+#include <gmpd-song.h>
+#include <gmpd-stats.h>
+#include <gmpd-status.h>
+
+G_BEGIN_DECLS
+
+#define GMPD_TYPE_LIVE_STATE \
+	(gmpd_live_state_get_type())
+
+#define GMPD_LIVE_STATE(inst) \
+	(G_TYPE_CHECK_INSTANCE_CAST((inst), GMPD_TYPE_LIVE_STATE, GMpdLiveState))
+
+#define GMPD_LIVE_STATE_CLASS(klass) \
+	(G_TYPE_CHECK_CLASS_CAST((klass), GMPD_TYPE_LIVE_STATE, GMpdLiveStateClass))
+
+#define GMPD_IS_LIVE_STATE(inst) \
+	(G_TYPE_CHECK_INSTANCE_TYPE((inst), GMPD_TYPE_LIVE_STATE))
+
+#define GMPD_IS_LIVE_STATE_CLASS(klass) \
+	(G_TYPE_CHECK_CLASS_TYPE((klass), GMPD_TYPE_LIVE_STATE))
+
+#define GMPD_LIVE_STATE_GET_CLASS(inst) \
+	(G_TYPE_INSTANCE_GET_CLASS((inst), GMPD_TYPE_LIVE_STATE, GMpdLiveStateClass))
+
+typedef struct _GMpdLiveState      GMpdLiveState;
+typedef struct _GMpdLiveStateClass GMpdLiveStateClass;
+
+GType            gmpd_live_state_get_type          (void);
+
+GMpdLiveState *  gmpd_live_state_new               (GMpdClient          *client);
+
+void             gmpd_live_state_refresh_async     (GMpdLiveState       *self,
+                                                    GMpdIdle             subsystems,
+                                                    GCancellable        *cancellable,
+                                                    GAsyncReadyCallback  callback,
+                                                    gpointer             user_data);
+
+gboolean         gmpd_live_state_refresh_finish    (GMpdLiveState       *self,
+                                                    GAsyncResult        *result,
+                                                    GError             **error);
+
+GMpdClient *     gmpd_live_state_get_client        (GMpdLiveState       *self);
+GMpdStatus *     gmpd_live_state_get_status        (GMpdLiveState       *self);
+GMpdSong *       gmpd_live_state_get_current_song  (GMpdLiveState       *self);
+GMpdStats *      gmpd_live_state_get_stats         (GMpdLiveState       *self);
+
+G_END_DECLS
+
+#endif /* __GMPD_LIVE_STATE_H__ */
@@ -0,0 +1,50 @@
+/* libgmpd: MPD protocol implementation for GLib
+ * Copyright (C) 2020 Patrick Keating <binarydrifter@protonmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef __GMPD_METRICS_PRIV_H__
+#define __GMPD_METRICS_PRIV_H__
+
+#if !defined(__GMPD_BUILD__)
+#   error "This file is private to libgmpd and should not be included."
+#endif
+
+#include <gio/gio.h>
+#include <gmpd-metrics.h>
+
+G_BEGIN_DECLS
+
+GMpdMetrics *  gmpd_metrics_new                (void);
+GMpdMetrics *  gmpd_metrics_copy               (GMpdMetrics *self);
+
+void           gmpd_metrics_add_command        (GMpdMetrics *self,
+                                                const gchar *command,
+                                                gint64       queue_wait,
+                                                gint64       round_trip,
+                                                gint64       parse_time,
+                                                gsize        bytes_out,
+                                                gsize        bytes_in);
+
+void           gmpd_metrics_add_reconnect      (GMpdMetrics *self);
+
+void           gmpd_metrics_set_pipeline_depth (GMpdMetrics *self,
+                                                guint        pipeline_depth,
+                                                guint        n_waiting);
+
+G_END_DECLS
+
+#endif /* __GMPD_METRICS_PRIV_H__ */
@@ -0,0 +1,364 @@
+/* libgmpd: MPD protocol implementation for GLib
+ * Copyright (C) 2020 Patrick Keating <binarydrifter@protonmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <string.h>
+#include <gio/gio.h>
+#include "gmpd-metrics.h"
+#include "gmpd-metrics-priv.h"
+
+#define N_METRICS (GMPD_METRIC_PARSE_TIME + 1)
+
+typedef struct _GMpdCommandMetrics {
+	guint64 count;
+	guint64 bytes_in;
+	guint64 bytes_out;
+	guint64 total_time[N_METRICS];
+	guint64 histograms[N_METRICS][GMPD_METRICS_N_BUCKETS];
+} GMpdCommandMetrics;
+
+struct _GMpdMetrics {
+	GObject     __base__;
+	GHashTable *commands;
+	guint       pipeline_depth;
+	guint       n_waiting;
+	guint       n_reconnects;
+};
+
+struct _GMpdMetricsClass {
+	GObjectClass __base__;
+};
+
+G_DEFINE_TYPE(GMpdMetrics, gmpd_metrics, G_TYPE_OBJECT)
+
+static const GEnumValue METRIC_VALUES[] = {
+	{GMPD_METRIC_QUEUE_WAIT, "GMPD_METRIC_QUEUE_WAIT", "queue-wait"},
+	{GMPD_METRIC_ROUND_TRIP, "GMPD_METRIC_ROUND_TRIP", "round-trip"},
+	{GMPD_METRIC_PARSE_TIME, "GMPD_METRIC_PARSE_TIME", "parse-time"},
+	{0, NULL, NULL}
+};
+
+GType
+gmpd_metric_get_type(void)
+{
+	static gsize init = 0;
+	static GType type = 0;
+
+	if (g_once_init_enter(&init)) {
+		type = g_enum_register_static("GMpdMetric", METRIC_VALUES);
+		g_once_init_leave(&init, 1);
+	}
+
+	return type;
+}
+
+static void
+gmpd_command_metrics_free(GMpdCommandMetrics *self)
+{
+	g_slice_free(GMpdCommandMetrics, self);
+}
+
+/* Bucket 0 counts zero durations, bucket i counts [2^(i-1), 2^i)
+ * microseconds and the last bucket everything above.
+ */
+static guint
+gmpd_metrics_bucket(gint64 usec)
+{
+	if (usec <= 0)
+		return 0;
+
+	return MIN(g_bit_storage((guint64) usec), GMPD_METRICS_N_BUCKETS - 1);
+}
+
+static void
+gmpd_command_metrics_add(GMpdCommandMetrics *self,
+                         GMpdMetric          metric,
+                         gint64              usec)
+{
+	self->total_time[metric] += MAX(usec, 0);
+	self->histograms[metric][gmpd_metrics_bucket(usec)]++;
+}
+
+static void
+gmpd_metrics_finalize(GObject *object)
+{
+	GMpdMetrics *self = GMPD_METRICS(object);
+
+	g_clear_pointer(&self->commands, g_hash_table_unref);
+
+	G_OBJECT_CLASS(gmpd_metrics_parent_class)->finalize(object);
+}
+
+static void
+gmpd_metrics_class_init(GMpdMetricsClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(klass);
+
+	object_class->finalize = gmpd_metrics_finalize;
+}
+
+static void
+gmpd_metrics_init(GMpdMetrics *self)
+{
+	self->commands = g_hash_table_new_full(g_str_hash,
+	                                       g_str_equal,
+	                                       g_free,
+	                                       (GDestroyNotify)gmpd_command_metrics_free);
+	self->pipeline_depth = 0;
+	self->n_waiting = 0;
+	self->n_reconnects = 0;
+}
+
+GMpdMetrics *
+gmpd_metrics_new(void)
+{
+	return g_object_new(GMPD_TYPE_METRICS, NULL);
+}
+
+GMpdMetrics *
+gmpd_metrics_copy(GMpdMetrics *self)
+{
+	GMpdMetrics *copy;
+	GHashTableIter iter;
+	gpointer key;
+	gpointer value;
+
+	g_return_val_if_fail(GMPD_IS_METRICS(self), NULL);
+
+	copy = gmpd_metrics_new();
+	copy->pipeline_depth = self->pipeline_depth;
+	copy->n_waiting = self->n_waiting;
+	copy->n_reconnects = self->n_reconnects;
+
+	g_hash_table_iter_init(&iter, self->commands);
+	while (g_hash_table_iter_next(&iter, &key, &value)) {
+		g_hash_table_insert(copy->commands,
+		                    g_strdup(key),
+		                    g_slice_copy(sizeof(GMpdCommandMetrics), value));
+	}
+
+	return copy;
+}
+
+/* Commands are keyed by their first word, so e.g. every "status" is
+ * counted together regardless of arguments.
+ */
+void
+gmpd_metrics_add_command(GMpdMetrics *self,
+                         const gchar *command,
+                         gint64       queue_wait,
+                         gint64       round_trip,
+                         gint64       parse_time,
+                         gsize        bytes_out,
+                         gsize        bytes_in)
+{
+	GMpdCommandMetrics *metrics;
+	gchar *name;
+
+	g_return_if_fail(GMPD_IS_METRICS(self));
+	g_return_if_fail(command != NULL);
+
+	name = g_strndup(command, strcspn(command, " \n"));
+
+	metrics = g_hash_table_lookup(self->commands, name);
+	if (!metrics) {
+		metrics = g_slice_new0(GMpdCommandMetrics);
+		g_hash_table_insert(self->commands, name, metrics);
+	} else {
+		g_free(name);
+	}
+
+	metrics->count++;
+	metrics->bytes_out += bytes_out;
+	metrics->bytes_in += bytes_in;
+
+	gmpd_command_metrics_add(metrics, GMPD_METRIC_QUEUE_WAIT, queue_wait);
+	gmpd_command_metrics_add(metrics, GMPD_METRIC_ROUND_TRIP, round_trip);
+	gmpd_command_metrics_add(metrics, GMPD_METRIC_PARSE_TIME, parse_time);
+}
+
+void
+gmpd_metrics_add_reconnect(GMpdMetrics *self)
+{
+	g_return_if_fail(GMPD_IS_METRICS(self));
+	self->n_reconnects++;
+}
+
+void
+gmpd_metrics_set_pipeline_depth(GMpdMetrics *self,
+                                guint        pipeline_depth,
+                                guint        n_waiting)
+{
+	g_return_if_fail(GMPD_IS_METRICS(self));
+
+	self->pipeline_depth = pipeline_depth;
+	self->n_waiting = n_waiting;
+}
+
+gchar **
+gmpd_metrics_get_commands(GMpdMetrics *self)
+{
+	GHashTableIter iter;
+	gpointer key;
+	gchar **commands;
+	guint i = 0;
+
+	g_return_val_if_fail(GMPD_IS_METRICS(self), NULL);
+
+	commands = g_new(gchar *, g_hash_table_size(self->commands) + 1);
+
+	g_hash_table_iter_init(&iter, self->commands);
+	while (g_hash_table_iter_next(&iter, &key, NULL))
+		commands[i++] = g_strdup(key);
+
+	commands[i] = NULL;
+
+	return commands;
+}
+
+guint64
+gmpd_metrics_get_count(GMpdMetrics *self,
+                       const gchar *command)
+{
+	GMpdCommandMetrics *metrics;
+
+	g_return_val_if_fail(GMPD_IS_METRICS(self), 0);
+	g_return_val_if_fail(command != NULL, 0);
+
+	metrics = g_hash_table_lookup(self->commands, command);
+
+	return metrics ? metrics->count : 0;
+}
+
+guint64
+gmpd_metrics_get_bytes_in(GMpdMetrics *self,
+                          const gchar *command)
+{
+	GMpdCommandMetrics *metrics;
+
+	g_return_val_if_fail(GMPD_IS_METRICS(self), 0);
+	g_return_val_if_fail(command != NULL, 0);
+
+	metrics = g_hash_table_lookup(self->commands, command);
+
+	return metrics ? metrics->bytes_in : 0;
+}
+
+guint64
+gmpd_metrics_get_bytes_out(GMpdMetrics *self,
+                           const gchar *command)
+{
+	GMpdCommandMetrics *metrics;
+
+	g_return_val_if_fail(GMPD_IS_METRICS(self), 0);
+	g_return_val_if_fail(command != NULL, 0);
+
+	metrics = g_hash_table_lookup(self->commands, command);
+
+	return metrics ? metrics->bytes_out : 0;
+}
+
+guint64
+gmpd_metrics_get_total_time(GMpdMetrics *self,
+                            const gchar *command,
+                            GMpdMetric   metric)
+{
+	GMpdCommandMetrics *metrics;
+
+	g_return_val_if_fail(GMPD_IS_METRICS(self), 0);
+	g_return_val_if_fail(command != NULL, 0);
+	g_return_val_if_fail(GMPD_IS_METRIC(metric), 0);
+
+	metrics = g_hash_table_lookup(self->commands, command);
+
+	return metrics ? metrics->total_time[metric] : 0;
+}
+
+const guint64 *
+gmpd_metrics_get_histogram(GMpdMetrics *self,
+                           const gchar *command,
+                           GMpdMetric   metric)
+{
+	GMpdCommandMetrics *metrics;
+
+	g_return_val_if_fail(GMPD_IS_METRICS(self), NULL);
+	g_return_val_if_fail(command != NULL, NULL);
+	g_return_val_if_fail(GMPD_IS_METRIC(metric), NULL);
+
+	metrics = g_hash_table_lookup(self->commands, command);
+
+	return metrics ? metrics->histograms[metric] : NULL;
+}
+
+/* Returns the upper bound in microseconds of the bucket holding the
+ * given percentile (0 to 100), so the result is at most twice too high.
+ */
+guint64
+gmpd_metrics_get_percentile(GMpdMetrics *self,
+                            const gchar *command,
+                            GMpdMetric   metric,
+                            gdouble      percentile)
+{
+	GMpdCommandMetrics *metrics;
+	guint64 rank;
+	guint64 seen = 0;
+	guint i;
+
+	g_return_val_if_fail(GMPD_IS_METRICS(self), 0);
+	g_return_val_if_fail(command != NULL, 0);
+	g_return_val_if_fail(GMPD_IS_METRIC(metric), 0);
+	g_return_val_if_fail(percentile >= 0.0 && percentile <= 100.0, 0);
+
+	metrics = g_hash_table_lookup(self->commands, command);
+	if (!metrics || !metrics->count)
+		return 0;
+
+	rank = MAX((guint64) (metrics->count * percentile / 100.0 + 0.5), 1);
+
+	for (i = 0; i < GMPD_METRICS_N_BUCKETS; i++) {
+		seen += metrics->histograms[metric][i];
+
+		if (seen >= rank)
+			break;
+	}
+
+	if (i == 0)
+		return 0;
+
+	return (G_GUINT64_CONSTANT(1) << MIN(i, GMPD_METRICS_N_BUCKETS - 1)) - 1;
+}
+
+guint
+gmpd_metrics_get_pipeline_depth(GMpdMetrics *self)
+{
+	g_return_val_if_fail(GMPD_IS_METRICS(self), 0);
+	return self->pipeline_depth;
+}
+
+guint
+gmpd_metrics_get_n_waiting(GMpdMetrics *self)
+{
+	g_return_val_if_fail(GMPD_IS_METRICS(self), 0);
+	return self->n_waiting;
+}
+
+guint
+gmpd_metrics_get_n_reconnects(GMpdMetrics *self)
+{
+	g_return_val_if_fail(GMPD_IS_METRICS(self), 0);
+	return self->n_reconnects;
+}
@@ -0,0 +1,98 @@
+/* libgmpd: MPD protocol implementation for GLib
+ * Copyright (C) 2020 Patrick Keating <binarydrifter@protonmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef __GMPD_METRICS_H__
+#define __GMPD_METRICS_H__
+
+#if !defined(__GMPD_H_INSIDE__) && !defined(__GMPD_BUILD__)
+#   error "Only <gmpd.h> can be included directly."
+#endif
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+#define GMPD_TYPE_METRIC \
+	(gmpd_metric_get_type())
+
+#define GMPD_IS_METRIC(metric) \
+	((metric) >= GMPD_METRIC_QUEUE_WAIT && (metric) <= GMPD_METRIC_PARSE_TIME)
+
+#define GMPD_METRICS_N_BUCKETS 32
+
+#define GMPD_TYPE_METRICS \
+	(gmpd_metrics_get_type())
+
+#define GMPD_METRICS(inst) \
+	(G_TYPE_CHECK_INSTANCE_CAST((inst), GMPD_TYPE_METRICS, GMpdMetrics))
+
+#define GMPD_METRICS_CLASS(klass) \
+	(G_TYPE_CHECK_CLASS_CAST((klass), GMPD_TYPE_METRICS, GMpdMetricsClass))
+
+#define GMPD_IS_METRICS(inst) \
+	(G_TYPE_CHECK_INSTANCE_TYPE((inst), GMPD_TYPE_METRICS))
+
+#define GMPD_IS_METRICS_CLASS(klass) \
+	(G_TYPE_CHECK_CLASS_TYPE((klass), GMPD_TYPE_METRICS))
+
+#define GMPD_METRICS_GET_CLASS(inst) \
+	(G_TYPE_INSTANCE_GET_CLASS((inst), GMPD_TYPE_METRICS, GMpdMetricsClass))
+
+typedef enum _GMpdMetric {
+	GMPD_METRIC_QUEUE_WAIT,
+	GMPD_METRIC_ROUND_TRIP,
+	GMPD_METRIC_PARSE_TIME,
+} GMpdMetric;
+
+typedef struct _GMpdMetrics      GMpdMetrics;
+typedef struct _GMpdMetricsClass GMpdMetricsClass;
+
+GType           gmpd_metric_get_type            (void);
+GType           gmpd_metrics_get_type           (void);
+
+gchar **        gmpd_metrics_get_commands       (GMpdMetrics *self);
+
+guint64         gmpd_metrics_get_count          (GMpdMetrics *self,
+                                                 const gchar *command);
+
+guint64         gmpd_metrics_get_bytes_in       (GMpdMetrics *self,
+                                                 const gchar *command);
+
+guint64         gmpd_metrics_get_bytes_out      (GMpdMetrics *self,
+                                                 const gchar *command);
+
+guint64         gmpd_metrics_get_total_time     (GMpdMetrics *self,
+                                                 const gchar *command,
+                                                 GMpdMetric   metric);
+
+const guint64 * gmpd_metrics_get_histogram      (GMpdMetrics *self,
+                                                 const gchar *command,
+                                                 GMpdMetric   metric);
+
+guint64         gmpd_metrics_get_percentile     (GMpdMetrics *self,
+                                                 const gchar *command,
+                                                 GMpdMetric   metric,
+                                                 gdouble      percentile);
+
+guint           gmpd_metrics_get_pipeline_depth (GMpdMetrics *self);
+guint           gmpd_metrics_get_n_waiting      (GMpdMetrics *self);
+guint           gmpd_metrics_get_n_reconnects   (GMpdMetrics *self);
+
+G_END_DECLS
+
+#endif /* __GMPD_METRICS_H__ */
@@ -32,6 +32,10 @@ struct _GMpdObject {
 	GObject     __base__;
 	GMutex        mutex;
 	GMainContext *context;
+	GSource      *dispatch_source;
+
+	GMutex        notify_mutex;
+	GPtrArray    *pending_pspecs;
 };
 
 struct _GMpdObjectClass {
@@ -41,11 +45,10 @@ struct _GMpdObjectClass {
 void   gmpd_object_lock            (GMpdObject     *self);
 void   gmpd_object_unlock          (GMpdObject     *self);
 
-guint  gmpd_object_run_in_context  (GMpdObject     *self,
+void   gmpd_object_run_in_context  (GMpdObject     *self,
                                     GSourceFunc     callback,
                                     gpointer        data,
-                                    GDestroyNotify  destroy,
-                                    gboolean        have_lock);
+                                    GDestroyNotify  destroy);
 
 G_END_DECLS
 
@@ -20,12 +20,13 @@
 #include "gmpd-object.h"
 #include "gmpd-object-priv.h"
 
-typedef struct _DispatchNotifyData DispatchNotifyData;
+typedef struct _DispatchSource     DispatchSource;
+typedef struct _DispatchItem       DispatchItem;
 
 static void gmpd_object_set_context(GMpdObject *self, GMainContext *context);
-static DispatchNotifyData *dispatch_notify_data_new(GObject *object, guint n_pspecs, GParamSpec **pspecs);
-static void dispatch_notify_data_free(DispatchNotifyData *data);
-static gboolean dispatch_notify_source_func(DispatchNotifyData *data);
+static gboolean dispatch_pending_notify(gpointer data);
+static GSource *dispatch_source_new(void);
+static void dispatch_source_push(GSource *source, GSourceFunc func, gpointer data, GDestroyNotify destroy);
 
 enum {
 	PROP_NONE,
@@ -33,10 +34,16 @@ enum {
 	N_PROPERTIES,
 };
 
-struct _DispatchNotifyData {
-	GObject     *object;
-	guint        n_pspecs;
-	GParamSpec **pspecs;
+struct _DispatchSource {
+	GSource  __base__;
+	GMutex   mutex;
+	GQueue   items;
+};
+
+struct _DispatchItem {
+	GSourceFunc    func;
+	gpointer       data;
+	GDestroyNotify destroy;
 };
 
 G_DEFINE_ABSTRACT_TYPE(GMpdObject, gmpd_object, G_TYPE_OBJECT)
@@ -84,26 +91,51 @@ gmpd_object_finalize(GObject *object)
 {
 	GMpdObject *self = GMPD_OBJECT(object);
 
+	if (self->dispatch_source) {
+		g_source_destroy(self->dispatch_source);
+		g_clear_pointer(&self->dispatch_source, g_source_unref);
+	}
+
 	g_mutex_clear(&self->mutex);
+	g_mutex_clear(&self->notify_mutex);
+	g_clear_pointer(&self->pending_pspecs, g_ptr_array_unref);
 	g_clear_pointer(&self->context, g_main_context_unref);
 
 	G_OBJECT_CLASS(gmpd_object_parent_class)->finalize(object);
 }
 
+/* Notifications are collected until the dispatch source runs, so any
+ * number of changes to a property in between end up as one notify.
+ */
 static void
 gmpd_object_dispatch_properties_changed(GObject     *object,
                                         guint        n_pspecs,
                                         GParamSpec **pspecs)
 {
 	GMpdObject *self = GMPD_OBJECT(object);
-	GSource *source = g_idle_source_new();
+	gboolean schedule;
+	guint i;
+
+	if (!self->context) {
+		G_OBJECT_CLASS(gmpd_object_parent_class)->dispatch_properties_changed(object,
+		                                                                      n_pspecs,
+		                                                                      pspecs);
+		return;
+	}
+
+	g_mutex_lock(&self->notify_mutex);
+
+	schedule = self->pending_pspecs->len == 0;
+
+	for (i = 0; i < n_pspecs; i++) {
+		if (!g_ptr_array_find(self->pending_pspecs, pspecs[i], NULL))
+			g_ptr_array_add(self->pending_pspecs, g_param_spec_ref(pspecs[i]));
+	}
 
-	g_source_set_callback(source,
-	                      (GSourceFunc)dispatch_notify_source_func,
-	                      dispatch_notify_data_new(object, n_pspecs, pspecs),
-	                      (GDestroyNotify)dispatch_notify_data_free);
+	g_mutex_unlock(&self->notify_mutex);
 
-	g_source_attach(source, self->context);
+	if (schedule)
+		gmpd_object_run_in_context(self, dispatch_pending_notify, g_object_ref(self), g_object_unref);
 }
 
 static void
@@ -133,6 +165,9 @@ static void
 gmpd_object_init(GMpdObject *self)
 {
 	g_mutex_init(&self->mutex);
+	g_mutex_init(&self->notify_mutex);
+	self->dispatch_source = NULL;
+	self->pending_pspecs = g_ptr_array_new_with_free_func((GDestroyNotify)g_param_spec_unref);
 }
 
 void
@@ -153,42 +188,29 @@ gmpd_object_unlock(GMpdObject *self)
 	g_object_thaw_notify(G_OBJECT(self));
 }
 
-guint
+/* Callbacks are queued on one source per object and all callbacks
+ * queued by the time it is dispatched run in a single dispatch, in the
+ * order they were queued. Each callback runs exactly once, whatever it
+ * returns. The source exists from construction on, so this never takes
+ * the object lock and works whoever holds it.
+ */
+void
 gmpd_object_run_in_context(GMpdObject    *self,
                            GSourceFunc    callback,
                            gpointer       data,
-                           GDestroyNotify destroy,
-                           gboolean       have_lock)
+                           GDestroyNotify destroy)
 {
-	GSource *source;
-	guint source_id;
-
-	g_return_val_if_fail(GMPD_IS_OBJECT(self), 0);
-	g_return_val_if_fail(callback != NULL, 0);
-
-	if (!have_lock)
-		gmpd_object_lock(self);
+	g_return_if_fail(GMPD_IS_OBJECT(self));
+	g_return_if_fail(callback != NULL);
 
-	if (!self->context) {
+	if (!self->dispatch_source) {
 		if (data && destroy)
 			destroy(data);
 
-		if (!have_lock)
-			gmpd_object_unlock(self);
-
-		return 0;
+		return;
 	}
 
-	source = g_idle_source_new();
-	g_source_set_callback(source, callback, data, destroy);
-
-	source_id = g_source_attach(source, self->context);
-	g_source_unref(source);
-
-	if (!have_lock)
-		gmpd_object_unlock(self);
-
-	return source_id;
+	dispatch_source_push(self->dispatch_source, callback, data, destroy);
 }
 
 GMainContext *
@@ -207,51 +229,123 @@ gmpd_object_set_context(GMpdObject   *self,
 	g_clear_pointer(&self->context, g_main_context_unref);
 	self->context = g_main_context_ref(context);
 
+	if (!self->dispatch_source) {
+		self->dispatch_source = dispatch_source_new();
+		g_source_attach(self->dispatch_source, self->context);
+	}
+
 	g_object_notify_by_pspec(G_OBJECT(self), PROPERTIES[PROP_CONTEXT]);
 }
 
-static DispatchNotifyData *
-dispatch_notify_data_new(GObject     *object,
-                         guint        n_pspecs,
-                         GParamSpec **pspecs)
+static gboolean
+dispatch_pending_notify(gpointer data)
 {
-	DispatchNotifyData *data;
-	guint i;
+	GMpdObject *self = GMPD_OBJECT(data);
+	GObjectClass *parent_class = G_OBJECT_CLASS(gmpd_object_parent_class);
+	GPtrArray *pspecs;
 
-	data = g_slice_new(DispatchNotifyData);
-	data->object = g_object_ref(object);
-	data->n_pspecs = n_pspecs;
-	data->pspecs = g_malloc((n_pspecs + 1) * sizeof(GParamSpec *));
+	g_mutex_lock(&self->notify_mutex);
 
-	for (i = 0; i < n_pspecs; i++)
-		data->pspecs[i] = g_param_spec_ref(pspecs[i]);
+	pspecs = self->pending_pspecs;
+	self->pending_pspecs = g_ptr_array_new_with_free_func((GDestroyNotify)g_param_spec_unref);
 
-	data->pspecs[n_pspecs] = NULL;
+	g_mutex_unlock(&self->notify_mutex);
 
-	return data;
+	parent_class->dispatch_properties_changed(G_OBJECT(self),
+	                                          pspecs->len,
+	                                          (GParamSpec **)pspecs->pdata);
+
+	g_ptr_array_unref(pspecs);
+
+	return G_SOURCE_REMOVE;
+}
+
+static gboolean
+dispatch_source_dispatch(GSource    *source,
+                         GSourceFunc callback G_GNUC_UNUSED,
+                         gpointer    user_data G_GNUC_UNUSED)
+{
+	DispatchSource *self = (DispatchSource *)source;
+	GQueue items;
+	DispatchItem *item;
+
+	g_mutex_lock(&self->mutex);
+
+	items = self->items;
+	g_queue_init(&self->items);
+	g_source_set_ready_time(source, -1);
+
+	g_mutex_unlock(&self->mutex);
+
+	while ((item = g_queue_pop_head(&items))) {
+		item->func(item->data);
+
+		if (item->destroy)
+			item->destroy(item->data);
+
+		g_slice_free(DispatchItem, item);
+	}
+
+	return G_SOURCE_CONTINUE;
 }
 
 static void
-dispatch_notify_data_free(DispatchNotifyData *data)
+dispatch_source_finalize(GSource *source)
 {
-	guint i;
+	DispatchSource *self = (DispatchSource *)source;
+	DispatchItem *item;
 
-	for (i = 0; i < data->n_pspecs; i++)
-		g_param_spec_unref(data->pspecs[i]);
+	while ((item = g_queue_pop_head(&self->items))) {
+		if (item->destroy)
+			item->destroy(item->data);
 
-	g_free(data->pspecs);
-	g_object_unref(data->object);
+		g_slice_free(DispatchItem, item);
+	}
 
-	g_slice_free(DispatchNotifyData, data);
+	g_mutex_clear(&self->mutex);
 }
 
-static gboolean
-dispatch_notify_source_func(DispatchNotifyData *data)
+static GSourceFuncs dispatch_source_funcs = {
+	.dispatch = dispatch_source_dispatch,
+	.finalize = dispatch_source_finalize,
+};
+
+static GSource *
+dispatch_source_new(void)
 {
-	GObjectClass *parent_class = G_OBJECT_CLASS(gmpd_object_parent_class);
+	GSource *source = g_source_new(&dispatch_source_funcs, sizeof(DispatchSource));
+	DispatchSource *self = (DispatchSource *)source;
+
+	g_mutex_init(&self->mutex);
+	g_queue_init(&self->items);
 
-	parent_class->dispatch_properties_changed(data->object, data->n_pspecs, data->pspecs);
+	/* same priority as the idle sources callbacks used to get */
+	g_source_set_name(source, "GMpdObject dispatch");
+	g_source_set_priority(source, G_PRIORITY_DEFAULT_IDLE);
+	g_source_set_ready_time(source, -1);
 
-	return FALSE;
+	return source;
 }
 
+static void
+dispatch_source_push(GSource       *source,
+                     GSourceFunc    func,
+                     gpointer       data,
+                     GDestroyNotify destroy)
+{
+	DispatchSource *self = (DispatchSource *)source;
+	DispatchItem *item = g_slice_new(DispatchItem);
+
+	item->func = func;
+	item->data = data;
+	item->destroy = destroy;
+
+	g_mutex_lock(&self->mutex);
+
+	g_queue_push_tail(&self->items, item);
+
+	if (self->items.length == 1)
+		g_source_set_ready_time(source, 0);
+
+	g_mutex_unlock(&self->mutex);
+}
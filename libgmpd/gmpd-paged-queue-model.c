@@ -0,0 +1,567 @@
+/* libgmpd: MPD protocol implementation for GLib
+ * Copyright (C) 2020 Patrick Keating <binarydrifter@protonmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <gio/gio.h>
+#include "gmpd-batch.h"
+#include "gmpd-batch-priv.h"
+#include "gmpd-client.h"
+#include "gmpd-entity-list.h"
+#include "gmpd-paged-queue-model.h"
+#include "gmpd-protocol.h"
+#include "gmpd-song.h"
+#include "gmpd-status.h"
+
+#define PAGE_SIZE          GMPD_PAGED_QUEUE_MODEL_PAGE_SIZE
+#define PREFETCH_PAGES     1
+#define DEFAULT_MAX_PAGES  32
+#define MIN_MAX_PAGES      (2 * PREFETCH_PAGES + 1)
+
+typedef struct _FetchData FetchData;
+
+static void gmpd_paged_queue_model_list_model_iface_init(GListModelInterface *iface);
+
+static void gmpd_paged_queue_model_set_client(GMpdPagedQueueModel *self,
+                                              GMpdClient          *client);
+
+static void gmpd_paged_queue_model_fetch(GMpdPagedQueueModel *self,
+                                         guint                index);
+
+static void gmpd_paged_queue_model_evict(GMpdPagedQueueModel *self);
+
+static void on_pages_ready(GObject      *source_object,
+                           GAsyncResult *result,
+                           gpointer      user_data);
+
+static void on_status_ready(GObject      *source_object,
+                            GAsyncResult *result,
+                            gpointer      user_data);
+
+enum {
+	PROP_NONE,
+	PROP_CLIENT,
+	PROP_VERSION,
+	PROP_MAX_PAGES,
+	N_PROPERTIES,
+};
+
+struct _FetchData {
+	GMpdPagedQueueModel *self;
+	GArray              *indices;
+};
+
+/* Only the length of the queue is known up front. Rows are loaded a page
+ * at a time when they are first asked for, together with the pages next
+ * to them, and stand in as empty songs until then. Once more than
+ * max_pages are loaded, the pages farthest from the last row asked for
+ * are dropped again.
+ *
+ * Every fetch also asks for the status, so a page is never mixed with
+ * pages of another queue version.
+ */
+struct _GMpdPagedQueueModel {
+	GObject     __base__;
+	GMpdClient *client;
+	guint       version;
+	guint       length;
+	gboolean    synced;
+
+	GHashTable *pages;
+	GHashTable *loading;
+	guint       focus;
+	guint       max_pages;
+};
+
+struct _GMpdPagedQueueModelClass {
+	GObjectClass __base__;
+};
+
+G_DEFINE_TYPE_WITH_CODE(GMpdPagedQueueModel, gmpd_paged_queue_model, G_TYPE_OBJECT,
+                        G_IMPLEMENT_INTERFACE(G_TYPE_LIST_MODEL,
+                                              gmpd_paged_queue_model_list_model_iface_init))
+
+static GParamSpec *PROPERTIES[N_PROPERTIES] = {NULL};
+
+static guint
+gmpd_paged_queue_model_page_length(GMpdPagedQueueModel *self,
+                                   guint                index)
+{
+	guint start = index * PAGE_SIZE;
+
+	if (start >= self->length)
+		return 0;
+
+	return MIN(PAGE_SIZE, self->length - start);
+}
+
+static GType
+gmpd_paged_queue_model_get_item_type(GListModel *list G_GNUC_UNUSED)
+{
+	return GMPD_TYPE_SONG;
+}
+
+static guint
+gmpd_paged_queue_model_get_n_items(GListModel *list)
+{
+	return GMPD_PAGED_QUEUE_MODEL(list)->length;
+}
+
+static gpointer
+gmpd_paged_queue_model_get_item(GListModel *list,
+                                guint       position)
+{
+	GMpdPagedQueueModel *self = GMPD_PAGED_QUEUE_MODEL(list);
+	GPtrArray *page;
+	GMpdSong *song;
+	guint index;
+
+	if (position >= self->length)
+		return NULL;
+
+	index = position / PAGE_SIZE;
+	self->focus = index;
+
+	page = g_hash_table_lookup(self->pages, GUINT_TO_POINTER(index));
+	if (page && position % PAGE_SIZE < page->len)
+		return g_object_ref(g_ptr_array_index(page, position % PAGE_SIZE));
+
+	if (!page)
+		gmpd_paged_queue_model_fetch(self, index);
+
+	song = gmpd_song_new();
+	gmpd_song_set_position(song, position);
+
+	return song;
+}
+
+static void
+gmpd_paged_queue_model_list_model_iface_init(GListModelInterface *iface)
+{
+	iface->get_item_type = gmpd_paged_queue_model_get_item_type;
+	iface->get_n_items = gmpd_paged_queue_model_get_n_items;
+	iface->get_item = gmpd_paged_queue_model_get_item;
+}
+
+static void
+gmpd_paged_queue_model_set_property(GObject      *object,
+                                    guint         prop_id,
+                                    const GValue *value,
+                                    GParamSpec   *pspec)
+{
+	GMpdPagedQueueModel *self = GMPD_PAGED_QUEUE_MODEL(object);
+
+	switch (prop_id) {
+	case PROP_CLIENT:
+		gmpd_paged_queue_model_set_client(self, g_value_get_object(value));
+		break;
+
+	case PROP_MAX_PAGES:
+		gmpd_paged_queue_model_set_max_pages(self, g_value_get_uint(value));
+		break;
+
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+	}
+}
+
+static void
+gmpd_paged_queue_model_get_property(GObject    *object,
+                                    guint       prop_id,
+                                    GValue     *value,
+                                    GParamSpec *pspec)
+{
+	GMpdPagedQueueModel *self = GMPD_PAGED_QUEUE_MODEL(object);
+
+	switch (prop_id) {
+	case PROP_CLIENT:
+		g_value_take_object(value, gmpd_paged_queue_model_get_client(self));
+		break;
+
+	case PROP_VERSION:
+		g_value_set_uint(value, gmpd_paged_queue_model_get_version(self));
+		break;
+
+	case PROP_MAX_PAGES:
+		g_value_set_uint(value, gmpd_paged_queue_model_get_max_pages(self));
+		break;
+
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+	}
+}
+
+static void
+gmpd_paged_queue_model_finalize(GObject *object)
+{
+	GMpdPagedQueueModel *self = GMPD_PAGED_QUEUE_MODEL(object);
+
+	g_clear_object(&self->client);
+	g_clear_pointer(&self->pages, g_hash_table_unref);
+	g_clear_pointer(&self->loading, g_hash_table_unref);
+
+	G_OBJECT_CLASS(gmpd_paged_queue_model_parent_class)->finalize(object);
+}
+
+static void
+gmpd_paged_queue_model_class_init(GMpdPagedQueueModelClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(klass);
+
+	object_class->set_property = gmpd_paged_queue_model_set_property;
+	object_class->get_property = gmpd_paged_queue_model_get_property;
+	object_class->finalize = gmpd_paged_queue_model_finalize;
+
+	PROPERTIES[PROP_CLIENT] =
+		g_param_spec_object("client",
+		                    "Client",
+		                    "Client the queue is read from",
+		                    GMPD_TYPE_CLIENT,
+		                    G_PARAM_READWRITE |
+		                    G_PARAM_CONSTRUCT_ONLY |
+		                    G_PARAM_STATIC_STRINGS);
+
+	PROPERTIES[PROP_VERSION] =
+		g_param_spec_uint("version",
+		                  "Version",
+		                  "Queue version the loaded pages belong to",
+		                  0, G_MAXUINT, 0,
+		                  G_PARAM_READABLE |
+		                  G_PARAM_EXPLICIT_NOTIFY |
+		                  G_PARAM_STATIC_STRINGS);
+
+	PROPERTIES[PROP_MAX_PAGES] =
+		g_param_spec_uint("max-pages",
+		                  "Max Pages",
+		                  "Number of pages kept loaded at most",
+		                  MIN_MAX_PAGES, G_MAXUINT, DEFAULT_MAX_PAGES,
+		                  G_PARAM_READWRITE |
+		                  G_PARAM_EXPLICIT_NOTIFY |
+		                  G_PARAM_STATIC_STRINGS);
+
+	g_object_class_install_properties(object_class, N_PROPERTIES, PROPERTIES);
+}
+
+static void
+gmpd_paged_queue_model_init(GMpdPagedQueueModel *self)
+{
+	self->client = NULL;
+	self->version = 0;
+	self->length = 0;
+	self->synced = FALSE;
+
+	self->pages = g_hash_table_new_full(NULL, NULL, NULL, (GDestroyNotify)g_ptr_array_unref);
+	self->loading = g_hash_table_new(NULL, NULL);
+	self->focus = 0;
+	self->max_pages = DEFAULT_MAX_PAGES;
+}
+
+GMpdPagedQueueModel *
+gmpd_paged_queue_model_new(GMpdClient *client)
+{
+	g_return_val_if_fail(GMPD_IS_CLIENT(client), NULL);
+	return g_object_new(GMPD_TYPE_PAGED_QUEUE_MODEL, "client", client, NULL);
+}
+
+void
+gmpd_paged_queue_model_update_async(GMpdPagedQueueModel *self,
+                                    GCancellable        *cancellable,
+                                    GAsyncReadyCallback  callback,
+                                    gpointer             user_data)
+{
+	GTask *task;
+
+	g_return_if_fail(GMPD_IS_PAGED_QUEUE_MODEL(self));
+	g_return_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable));
+
+	task = g_task_new(self, cancellable, callback, user_data);
+	g_task_set_source_tag(task, gmpd_paged_queue_model_update_async);
+
+	gmpd_client_status_async(self->client, cancellable, on_status_ready, task);
+}
+
+gboolean
+gmpd_paged_queue_model_update_finish(GMpdPagedQueueModel  *self,
+                                     GAsyncResult         *result,
+                                     GError              **error)
+{
+	g_return_val_if_fail(GMPD_IS_PAGED_QUEUE_MODEL(self), FALSE);
+	g_return_val_if_fail(g_task_is_valid(result, self), FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	return g_task_propagate_boolean(G_TASK(result), error);
+}
+
+static void
+gmpd_paged_queue_model_set_client(GMpdPagedQueueModel *self,
+                                  GMpdClient          *client)
+{
+	g_return_if_fail(GMPD_IS_PAGED_QUEUE_MODEL(self));
+	g_return_if_fail(client == NULL || GMPD_IS_CLIENT(client));
+
+	g_set_object(&self->client, client);
+}
+
+void
+gmpd_paged_queue_model_set_max_pages(GMpdPagedQueueModel *self,
+                                     guint                max_pages)
+{
+	g_return_if_fail(GMPD_IS_PAGED_QUEUE_MODEL(self));
+
+	max_pages = MAX(max_pages, MIN_MAX_PAGES);
+
+	if (self->max_pages != max_pages) {
+		self->max_pages = max_pages;
+		gmpd_paged_queue_model_evict(self);
+		g_object_notify_by_pspec(G_OBJECT(self), PROPERTIES[PROP_MAX_PAGES]);
+	}
+}
+
+GMpdClient *
+gmpd_paged_queue_model_get_client(GMpdPagedQueueModel *self)
+{
+	g_return_val_if_fail(GMPD_IS_PAGED_QUEUE_MODEL(self), NULL);
+	return self->client ? g_object_ref(self->client) : NULL;
+}
+
+guint
+gmpd_paged_queue_model_get_version(GMpdPagedQueueModel *self)
+{
+	g_return_val_if_fail(GMPD_IS_PAGED_QUEUE_MODEL(self), 0);
+	return self->version;
+}
+
+guint
+gmpd_paged_queue_model_get_max_pages(GMpdPagedQueueModel *self)
+{
+	g_return_val_if_fail(GMPD_IS_PAGED_QUEUE_MODEL(self), 0);
+	return self->max_pages;
+}
+
+guint
+gmpd_paged_queue_model_get_n_pages(GMpdPagedQueueModel *self)
+{
+	g_return_val_if_fail(GMPD_IS_PAGED_QUEUE_MODEL(self), 0);
+	return g_hash_table_size(self->pages);
+}
+
+/* Drops every page and takes on the new length, the caller emits
+ * items-changed once it has added the pages it has for the version.
+ */
+static guint
+gmpd_paged_queue_model_reset(GMpdPagedQueueModel *self,
+                             guint                version,
+                             guint                length)
+{
+	guint old_length = self->length;
+
+	g_hash_table_remove_all(self->pages);
+
+	self->length = length;
+	self->synced = TRUE;
+
+	if (self->version != version) {
+		self->version = version;
+		g_object_notify_by_pspec(G_OBJECT(self), PROPERTIES[PROP_VERSION]);
+	}
+
+	return old_length;
+}
+
+static guint
+page_distance(guint a,
+              guint b)
+{
+	return a > b ? a - b : b - a;
+}
+
+static void
+gmpd_paged_queue_model_evict(GMpdPagedQueueModel *self)
+{
+	while (g_hash_table_size(self->pages) > self->max_pages) {
+		GHashTableIter iter;
+		gpointer key;
+		guint farthest = 0;
+		guint length;
+
+		g_hash_table_iter_init(&iter, self->pages);
+		while (g_hash_table_iter_next(&iter, &key, NULL)) {
+			guint index = GPOINTER_TO_UINT(key);
+
+			if (page_distance(index, self->focus) >= page_distance(farthest, self->focus))
+				farthest = index;
+		}
+
+		length = gmpd_paged_queue_model_page_length(self, farthest);
+		g_hash_table_remove(self->pages, GUINT_TO_POINTER(farthest));
+
+		if (length)
+			g_list_model_items_changed(G_LIST_MODEL(self), farthest * PAGE_SIZE, length, length);
+	}
+}
+
+static void
+fetch_data_free(FetchData *data)
+{
+	g_object_unref(data->self);
+	g_array_unref(data->indices);
+	g_slice_free(FetchData, data);
+}
+
+static void
+gmpd_paged_queue_model_fetch(GMpdPagedQueueModel *self,
+                             guint                index)
+{
+	FetchData *data;
+	GMpdBatch *batch;
+	guint first;
+	guint last;
+	guint i;
+
+	if (!self->client)
+		return;
+
+	first = index > PREFETCH_PAGES ? index - PREFETCH_PAGES : 0;
+	last = MIN(index + PREFETCH_PAGES, (self->length - 1) / PAGE_SIZE);
+
+	data = g_slice_new(FetchData);
+	data->self = g_object_ref(self);
+	data->indices = g_array_new(FALSE, FALSE, sizeof(guint));
+
+	batch = gmpd_batch_new();
+	gmpd_batch_add_status(batch);
+
+	for (i = first; i <= last; i++) {
+		gpointer key = GUINT_TO_POINTER(i);
+
+		if (g_hash_table_contains(self->pages, key) || !g_hash_table_add(self->loading, key))
+			continue;
+
+		g_array_append_val(data->indices, i);
+		gmpd_batch_add_task(batch,
+		                    gmpd_protocol_playlistinfo_range(i * PAGE_SIZE,
+		                                                     i * PAGE_SIZE + PAGE_SIZE));
+	}
+
+	if (data->indices->len)
+		gmpd_client_batch_async(self->client, batch, NULL, on_pages_ready, data);
+	else
+		fetch_data_free(data);
+
+	g_object_unref(batch);
+}
+
+static void
+on_pages_ready(GObject      *source_object,
+               GAsyncResult *result,
+               gpointer      user_data)
+{
+	FetchData *data = user_data;
+	GMpdPagedQueueModel *self = data->self;
+	GMpdBatch *batch;
+	GMpdStatus *status;
+	GError *error = NULL;
+	gboolean reset = FALSE;
+	guint old_length = 0;
+	guint version;
+	guint i;
+
+	for (i = 0; i < data->indices->len; i++)
+		g_hash_table_remove(self->loading, GUINT_TO_POINTER(g_array_index(data->indices, guint, i)));
+
+	batch = gmpd_client_finish_batch_response(GMPD_CLIENT(source_object), result, &error);
+	if (!batch) {
+		g_warning("unable to load queue pages: %s", error->message);
+		g_error_free(error);
+		fetch_data_free(data);
+		return;
+	}
+
+	status = gmpd_batch_get_response(batch, 0);
+	version = gmpd_status_get_queue_version(status);
+
+	/* the version can also go back when the server was restarted, the
+	 * pages always match the status they came with
+	 */
+	if (!self->synced || version != self->version) {
+		old_length = gmpd_paged_queue_model_reset(self, version,
+		                                          gmpd_status_get_queue_length(status));
+		reset = TRUE;
+	}
+
+	for (i = 0; i < data->indices->len; i++) {
+		guint index = g_array_index(data->indices, guint, i);
+		GMpdEntityList *list = gmpd_batch_get_response(batch, i + 1);
+		GPtrArray *page = gmpd_entity_list_steal_entities(list);
+
+		g_object_unref(list);
+
+		if (!gmpd_paged_queue_model_page_length(self, index)) {
+			g_ptr_array_unref(page);
+			continue;
+		}
+
+		g_hash_table_insert(self->pages, GUINT_TO_POINTER(index), page);
+
+		if (!reset) {
+			guint length = gmpd_paged_queue_model_page_length(self, index);
+			g_list_model_items_changed(G_LIST_MODEL(self), index * PAGE_SIZE, length, length);
+		}
+	}
+
+	if (reset)
+		g_list_model_items_changed(G_LIST_MODEL(self), 0, old_length, self->length);
+
+	gmpd_paged_queue_model_evict(self);
+
+	g_object_unref(status);
+	g_object_unref(batch);
+	fetch_data_free(data);
+}
+
+static void
+on_status_ready(GObject      *source_object,
+                GAsyncResult *result,
+                gpointer      user_data)
+{
+	GTask *task = user_data;
+	GMpdPagedQueueModel *self = g_task_get_source_object(task);
+	GMpdStatus *status;
+	GError *error = NULL;
+	guint version;
+	guint old_length;
+
+	status = gmpd_client_finish_status_response(GMPD_CLIENT(source_object), result, &error);
+	if (!status) {
+		g_task_return_error(task, error);
+		g_object_unref(task);
+		return;
+	}
+
+	version = gmpd_status_get_queue_version(status);
+
+	if (!self->synced || version != self->version) {
+		old_length = gmpd_paged_queue_model_reset(self, version,
+		                                          gmpd_status_get_queue_length(status));
+		g_list_model_items_changed(G_LIST_MODEL(self), 0, old_length, self->length);
+	}
+
+	g_task_return_boolean(task, TRUE);
+
+	g_object_unref(status);
+	g_object_unref(task);
+}
@@ -0,0 +1,78 @@
+/* libgmpd: MPD protocol implementation for GLib
+ * Copyright (C) 2020 Patrick Keating <binarydrifter@protonmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef __GMPD_PAGED_QUEUE_MODEL_H__
+#define __GMPD_PAGED_QUEUE_MODEL_H__
+
+#if !defined(__GMPD_H_INSIDE__) && !defined(__GMPD_BUILD__)
+#   error "Only <gmpd.h> can be included directly."
+#endif
+
+#include <gio/gio.h>
+#include <gmpd-client.h>
+
+G_BEGIN_DECLS
+
+#define GMPD_PAGED_QUEUE_MODEL_PAGE_SIZE 128
+
+#define GMPD_TYPE_PAGED_QUEUE_MODEL \
+	(gmpd_paged_queue_model_get_type())
+
+#define GMPD_PAGED_QUEUE_MODEL(inst) \
+	(G_TYPE_CHECK_INSTANCE_CAST((inst), GMPD_TYPE_PAGED_QUEUE_MODEL, GMpdPagedQueueModel))
+
+#define GMPD_PAGED_QUEUE_MODEL_CLASS(klass) \
+	(G_TYPE_CHECK_CLASS_CAST((klass), GMPD_TYPE_PAGED_QUEUE_MODEL, GMpdPagedQueueModelClass))
+
+#define GMPD_IS_PAGED_QUEUE_MODEL(inst) \
+	(G_TYPE_CHECK_INSTANCE_TYPE((inst), GMPD_TYPE_PAGED_QUEUE_MODEL))
+
+#define GMPD_IS_PAGED_QUEUE_MODEL_CLASS(klass) \
+	(G_TYPE_CHECK_CLASS_TYPE((klass), GMPD_TYPE_PAGED_QUEUE_MODEL))
+
+#define GMPD_PAGED_QUEUE_MODEL_GET_CLASS(inst) \
+	(G_TYPE_INSTANCE_GET_CLASS((inst), GMPD_TYPE_PAGED_QUEUE_MODEL, GMpdPagedQueueModelClass))
+
+typedef struct _GMpdPagedQueueModel      GMpdPagedQueueModel;
+typedef struct _GMpdPagedQueueModelClass GMpdPagedQueueModelClass;
+
+GType                  gmpd_paged_queue_model_get_type       (void);
+
+GMpdPagedQueueModel *  gmpd_paged_queue_model_new            (GMpdClient          *client);
+
+void                   gmpd_paged_queue_model_update_async   (GMpdPagedQueueModel *self,
+                                                              GCancellable        *cancellable,
+                                                              GAsyncReadyCallback  callback,
+                                                              gpointer             user_data);
+
+gboolean               gmpd_paged_queue_model_update_finish  (GMpdPagedQueueModel *self,
+                                                              GAsyncResult        *result,
+                                                              GError             **error);
+
+void                   gmpd_paged_queue_model_set_max_pages  (GMpdPagedQueueModel *self,
+                                                              guint                max_pages);
+
+GMpdClient *           gmpd_paged_queue_model_get_client     (GMpdPagedQueueModel *self);
+guint                  gmpd_paged_queue_model_get_version    (GMpdPagedQueueModel *self);
+guint                  gmpd_paged_queue_model_get_max_pages  (GMpdPagedQueueModel *self);
+guint                  gmpd_paged_queue_model_get_n_pages    (GMpdPagedQueueModel *self);
+
+G_END_DECLS
+
+#endif /* __GMPD_PAGED_QUEUE_MODEL_H__ */
@@ -0,0 +1,268 @@
+/* libgmpd: MPD protocol implementation for GLib
+ * Copyright (C) 2020 Patrick Keating <binarydrifter@protonmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <gio/gio.h>
+#include "gmpd-playback-clock.h"
+#include "gmpd-playback-state.h"
+#include "gmpd-status.h"
+
+static void gmpd_playback_clock_set_status (GMpdPlaybackClock *self,
+                                            GMpdStatus        *status);
+
+static void on_status_notify  (GMpdStatus        *status,
+                               GParamSpec        *pspec,
+                               GMpdPlaybackClock *self);
+static void on_status_updated (GMpdStatus        *status,
+                               GMpdPlaybackClock *self);
+
+enum {
+	PROP_NONE,
+	PROP_STATUS,
+	PROP_RUNNING,
+	N_PROPERTIES,
+};
+
+/* The elapsed time of the last status sample is extrapolated with the
+ * monotonic clock while the server is playing. A new sample is taken
+ * whenever the status is updated, even when the elapsed time comes
+ * back unchanged, and whenever one of the sampled properties is set.
+ * Keeping the status up to date on player events (GMpdLiveState does)
+ * keeps the clock in sync without polling.
+ */
+struct _GMpdPlaybackClock {
+	GObject     __base__;
+	GMpdStatus *status;
+	gulong      notify_handler;
+	gulong      updated_handler;
+
+	gboolean    running;
+	gfloat      elapsed;
+	gfloat      duration;
+	gint64      sample_time;
+};
+
+struct _GMpdPlaybackClockClass {
+	GObjectClass __base__;
+};
+
+G_DEFINE_TYPE(GMpdPlaybackClock, gmpd_playback_clock, G_TYPE_OBJECT)
+
+static GParamSpec *PROPERTIES[N_PROPERTIES] = {NULL};
+
+static void
+gmpd_playback_clock_set_property(GObject      *object,
+                                 guint         prop_id,
+                                 const GValue *value,
+                                 GParamSpec   *pspec)
+{
+	GMpdPlaybackClock *self = GMPD_PLAYBACK_CLOCK(object);
+
+	switch (prop_id) {
+	case PROP_STATUS:
+		gmpd_playback_clock_set_status(self, g_value_get_object(value));
+		break;
+
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+	}
+}
+
+static void
+gmpd_playback_clock_get_property(GObject    *object,
+                                 guint       prop_id,
+                                 GValue     *value,
+                                 GParamSpec *pspec)
+{
+	GMpdPlaybackClock *self = GMPD_PLAYBACK_CLOCK(object);
+
+	switch (prop_id) {
+	case PROP_STATUS:
+		g_value_take_object(value, gmpd_playback_clock_get_status(self));
+		break;
+
+	case PROP_RUNNING:
+		g_value_set_boolean(value, gmpd_playback_clock_get_running(self));
+		break;
+
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+	}
+}
+
+static void
+gmpd_playback_clock_dispose(GObject *object)
+{
+	GMpdPlaybackClock *self = GMPD_PLAYBACK_CLOCK(object);
+
+	if (self->notify_handler) {
+		g_signal_handler_disconnect(self->status, self->notify_handler);
+		self->notify_handler = 0;
+	}
+
+	if (self->updated_handler) {
+		g_signal_handler_disconnect(self->status, self->updated_handler);
+		self->updated_handler = 0;
+	}
+
+	g_clear_object(&self->status);
+
+	G_OBJECT_CLASS(gmpd_playback_clock_parent_class)->dispose(object);
+}
+
+static void
+gmpd_playback_clock_class_init(GMpdPlaybackClockClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(klass);
+
+	object_class->set_property = gmpd_playback_clock_set_property;
+	object_class->get_property = gmpd_playback_clock_get_property;
+	object_class->dispose = gmpd_playback_clock_dispose;
+
+	PROPERTIES[PROP_STATUS] =
+		g_param_spec_object("status",
+		                    "Status",
+		                    "Status the clock is sampled from",
+		                    GMPD_TYPE_STATUS,
+		                    G_PARAM_READWRITE |
+		                    G_PARAM_CONSTRUCT_ONLY |
+		                    G_PARAM_STATIC_STRINGS);
+
+	PROPERTIES[PROP_RUNNING] =
+		g_param_spec_boolean("running",
+		                     "Running",
+		                     "Whether the elapsed time is advancing",
+		                     FALSE,
+		                     G_PARAM_READABLE |
+		                     G_PARAM_EXPLICIT_NOTIFY |
+		                     G_PARAM_STATIC_STRINGS);
+
+	g_object_class_install_properties(object_class, N_PROPERTIES, PROPERTIES);
+}
+
+static void
+gmpd_playback_clock_init(GMpdPlaybackClock *self)
+{
+	self->status = NULL;
+	self->notify_handler = 0;
+	self->updated_handler = 0;
+
+	self->running = FALSE;
+	self->elapsed = 0;
+	self->duration = 0;
+	self->sample_time = 0;
+}
+
+GMpdPlaybackClock *
+gmpd_playback_clock_new(GMpdStatus *status)
+{
+	g_return_val_if_fail(GMPD_IS_STATUS(status), NULL);
+	return g_object_new(GMPD_TYPE_PLAYBACK_CLOCK, "status", status, NULL);
+}
+
+/* Takes a new sample from the status. This happens on its own when the
+ * status is updated or notifies, calling it is only needed after the
+ * status fields were written without either.
+ */
+void
+gmpd_playback_clock_sync(GMpdPlaybackClock *self)
+{
+	gboolean running;
+
+	g_return_if_fail(GMPD_IS_PLAYBACK_CLOCK(self));
+
+	running = gmpd_status_get_playback(self->status) == GMPD_PLAYBACK_PLAYING;
+
+	self->elapsed = gmpd_status_get_current_elapsed(self->status);
+	self->duration = gmpd_status_get_current_duration(self->status);
+	self->sample_time = g_get_monotonic_time();
+
+	if (self->running != running) {
+		self->running = running;
+		g_object_notify_by_pspec(G_OBJECT(self), PROPERTIES[PROP_RUNNING]);
+	}
+}
+
+static void
+gmpd_playback_clock_set_status(GMpdPlaybackClock *self,
+                               GMpdStatus        *status)
+{
+	g_return_if_fail(GMPD_IS_PLAYBACK_CLOCK(self));
+	g_return_if_fail(GMPD_IS_STATUS(status));
+	g_return_if_fail(self->status == NULL);
+
+	self->status = g_object_ref(status);
+	self->notify_handler = g_signal_connect(status, "notify", G_CALLBACK(on_status_notify), self);
+	self->updated_handler = g_signal_connect(status, "updated", G_CALLBACK(on_status_updated), self);
+
+	gmpd_playback_clock_sync(self);
+}
+
+GMpdStatus *
+gmpd_playback_clock_get_status(GMpdPlaybackClock *self)
+{
+	g_return_val_if_fail(GMPD_IS_PLAYBACK_CLOCK(self), NULL);
+	return self->status ? g_object_ref(self->status) : NULL;
+}
+
+gboolean
+gmpd_playback_clock_get_running(GMpdPlaybackClock *self)
+{
+	g_return_val_if_fail(GMPD_IS_PLAYBACK_CLOCK(self), FALSE);
+	return self->running;
+}
+
+/* Cheap enough to be called on every frame of a progress bar. */
+gfloat
+gmpd_playback_clock_get_elapsed(GMpdPlaybackClock *self)
+{
+	gfloat elapsed;
+
+	g_return_val_if_fail(GMPD_IS_PLAYBACK_CLOCK(self), 0);
+
+	if (!self->running)
+		return self->elapsed;
+
+	elapsed = self->elapsed + (gfloat) (g_get_monotonic_time() - self->sample_time) / G_USEC_PER_SEC;
+
+	/* the server moves on to the next song by itself, until the
+	 * status catches up the clock stops at the end of this one */
+	if (self->duration > 0)
+		elapsed = MIN(elapsed, self->duration);
+
+	return elapsed;
+}
+
+static void
+on_status_notify(GMpdStatus        *status G_GNUC_UNUSED,
+                 GParamSpec        *pspec,
+                 GMpdPlaybackClock *self)
+{
+	if (g_strcmp0(pspec->name, "current-elapsed") == 0 ||
+	    g_strcmp0(pspec->name, "current-duration") == 0 ||
+	    g_strcmp0(pspec->name, "current-id") == 0 ||
+	    g_strcmp0(pspec->name, "playback") == 0)
+		gmpd_playback_clock_sync(self);
+}
+
+static void
+on_status_updated(GMpdStatus        *status G_GNUC_UNUSED,
+                  GMpdPlaybackClock *self)
+{
+	gmpd_playback_clock_sync(self);
+}
@@ -0,0 +1,65 @@
+/* libgmpd: MPD protocol implementation for GLib
+ * Copyright (C) 2020 Patrick Keating <binarydrifter@protonmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef __GMPD_PLAYBACK_CLOCK_H__
+#define __GMPD_PLAYBACK_CLOCK_H__
+
+#if !defined(__GMPD_H_INSIDE__) && !defined(__GMPD_BUILD__)
+#   error "Only <gmpd.h> can be included directly."
+#endif
+
+#include <gio/gio.h>
+#include <gmpd-status.h>
+
+G_BEGIN_DECLS
+
+#define GMPD_TYPE_PLAYBACK_CLOCK \
+	(gmpd_playback_clock_get_type())
+
+#define GMPD_PLAYBACK_CLOCK(inst) \
+	(G_TYPE_CHECK_INSTANCE_CAST((inst), GMPD_TYPE_PLAYBACK_CLOCK, GMpdPlaybackClock))
+
+#define GMPD_PLAYBACK_CLOCK_CLASS(klass) \
+	(G_TYPE_CHECK_CLASS_CAST((klass), GMPD_TYPE_PLAYBACK_CLOCK, GMpdPlaybackClockClass))
+
+#define GMPD_IS_PLAYBACK_CLOCK(inst) \
+	(G_TYPE_CHECK_INSTANCE_TYPE((inst), GMPD_TYPE_PLAYBACK_CLOCK))
+
+#define GMPD_IS_PLAYBACK_CLOCK_CLASS(klass) \
+	(G_TYPE_CHECK_CLASS_TYPE((klass), GMPD_TYPE_PLAYBACK_CLOCK))
+
+#define GMPD_PLAYBACK_CLOCK_GET_CLASS(inst) \
+	(G_TYPE_INSTANCE_GET_CLASS((inst), GMPD_TYPE_PLAYBACK_CLOCK, GMpdPlaybackClockClass))
+
+typedef struct _GMpdPlaybackClock      GMpdPlaybackClock;
+typedef struct _GMpdPlaybackClockClass GMpdPlaybackClockClass;
+
+GType                gmpd_playback_clock_get_type     (void);
+
+GMpdPlaybackClock *  gmpd_playback_clock_new          (GMpdStatus        *status);
+
+void                 gmpd_playback_clock_sync         (GMpdPlaybackClock *self);
+
+GMpdStatus *         gmpd_playback_clock_get_status   (GMpdPlaybackClock *self);
+gboolean             gmpd_playback_clock_get_running  (GMpdPlaybackClock *self);
+gfloat               gmpd_playback_clock_get_elapsed  (GMpdPlaybackClock *self);
+
+G_END_DECLS
+
+#endif /* __GMPD_PLAYBACK_CLOCK_H__ */
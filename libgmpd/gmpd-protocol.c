@@ -17,6 +17,10 @@
  */
 
 #include <gio/gio.h>
+#include "gmpd-batch.h"
+#include "gmpd-batch-priv.h"
+#include "gmpd-binary-response.h"
+#include "gmpd-entity-list.h"
 #include "gmpd-idle.h"
 #include "gmpd-idle-response.h"
 #include "gmpd-protocol.h"
@@ -26,6 +30,7 @@
 #include "gmpd-song.h"
 #include "gmpd-stats.h"
 #include "gmpd-status.h"
+#include "gmpd-tag.h"
 #include "gmpd-void-response.h"
 
 static GMpdTaskData *
@@ -38,6 +43,27 @@ gmpd_task_data_new(gchar        *command,
 	self->command = command;
 	self->response = response;
 	self->error = NULL;
+	self->idempotent = FALSE;
+
+	self->queue_time = 0;
+	self->send_time = 0;
+	self->parse_time = 0;
+	self->bytes_in = 0;
+
+	return self;
+}
+
+/* For commands that only read state, they are sent again after a
+ * reconnect when their response was not received. Everything else is
+ * only sent once.
+ */
+static GMpdTaskData *
+gmpd_task_data_new_idempotent(gchar        *command,
+                              GMpdResponse *response)
+{
+	GMpdTaskData *self = gmpd_task_data_new(command, response);
+
+	self->idempotent = TRUE;
 
 	return self;
 }
@@ -77,7 +103,7 @@ gmpd_protocol_clearerror(void)
 GMpdTaskData *
 gmpd_protocol_currentsong(void)
 {
-	return gmpd_task_data_new(g_strdup("currentsong\n"), GMPD_RESPONSE(gmpd_song_new()));
+	return gmpd_task_data_new_idempotent(g_strdup("currentsong\n"), GMPD_RESPONSE(gmpd_song_new()));
 }
 
 GMpdTaskData *
@@ -96,19 +122,19 @@ gmpd_protocol_idle(GMpdIdle subsystems)
 		g_free(arg);
 	}
 
-	return gmpd_task_data_new(command, GMPD_RESPONSE(gmpd_idle_response_new()));
+	return gmpd_task_data_new_idempotent(command, GMPD_RESPONSE(gmpd_idle_response_new()));
 }
 
 GMpdTaskData *
 gmpd_protocol_status(void)
 {
-	return gmpd_task_data_new(g_strdup("status\n"), GMPD_RESPONSE(gmpd_status_new()));
+	return gmpd_task_data_new_idempotent(g_strdup("status\n"), GMPD_RESPONSE(gmpd_status_new()));
 }
 
 GMpdTaskData *
 gmpd_protocol_stats(void)
 {
-	return gmpd_task_data_new(g_strdup("stats\n"), GMPD_RESPONSE(gmpd_stats_new()));
+	return gmpd_task_data_new_idempotent(g_strdup("stats\n"), GMPD_RESPONSE(gmpd_stats_new()));
 }
 
 GMpdTaskData *
@@ -140,7 +166,171 @@ gmpd_protocol_replay_gain_mode(GMpdReplayGainMode mode)
 GMpdTaskData *
 gmpd_protocol_replay_gain_status(void)
 {
-	return gmpd_task_data_new(g_strdup("replay_gain_status\n"),
-	                          GMPD_RESPONSE(gmpd_replay_gain_status_new()));
+	return gmpd_task_data_new_idempotent(g_strdup("replay_gain_status\n"),
+	                                     GMPD_RESPONSE(gmpd_replay_gain_status_new()));
+}
+
+GMpdTaskData *
+gmpd_protocol_batch(GMpdBatch *batch)
+{
+	GMpdTaskData *self;
+	GString *command;
+	gboolean idempotent = TRUE;
+	guint i;
+
+	g_return_val_if_fail(GMPD_IS_BATCH(batch), NULL);
+	g_return_val_if_fail(!batch->sent, NULL);
+
+	batch->sent = TRUE;
+
+	command = g_string_new("command_list_ok_begin\n");
+
+	for (i = 0; i < batch->tasks->len; i++) {
+		GMpdTaskData *data = g_ptr_array_index(batch->tasks, i);
+		g_string_append(command, data->command);
+		idempotent = idempotent && data->idempotent;
+	}
+
+	g_string_append(command, "command_list_end\n");
+
+	self = gmpd_task_data_new(g_string_free(command, FALSE),
+	                          GMPD_RESPONSE(g_object_ref(batch)));
+	self->idempotent = idempotent;
+
+	return self;
 }
 
+G_STATIC_ASSERT(GMPD_N_TAGS < 32);
+
+/* tag_types has bit n set for GMPD_TAG n. The commands are sent as a
+ * list so the server never sees an empty set in between.
+ */
+GMpdTaskData *
+gmpd_protocol_tagtypes(guint32 tag_types)
+{
+	GString *command;
+	GMpdTag tag;
+
+	if (tag_types == (1u << GMPD_N_TAGS) - 1)
+		return gmpd_task_data_new_idempotent(g_strdup("tagtypes all\n"), GMPD_RESPONSE(gmpd_void_response_new()));
+
+	command = g_string_new("command_list_begin\ntagtypes clear\n");
+
+	if (tag_types) {
+		g_string_append(command, "tagtypes enable");
+
+		for (tag = 0; tag < GMPD_N_TAGS; tag++) {
+			if (tag_types & (1u << tag)) {
+				gchar *tag_str = gmpd_tag_to_string(tag);
+
+				g_string_append_printf(command, " %s", tag_str);
+
+				g_free(tag_str);
+			}
+		}
+
+		g_string_append_c(command, '\n');
+	}
+
+	g_string_append(command, "command_list_end\n");
+
+	return gmpd_task_data_new_idempotent(g_string_free(command, FALSE),
+	                                     GMPD_RESPONSE(gmpd_void_response_new()));
+}
+
+/* Arguments are quoted so they can contain spaces, which means the
+ * quotes and backslashes in them have to be escaped.
+ */
+static void
+gmpd_protocol_append_arg(GString     *command,
+                         const gchar *arg)
+{
+	const gchar *c;
+
+	g_string_append(command, " \"");
+
+	for (c = arg; *c; c++) {
+		if (*c == '"' || *c == '\\')
+			g_string_append_c(command, '\\');
+
+		g_string_append_c(command, *c);
+	}
+
+	g_string_append_c(command, '"');
+}
+
+GMpdTaskData *
+gmpd_protocol_playlistinfo(void)
+{
+	return gmpd_task_data_new_idempotent(g_strdup("playlistinfo\n"),
+	                                     GMPD_RESPONSE(gmpd_entity_list_new()));
+}
+
+GMpdTaskData *
+gmpd_protocol_playlistinfo_range(guint start,
+                                 guint end)
+{
+	g_return_val_if_fail(start < end, NULL);
+
+	return gmpd_task_data_new_idempotent(g_strdup_printf("playlistinfo %u:%u\n", start, end),
+	                                     GMPD_RESPONSE(gmpd_entity_list_new()));
+}
+
+GMpdTaskData *
+gmpd_protocol_listallinfo(const gchar *path)
+{
+	GString *command = g_string_new("listallinfo");
+
+	if (path)
+		gmpd_protocol_append_arg(command, path);
+
+	g_string_append_c(command, '\n');
+
+	return gmpd_task_data_new_idempotent(g_string_free(command, FALSE),
+	                                     GMPD_RESPONSE(gmpd_entity_list_new()));
+}
+
+GMpdTaskData *
+gmpd_protocol_plchanges(guint version)
+{
+	return gmpd_task_data_new_idempotent(g_strdup_printf("plchanges %u\n", version),
+	                                     GMPD_RESPONSE(gmpd_entity_list_new()));
+}
+
+static GMpdTaskData *
+gmpd_protocol_binary(const gchar        *name,
+                     const gchar        *uri,
+                     GMpdBinaryResponse *response)
+{
+	GString *command;
+
+	g_return_val_if_fail(uri != NULL, NULL);
+	g_return_val_if_fail(GMPD_IS_BINARY_RESPONSE(response), NULL);
+
+	command = g_string_new(name);
+	gmpd_protocol_append_arg(command, uri);
+	g_string_append_printf(command, " %" G_GSIZE_FORMAT "\n", response->offset);
+
+	return gmpd_task_data_new_idempotent(g_string_free(command, FALSE), GMPD_RESPONSE(response));
+}
+
+GMpdTaskData *
+gmpd_protocol_albumart(const gchar        *uri,
+                       GMpdBinaryResponse *response)
+{
+	return gmpd_protocol_binary("albumart", uri, response);
+}
+
+GMpdTaskData *
+gmpd_protocol_readpicture(const gchar        *uri,
+                          GMpdBinaryResponse *response)
+{
+	return gmpd_protocol_binary("readpicture", uri, response);
+}
+
+GMpdTaskData *
+gmpd_protocol_binarylimit(guint size)
+{
+	return gmpd_task_data_new_idempotent(g_strdup_printf("binarylimit %u\n", size),
+	                                     GMPD_RESPONSE(gmpd_void_response_new()));
+}
@@ -24,9 +24,12 @@
 #endif
 
 #include <gio/gio.h>
+#include <gmpd-batch.h>
+#include "gmpd-binary-response.h"
 #include <gmpd-idle.h>
 #include <gmpd-replay-gain-mode.h>
 #include <gmpd-response.h>
+#include <gmpd-tag.h>
 #include <gmpd-version.h>
 
 G_BEGIN_DECLS
@@ -36,6 +39,13 @@ typedef struct _GMpdTaskData {
 	gchar         *command;
 	GMpdResponse  *response;
 	GError        *error;
+	gboolean       idempotent;
+
+	/* only filled in when the client collects metrics */
+	gint64         queue_time;
+	gint64         send_time;
+	gint64         parse_time;
+	gsize          bytes_in;
 } GMpdTaskData;
 
 GMpdTaskData * gmpd_task_data_ref               (GMpdTaskData      *self);
@@ -49,6 +59,21 @@ GMpdTaskData * gmpd_protocol_stats              (void);
 GMpdTaskData * gmpd_protocol_close              (void);
 GMpdTaskData * gmpd_protocol_replay_gain_mode   (GMpdReplayGainMode mode);
 GMpdTaskData * gmpd_protocol_replay_gain_status (void);
+GMpdTaskData * gmpd_protocol_batch              (GMpdBatch         *batch);
+GMpdTaskData * gmpd_protocol_tagtypes           (guint32            tag_types);
+GMpdTaskData * gmpd_protocol_playlistinfo       (void);
+GMpdTaskData * gmpd_protocol_playlistinfo_range (guint              start,
+                                                 guint              end);
+GMpdTaskData * gmpd_protocol_listallinfo        (const gchar       *path);
+GMpdTaskData * gmpd_protocol_plchanges          (guint              version);
+
+GMpdTaskData * gmpd_protocol_albumart           (const gchar       *uri,
+                                                 GMpdBinaryResponse *response);
+
+GMpdTaskData * gmpd_protocol_readpicture        (const gchar       *uri,
+                                                 GMpdBinaryResponse *response);
+
+GMpdTaskData * gmpd_protocol_binarylimit        (guint              size);
 
 G_END_DECLS
 
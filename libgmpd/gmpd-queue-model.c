@@ -0,0 +1,620 @@
+/* libgmpd: MPD protocol implementation for GLib
+ * Copyright (C) 2020 Patrick Keating <binarydrifter@protonmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <gio/gio.h>
+#include "gmpd-batch.h"
+#include "gmpd-batch-priv.h"
+#include "gmpd-client.h"
+#include "gmpd-entity-list.h"
+#include "gmpd-entity-priv.h"
+#include "gmpd-protocol.h"
+#include "gmpd-queue-model.h"
+#include "gmpd-song.h"
+#include "gmpd-status.h"
+
+static void gmpd_queue_model_list_model_iface_init(GListModelInterface *iface);
+
+static void gmpd_queue_model_set_client(GMpdQueueModel *self,
+                                        GMpdClient     *client);
+
+static void gmpd_queue_model_start_round(GMpdQueueModel *self);
+static void gmpd_queue_model_finish_round(GMpdQueueModel *self,
+                                          GError         *error);
+
+static void on_changes_ready(GObject      *source_object,
+                             GAsyncResult *result,
+                             gpointer      user_data);
+
+enum {
+	PROP_NONE,
+	PROP_CLIENT,
+	PROP_VERSION,
+	N_PROPERTIES,
+};
+
+/* songs mirrors the queue.
+ *
+ * Updates run in rounds. A round sends status and plchanges as one
+ * command list, so the length and version always match the changes, and
+ * every changed position comes with its full song, priority and range
+ * included. Updates requested while a round is running share the next
+ * one.
+ */
+struct _GMpdQueueModel {
+	GObject        __base__;
+	GMpdClient    *client;
+	GPtrArray     *songs;
+	guint          version;
+	gboolean       synced;
+
+	GPtrArray     *waiting;
+	GPtrArray     *running;
+};
+
+struct _GMpdQueueModelClass {
+	GObjectClass __base__;
+};
+
+G_DEFINE_TYPE_WITH_CODE(GMpdQueueModel, gmpd_queue_model, G_TYPE_OBJECT,
+                        G_IMPLEMENT_INTERFACE(G_TYPE_LIST_MODEL,
+                                              gmpd_queue_model_list_model_iface_init))
+
+static GParamSpec *PROPERTIES[N_PROPERTIES] = {NULL};
+
+static GType
+gmpd_queue_model_get_item_type(GListModel *list G_GNUC_UNUSED)
+{
+	return GMPD_TYPE_SONG;
+}
+
+static guint
+gmpd_queue_model_get_n_items(GListModel *list)
+{
+	return GMPD_QUEUE_MODEL(list)->songs->len;
+}
+
+static gpointer
+gmpd_queue_model_get_item(GListModel *list,
+                          guint       position)
+{
+	GMpdQueueModel *self = GMPD_QUEUE_MODEL(list);
+
+	if (position >= self->songs->len)
+		return NULL;
+
+	return g_object_ref(g_ptr_array_index(self->songs, position));
+}
+
+static void
+gmpd_queue_model_list_model_iface_init(GListModelInterface *iface)
+{
+	iface->get_item_type = gmpd_queue_model_get_item_type;
+	iface->get_n_items = gmpd_queue_model_get_n_items;
+	iface->get_item = gmpd_queue_model_get_item;
+}
+
+static void
+gmpd_queue_model_set_property(GObject      *object,
+                              guint         prop_id,
+                              const GValue *value,
+                              GParamSpec   *pspec)
+{
+	GMpdQueueModel *self = GMPD_QUEUE_MODEL(object);
+
+	switch (prop_id) {
+	case PROP_CLIENT:
+		gmpd_queue_model_set_client(self, g_value_get_object(value));
+		break;
+
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+	}
+}
+
+static void
+gmpd_queue_model_get_property(GObject    *object,
+                              guint       prop_id,
+                              GValue     *value,
+                              GParamSpec *pspec)
+{
+	GMpdQueueModel *self = GMPD_QUEUE_MODEL(object);
+
+	switch (prop_id) {
+	case PROP_CLIENT:
+		g_value_take_object(value, gmpd_queue_model_get_client(self));
+		break;
+
+	case PROP_VERSION:
+		g_value_set_uint(value, gmpd_queue_model_get_version(self));
+		break;
+
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+	}
+}
+
+static void
+gmpd_queue_model_finalize(GObject *object)
+{
+	GMpdQueueModel *self = GMPD_QUEUE_MODEL(object);
+
+	g_clear_object(&self->client);
+	g_clear_pointer(&self->songs, g_ptr_array_unref);
+	g_clear_pointer(&self->waiting, g_ptr_array_unref);
+	g_clear_pointer(&self->running, g_ptr_array_unref);
+
+	G_OBJECT_CLASS(gmpd_queue_model_parent_class)->finalize(object);
+}
+
+static void
+gmpd_queue_model_class_init(GMpdQueueModelClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(klass);
+
+	object_class->set_property = gmpd_queue_model_set_property;
+	object_class->get_property = gmpd_queue_model_get_property;
+	object_class->finalize = gmpd_queue_model_finalize;
+
+	PROPERTIES[PROP_CLIENT] =
+		g_param_spec_object("client",
+		                    "Client",
+		                    "Client the queue is read from",
+		                    GMPD_TYPE_CLIENT,
+		                    G_PARAM_READWRITE |
+		                    G_PARAM_CONSTRUCT_ONLY |
+		                    G_PARAM_STATIC_STRINGS);
+
+	PROPERTIES[PROP_VERSION] =
+		g_param_spec_uint("version",
+		                  "Version",
+		                  "Queue version the model was last updated to",
+		                  0, G_MAXUINT, 0,
+		                  G_PARAM_READABLE |
+		                  G_PARAM_EXPLICIT_NOTIFY |
+		                  G_PARAM_STATIC_STRINGS);
+
+	g_object_class_install_properties(object_class, N_PROPERTIES, PROPERTIES);
+}
+
+static void
+gmpd_queue_model_init(GMpdQueueModel *self)
+{
+	self->client = NULL;
+	self->songs = g_ptr_array_new_with_free_func(g_object_unref);
+	self->version = 0;
+	self->synced = FALSE;
+
+	self->waiting = g_ptr_array_new_with_free_func(g_object_unref);
+	self->running = g_ptr_array_new_with_free_func(g_object_unref);
+}
+
+GMpdQueueModel *
+gmpd_queue_model_new(GMpdClient *client)
+{
+	g_return_val_if_fail(GMPD_IS_CLIENT(client), NULL);
+	return g_object_new(GMPD_TYPE_QUEUE_MODEL, "client", client, NULL);
+}
+
+void
+gmpd_queue_model_update_async(GMpdQueueModel      *self,
+                              GCancellable        *cancellable,
+                              GAsyncReadyCallback  callback,
+                              gpointer             user_data)
+{
+	GTask *task;
+
+	g_return_if_fail(GMPD_IS_QUEUE_MODEL(self));
+	g_return_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable));
+
+	task = g_task_new(self, cancellable, callback, user_data);
+	g_task_set_source_tag(task, gmpd_queue_model_update_async);
+
+	g_ptr_array_add(self->waiting, task);
+
+	if (!self->running->len)
+		gmpd_queue_model_start_round(self);
+}
+
+gboolean
+gmpd_queue_model_update_finish(GMpdQueueModel  *self,
+                               GAsyncResult    *result,
+                               GError         **error)
+{
+	g_return_val_if_fail(GMPD_IS_QUEUE_MODEL(self), FALSE);
+	g_return_val_if_fail(g_task_is_valid(result, self), FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	return g_task_propagate_boolean(G_TASK(result), error);
+}
+
+static void
+gmpd_queue_model_set_client(GMpdQueueModel *self,
+                            GMpdClient     *client)
+{
+	g_return_if_fail(GMPD_IS_QUEUE_MODEL(self));
+	g_return_if_fail(client == NULL || GMPD_IS_CLIENT(client));
+
+	g_set_object(&self->client, client);
+}
+
+GMpdClient *
+gmpd_queue_model_get_client(GMpdQueueModel *self)
+{
+	g_return_val_if_fail(GMPD_IS_QUEUE_MODEL(self), NULL);
+	return self->client ? g_object_ref(self->client) : NULL;
+}
+
+guint
+gmpd_queue_model_get_version(GMpdQueueModel *self)
+{
+	g_return_val_if_fail(GMPD_IS_QUEUE_MODEL(self), 0);
+	return self->version;
+}
+
+static void
+gmpd_queue_model_set_version(GMpdQueueModel *self,
+                             guint           version)
+{
+	self->synced = TRUE;
+
+	if (self->version != version) {
+		self->version = version;
+		g_object_notify_by_pspec(G_OBJECT(self), PROPERTIES[PROP_VERSION]);
+	}
+}
+
+/* A round started by a single update can be cancelled by it, rounds
+ * shared by several updates run to the end.
+ */
+static GCancellable *
+gmpd_queue_model_get_cancellable(GMpdQueueModel *self)
+{
+	if (self->running->len != 1)
+		return NULL;
+
+	return g_task_get_cancellable(g_ptr_array_index(self->running, 0));
+}
+
+static void
+gmpd_queue_model_send_changes(GMpdQueueModel *self)
+{
+	GMpdBatch *batch = gmpd_batch_new();
+
+	gmpd_batch_add_status(batch);
+
+	if (self->synced)
+		gmpd_batch_add_task(batch, gmpd_protocol_plchanges(self->version));
+	else
+		gmpd_batch_add_task(batch, gmpd_protocol_playlistinfo());
+
+	gmpd_client_batch_async(self->client,
+	                        batch,
+	                        gmpd_queue_model_get_cancellable(self),
+	                        on_changes_ready,
+	                        g_object_ref(self));
+
+	g_object_unref(batch);
+}
+
+static void
+gmpd_queue_model_start_round(GMpdQueueModel *self)
+{
+	guint i;
+
+	for (i = 0; i < self->waiting->len; i++)
+		g_ptr_array_add(self->running, g_object_ref(g_ptr_array_index(self->waiting, i)));
+
+	g_ptr_array_set_size(self->waiting, 0);
+
+	gmpd_queue_model_send_changes(self);
+}
+
+static void
+gmpd_queue_model_finish_round(GMpdQueueModel *self,
+                              GError         *error)
+{
+	GPtrArray *running;
+	guint i;
+
+	running = g_steal_pointer(&self->running);
+	self->running = g_ptr_array_new_with_free_func(g_object_unref);
+
+	for (i = 0; i < running->len; i++) {
+		GTask *task = g_ptr_array_index(running, i);
+
+		if (error)
+			g_task_return_error(task, g_error_copy(error));
+		else
+			g_task_return_boolean(task, TRUE);
+	}
+
+	g_ptr_array_unref(running);
+	g_clear_error(&error);
+
+	if (self->waiting->len)
+		gmpd_queue_model_start_round(self);
+}
+
+/* songs holds borrowed references and is consumed. The range between
+ * the unchanged head and tail is what gets replaced, and when its length
+ * stays the same only the runs of songs that differ are signalled.
+ */
+static void
+gmpd_queue_model_replace(GMpdQueueModel *self,
+                         GPtrArray      *songs)
+{
+	gpointer *old_songs = self->songs->pdata;
+	guint old_len = self->songs->len;
+	guint new_len = songs->len;
+	guint prefix;
+	guint suffix;
+	guint removed;
+	guint added;
+	guint i;
+
+	for (prefix = 0; prefix < MIN(old_len, new_len); prefix++) {
+		if (old_songs[prefix] != songs->pdata[prefix])
+			break;
+	}
+
+	for (suffix = 0; suffix < MIN(old_len, new_len) - prefix; suffix++) {
+		if (old_songs[old_len - suffix - 1] != songs->pdata[new_len - suffix - 1])
+			break;
+	}
+
+	removed = old_len - prefix - suffix;
+	added = new_len - prefix - suffix;
+
+	for (i = prefix; i < new_len; i++)
+		gmpd_song_set_position(g_ptr_array_index(songs, i), i);
+
+	if (removed != added) {
+		for (i = 0; i < new_len; i++)
+			g_object_ref(g_ptr_array_index(songs, i));
+
+		g_ptr_array_set_free_func(songs, g_object_unref);
+		g_ptr_array_unref(self->songs);
+		self->songs = songs;
+
+		g_list_model_items_changed(G_LIST_MODEL(self), prefix, removed, added);
+		return;
+	}
+
+	i = prefix;
+
+	while (i < prefix + added) {
+		guint start;
+
+		if (old_songs[i] == songs->pdata[i]) {
+			i++;
+			continue;
+		}
+
+		for (start = i; i < prefix + added && old_songs[i] != songs->pdata[i]; i++) {
+			g_object_unref(old_songs[i]);
+			old_songs[i] = g_object_ref(songs->pdata[i]);
+		}
+
+		g_list_model_items_changed(G_LIST_MODEL(self), start, i - start, i - start);
+	}
+
+	g_ptr_array_unref(songs);
+}
+
+static void
+gmpd_queue_model_apply_songs(GMpdQueueModel *self,
+                             GPtrArray      *entities)
+{
+	GPtrArray *songs;
+	guint i;
+
+	songs = g_ptr_array_sized_new(entities->len);
+
+	for (i = 0; i < entities->len; i++) {
+		gpointer entity = g_ptr_array_index(entities, i);
+
+		if (GMPD_IS_SONG(entity))
+			g_ptr_array_add(songs, entity);
+	}
+
+	gmpd_queue_model_replace(self, songs);
+}
+
+static gboolean
+format_equal(GMpdAudioFormat *a,
+             GMpdAudioFormat *b)
+{
+	if (!a || !b)
+		return a == b;
+
+	return gmpd_audio_format_get_sample_rate(a) == gmpd_audio_format_get_sample_rate(b) &&
+	       gmpd_audio_format_get_bit_depth(a) == gmpd_audio_format_get_bit_depth(b) &&
+	       gmpd_audio_format_get_channels(a) == gmpd_audio_format_get_channels(b);
+}
+
+/* Everything but the position, which is what plchanges reports for
+ * songs that only moved.
+ */
+static gboolean
+song_equal(GMpdSong *a,
+           GMpdSong *b)
+{
+	GMpdEntity *entity_a = GMPD_ENTITY(a);
+	GMpdEntity *entity_b = GMPD_ENTITY(b);
+	GMpdAudioFormat *format_a;
+	GMpdAudioFormat *format_b;
+	gboolean equal;
+	GMpdTag tag;
+
+	if (gmpd_song_get_id(a) != gmpd_song_get_id(b) ||
+	    gmpd_song_get_priority(a) != gmpd_song_get_priority(b) ||
+	    gmpd_song_get_duration(a) != gmpd_song_get_duration(b) ||
+	    gmpd_song_get_range_start(a) != gmpd_song_get_range_start(b) ||
+	    gmpd_song_get_range_end(a) != gmpd_song_get_range_end(b) ||
+	    g_strcmp0(entity_a->path, entity_b->path) != 0)
+		return FALSE;
+
+	if (!entity_a->last_modified || !entity_b->last_modified) {
+		if (entity_a->last_modified != entity_b->last_modified)
+			return FALSE;
+	} else if (!g_date_time_equal(entity_a->last_modified, entity_b->last_modified)) {
+		return FALSE;
+	}
+
+	format_a = gmpd_song_get_format(a);
+	format_b = gmpd_song_get_format(b);
+	equal = format_equal(format_a, format_b);
+	g_clear_object(&format_a);
+	g_clear_object(&format_b);
+
+	if (!equal)
+		return FALSE;
+
+	for (tag = 0; tag < GMPD_N_TAGS; tag++) {
+		const gchar *value;
+		guint i;
+
+		for (i = 0; (value = gmpd_song_peek_tag(a, tag, i)); i++) {
+			if (g_strcmp0(value, gmpd_song_peek_tag(b, tag, i)) != 0)
+				return FALSE;
+		}
+
+		if (gmpd_song_peek_tag(b, tag, i))
+			return FALSE;
+	}
+
+	return TRUE;
+}
+
+/* entities holds the songs at the positions that changed, the rest is
+ * kept from the model. plchanges also reports every song that only
+ * moved, those keep their old object so that replacing the list only
+ * signals the songs that were really added or removed. If a position is
+ * left without a song, the changes did not fit the model and nothing is
+ * applied.
+ */
+static gboolean
+gmpd_queue_model_apply_changes(GMpdQueueModel *self,
+                               GPtrArray      *entities,
+                               guint           length)
+{
+	GHashTable *ids;
+	GPtrArray *songs;
+	guint i;
+
+	ids = g_hash_table_new(NULL, NULL);
+	songs = g_ptr_array_sized_new(length);
+	g_ptr_array_set_size(songs, length);
+
+	for (i = 0; i < self->songs->len; i++) {
+		GMpdSong *song = g_ptr_array_index(self->songs, i);
+
+		g_hash_table_insert(ids, GUINT_TO_POINTER(gmpd_song_get_id(song)), song);
+
+		if (i < length)
+			songs->pdata[i] = song;
+	}
+
+	for (i = 0; i < entities->len; i++) {
+		gpointer entity = g_ptr_array_index(entities, i);
+		GMpdSong *old_song;
+		guint position;
+
+		if (!GMPD_IS_SONG(entity))
+			continue;
+
+		position = gmpd_song_get_position(entity);
+		if (position >= length)
+			continue;
+
+		old_song = g_hash_table_lookup(ids, GUINT_TO_POINTER(gmpd_song_get_id(entity)));
+
+		if (old_song && song_equal(old_song, entity))
+			songs->pdata[position] = old_song;
+		else
+			songs->pdata[position] = entity;
+	}
+
+	g_hash_table_unref(ids);
+
+	for (i = 0; i < songs->len; i++) {
+		if (!songs->pdata[i]) {
+			g_ptr_array_unref(songs);
+			return FALSE;
+		}
+	}
+
+	gmpd_queue_model_replace(self, songs);
+
+	return TRUE;
+}
+
+static void
+on_changes_ready(GObject      *source_object,
+                 GAsyncResult *result,
+                 gpointer      user_data)
+{
+	GMpdQueueModel *self = user_data;
+	GMpdBatch *batch;
+	GMpdStatus *status;
+	GMpdEntityList *changes;
+	GPtrArray *entities;
+	guint version;
+	guint length;
+	GError *error = NULL;
+
+	batch = gmpd_client_finish_batch_response(GMPD_CLIENT(source_object), result, &error);
+	if (!batch) {
+		gmpd_queue_model_finish_round(self, error);
+		g_object_unref(self);
+		return;
+	}
+
+	status = gmpd_batch_get_response(batch, 0);
+	changes = gmpd_batch_get_response(batch, 1);
+	entities = gmpd_entity_list_steal_entities(changes);
+
+	version = gmpd_status_get_queue_version(status);
+	length = gmpd_status_get_queue_length(status);
+
+	if (!self->synced) {
+		gmpd_queue_model_apply_songs(self, entities);
+		gmpd_queue_model_set_version(self, version);
+		gmpd_queue_model_finish_round(self, NULL);
+
+	} else if (version < self->version) {
+		/* the server was restarted */
+		self->synced = FALSE;
+		gmpd_queue_model_send_changes(self);
+
+	} else if (gmpd_queue_model_apply_changes(self, entities, length)) {
+		gmpd_queue_model_set_version(self, version);
+		gmpd_queue_model_finish_round(self, NULL);
+
+	} else {
+		self->synced = FALSE;
+		gmpd_queue_model_send_changes(self);
+	}
+
+	g_ptr_array_unref(entities);
+	g_clear_object(&status);
+	g_clear_object(&changes);
+	g_object_unref(batch);
+	g_object_unref(self);
+}
@@ -0,0 +1,71 @@
+/* libgmpd: MPD protocol implementation for GLib
+ * Copyright (C) 2020 Patrick Keating <binarydrifter@protonmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef __GMPD_QUEUE_MODEL_H__
+#define __GMPD_QUEUE_MODEL_H__
+
+#if !defined(__GMPD_H_INSIDE__) && !defined(__GMPD_BUILD__)
+#   error "Only <gmpd.h> can be included directly."
+#endif
+
+#include <gio/gio.h>
+#include <gmpd-client.h>
+
+G_BEGIN_DECLS
+
+#define GMPD_TYPE_QUEUE_MODEL \
+	(gmpd_queue_model_get_type())
+
+#define GMPD_QUEUE_MODEL(inst) \
+	(G_TYPE_CHECK_INSTANCE_CAST((inst), GMPD_TYPE_QUEUE_MODEL, GMpdQueueModel))
+
+#define GMPD_QUEUE_MODEL_CLASS(klass) \
+	(G_TYPE_CHECK_CLASS_CAST((klass), GMPD_TYPE_QUEUE_MODEL, GMpdQueueModelClass))
+
+#define GMPD_IS_QUEUE_MODEL(inst) \
+	(G_TYPE_CHECK_INSTANCE_TYPE((inst), GMPD_TYPE_QUEUE_MODEL))
+
+#define GMPD_IS_QUEUE_MODEL_CLASS(klass) \
+	(G_TYPE_CHECK_CLASS_TYPE((klass), GMPD_TYPE_QUEUE_MODEL))
+
+#define GMPD_QUEUE_MODEL_GET_CLASS(inst) \
+	(G_TYPE_INSTANCE_GET_CLASS((inst), GMPD_TYPE_QUEUE_MODEL, GMpdQueueModelClass))
+
+typedef struct _GMpdQueueModel      GMpdQueueModel;
+typedef struct _GMpdQueueModelClass GMpdQueueModelClass;
+
+GType             gmpd_queue_model_get_type       (void);
+
+GMpdQueueModel *  gmpd_queue_model_new            (GMpdClient          *client);
+
+void              gmpd_queue_model_update_async   (GMpdQueueModel      *self,
+                                                   GCancellable        *cancellable,
+                                                   GAsyncReadyCallback  callback,
+                                                   gpointer             user_data);
+
+gboolean          gmpd_queue_model_update_finish  (GMpdQueueModel      *self,
+                                                   GAsyncResult        *result,
+                                                   GError             **error);
+
+GMpdClient *      gmpd_queue_model_get_client     (GMpdQueueModel      *self);
+guint             gmpd_queue_model_get_version    (GMpdQueueModel      *self);
+
+G_END_DECLS
+
+#endif /* __GMPD_QUEUE_MODEL_H__ */
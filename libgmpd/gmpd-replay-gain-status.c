@@ -53,7 +53,9 @@ gmpd_replay_gain_status_feed_pair(GMpdResponse *response,
 	GMpdReplayGainStatus *self = GMPD_REPLAY_GAIN_STATUS(response);
 
 	if (g_strcmp0(key, "replay_gain_mode") == 0) {
-		gmpd_replay_gain_status_set_mode(self, gmpd_replay_gain_mode_from_string(value));
+		self->mode = gmpd_replay_gain_mode_from_string(value);
+		if (!GMPD_IS_REPLAY_GAIN_MODE(self->mode))
+			self->mode = GMPD_REPLAY_GAIN_OFF;
 	} else {
 		g_warning("invalid key: %s", key);
 	}
@@ -16,29 +16,20 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
  */
 
+#include <string.h>
 #include <gio/gio.h>
 #include "gmpd-error.h"
+#include "gmpd-input-buffer.h"
 #include "gmpd-response.h"
 #include "gmpd-version.h"
 
 static void gmpd_response_default_init(GMpdResponseIface *iface);
 
-static void gmpd_response_feed_pair(GMpdResponse *self,
-                                    GMpdVersion  *version,
-                                    const gchar  *key,
-                                    const gchar  *value);
-
-static void gmpd_response_feed_binary(GMpdResponse *self,
-                                      GMpdVersion  *version,
-                                      GBytes       *binary);
-
-static gsize gmpd_response_get_remaining_binary(GMpdResponse *self);
-
-static gboolean deserialize_binary(GMpdResponse *self,
-                                   GMpdVersion  *version,
-                                   GInputStream *input_stream,
-                                   GCancellable *cancellable,
-                                   GError      **error);
+static gboolean deserialize_binary(GMpdResponse    *self,
+                                   GMpdVersion     *version,
+                                   GMpdInputBuffer *buffer,
+                                   GCancellable    *cancellable,
+                                   GError         **error);
 
 G_DEFINE_INTERFACE(GMpdResponse, gmpd_response, G_TYPE_OBJECT)
 
@@ -65,15 +56,30 @@ gmpd_response_default_get_remaining_binary(GMpdResponse *self G_GNUC_UNUSED)
 	return 0;
 }
 
+static gboolean
+gmpd_response_default_feed_list_ok(GMpdResponse *self    G_GNUC_UNUSED,
+                                   GMpdVersion  *version G_GNUC_UNUSED)
+{
+	return TRUE;
+}
+
+static void
+gmpd_response_default_finish(GMpdResponse *self    G_GNUC_UNUSED,
+                             GMpdVersion  *version G_GNUC_UNUSED)
+{
+}
+
 static void
 gmpd_response_default_init(GMpdResponseIface *iface)
 {
 	iface->feed_pair = gmpd_response_default_feed_pair;
 	iface->feed_binary = gmpd_response_default_feed_binary;
 	iface->get_remaining_binary = gmpd_response_default_get_remaining_binary;
+	iface->feed_list_ok = gmpd_response_default_feed_list_ok;
+	iface->finish = gmpd_response_default_finish;
 }
 
-static void
+void
 gmpd_response_feed_pair(GMpdResponse *self,
                         GMpdVersion  *version,
                         const gchar  *key,
@@ -93,7 +99,7 @@ gmpd_response_feed_pair(GMpdResponse *self,
 	iface->feed_pair(self, version, key, value);
 }
 
-static void
+void
 gmpd_response_feed_binary(GMpdResponse *self,
                           GMpdVersion  *version,
                           GBytes       *binary)
@@ -111,7 +117,7 @@ gmpd_response_feed_binary(GMpdResponse *self,
 	iface->feed_binary(self, version, binary);
 }
 
-static gsize
+gsize
 gmpd_response_get_remaining_binary(GMpdResponse *self)
 {
 	GMpdResponseIface *iface;
@@ -125,30 +131,69 @@ gmpd_response_get_remaining_binary(GMpdResponse *self)
 	return iface->get_remaining_binary(self);
 }
 
+gboolean
+gmpd_response_feed_list_ok(GMpdResponse *self,
+                           GMpdVersion  *version)
+{
+	GMpdResponseIface *iface;
+
+	g_return_val_if_fail(GMPD_IS_RESPONSE(self), TRUE);
+	g_return_val_if_fail(GMPD_IS_VERSION(version), TRUE);
+
+	iface = GMPD_RESPONSE_GET_IFACE(self);
+
+	g_return_val_if_fail(iface->feed_list_ok != NULL, TRUE);
+
+	return iface->feed_list_ok(self, version);
+}
+
+/* Called once the whole response has been fed, so responses that hold
+ * on to a partial item can complete it.
+ */
+void
+gmpd_response_finish(GMpdResponse *self,
+                     GMpdVersion  *version)
+{
+	GMpdResponseIface *iface;
+
+	g_return_if_fail(GMPD_IS_RESPONSE(self));
+	g_return_if_fail(GMPD_IS_VERSION(version));
+
+	iface = GMPD_RESPONSE_GET_IFACE(self);
+
+	g_return_if_fail(iface->finish != NULL);
+
+	iface->finish(self, version);
+}
+
 static gboolean
-deserialize_binary(GMpdResponse *self,
-                   GMpdVersion  *version,
-                   GInputStream *input_stream,
-                   GCancellable *cancellable,
-                   GError      **error)
+deserialize_binary(GMpdResponse    *self,
+                   GMpdVersion     *version,
+                   GMpdInputBuffer *buffer,
+                   GCancellable    *cancellable,
+                   GError         **error)
 {
 	gsize remaining;
 
 	g_return_val_if_fail(GMPD_IS_RESPONSE(self), FALSE);
 	g_return_val_if_fail(GMPD_IS_VERSION(version), FALSE);
-	g_return_val_if_fail(G_IS_INPUT_STREAM(input_stream), FALSE);
+	g_return_val_if_fail(buffer != NULL, FALSE);
 	g_return_val_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable), FALSE);
 	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
 
 	remaining = gmpd_response_get_remaining_binary(self);
 	while (remaining) {
-		GBytes *bytes = g_input_stream_read_bytes(input_stream,
-		                                          remaining,
-		                                          cancellable,
-		                                          error);
-		if (!bytes)
+		const guint8 *data;
+		GBytes *bytes;
+		gsize length;
+
+		data = gmpd_input_buffer_read_bytes(buffer, remaining, &length, cancellable, error);
+		if (!data)
 			return FALSE;
 
+		/* data points into the input buffer, responses copy what they
+		 * need out of it instead of keeping a reference */
+		bytes = g_bytes_new_static(data, length);
 		gmpd_response_feed_binary(self, version, bytes);
 		g_bytes_unref(bytes);
 
@@ -159,22 +204,22 @@ deserialize_binary(GMpdResponse *self,
 }
 
 gboolean
-gmpd_response_deserialize(GMpdResponse     *self,
-                          GMpdVersion      *version,
-                          GDataInputStream *data_stream,
-                          GCancellable     *cancellable,
-                          GError          **error)
+gmpd_response_deserialize(GMpdResponse    *self,
+                          GMpdVersion     *version,
+                          GMpdInputBuffer *buffer,
+                          GCancellable    *cancellable,
+                          GError         **error)
 {
 	g_return_val_if_fail(GMPD_IS_RESPONSE(self), FALSE);
 	g_return_val_if_fail(GMPD_IS_VERSION(version), FALSE);
-	g_return_val_if_fail(G_IS_DATA_INPUT_STREAM(data_stream), FALSE);
+	g_return_val_if_fail(buffer != NULL, FALSE);
 	g_return_val_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable), FALSE);
 	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
 
 	while (TRUE) {
 		gboolean result;
 		gchar *line;
-		gchar **parts;
+		gchar *separator;
 
 		/* On the start of the first loop, we may be reentering the
 		 * function after a G_IO_ERROR_WOULD_BLOCK. On all subsequent
@@ -182,55 +227,56 @@ gmpd_response_deserialize(GMpdResponse     *self,
 		 * a key of 'binary', In either case, we need to receive
 		 * the binary data before continuing reading utf8 encoded data.
 		 */
-		result = deserialize_binary(self,
-		                            version,
-		                            G_INPUT_STREAM(data_stream),
-		                            cancellable,
-		                            error);
+		result = deserialize_binary(self, version, buffer, cancellable, error);
 		if (!result)
 			return FALSE;
 
-		line = g_data_input_stream_read_line_utf8(data_stream, NULL, cancellable, error);
-
+		/* line points into the input buffer and is only valid
+		 * until the next read from it */
+		line = gmpd_input_buffer_read_line(buffer, NULL, cancellable, error);
 		if (!line)
 			return FALSE;
 
 		/* check if the command has complete successfully */
-		if (!g_strcmp0(line, "OK") || !g_strcmp0(line, "list_OK")) {
-			g_free(line);
+		if (!strcmp(line, "OK")) {
+			gmpd_response_finish(self, version);
 			return TRUE;
 		}
 
+		/* inside a command list, list_OK only ends the response when
+		 * the response does not span several commands */
+		if (!strcmp(line, "list_OK")) {
+			if (gmpd_response_feed_list_ok(self, version)) {
+				gmpd_response_finish(self, version);
+				return TRUE;
+			}
+
+			continue;
+		}
+
 		/* check if the server has returned an ack error */
 		if (g_str_has_prefix(line, "ACK")) {
 			if (error)
 				*error = gmpd_error_from_string(line);
 
-			g_free(line);
 			return FALSE;
 		}
 
-		/* line should be a pair */
-		parts = g_strsplit(line, ": ", 2);
-		if (!parts || g_strv_length(parts) != 2) {
+		/* line should be a pair, split it in place */
+		separator = strstr(line, ": ");
+		if (!separator) {
 			g_set_error(error,
 			            G_IO_ERROR,
 			            G_IO_ERROR_INVALID_DATA,
 			            "invalid pair: %s",
 			            line);
 
-			g_strfreev(parts);
-			g_free(line);
-
 			return FALSE;
 		}
 
-		gmpd_response_feed_pair(self, version, parts[0], parts[1]);
-
-		g_strfreev(parts);
-		g_free(line);
+		*separator = '\0';
+		gmpd_response_feed_pair(self, version, line, separator + 2);
 	}
 
 	g_return_val_if_reached(FALSE);
 }
-
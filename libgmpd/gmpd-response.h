@@ -25,6 +25,7 @@
 
 #include <gio/gio.h>
 #include <gmpd-version.h>
+#include "gmpd-input-buffer.h"
 
 G_BEGIN_DECLS
 
@@ -44,6 +45,10 @@ typedef struct _GMpdResponse      GMpdResponse;
 typedef struct _GMpdResponseIface GMpdResponseIface;
 typedef GMpdResponseIface         GMpdResponseInterface;
 
+/* A response is private to the client until it has been parsed, nobody
+ * can be connected to it yet. Implementations therefore write their
+ * fields directly, without going through the notifying setters.
+ */
 struct _GMpdResponseIface {
 	GTypeInterface __base__;
 
@@ -57,15 +62,38 @@ struct _GMpdResponseIface {
 	                                         GBytes       *binary);
 
 	gsize          (*get_remaining_binary)  (GMpdResponse *self);
+
+	gboolean       (*feed_list_ok)          (GMpdResponse *self,
+	                                         GMpdVersion  *version);
+
+	void           (*finish)                (GMpdResponse *self,
+	                                         GMpdVersion  *version);
 };
 
-GType     gmpd_response_get_type     (void);
+GType     gmpd_response_get_type              (void);
+
+void      gmpd_response_feed_pair             (GMpdResponse     *self,
+                                               GMpdVersion      *version,
+                                               const gchar      *key,
+                                               const gchar      *value);
+
+void      gmpd_response_feed_binary           (GMpdResponse     *self,
+                                               GMpdVersion      *version,
+                                               GBytes           *binary);
+
+gsize     gmpd_response_get_remaining_binary  (GMpdResponse     *self);
+
+gboolean  gmpd_response_feed_list_ok          (GMpdResponse     *self,
+                                               GMpdVersion      *version);
+
+void      gmpd_response_finish                (GMpdResponse     *self,
+                                               GMpdVersion      *version);
 
-gboolean  gmpd_response_deserialize  (GMpdResponse     *self,
-                                      GMpdVersion      *version,
-                                      GDataInputStream *input_stream,
-                                      GCancellable     *cancellable,
-                                      GError          **error);
+gboolean  gmpd_response_deserialize           (GMpdResponse     *self,
+                                               GMpdVersion      *version,
+                                               GMpdInputBuffer  *buffer,
+                                               GCancellable     *cancellable,
+                                               GError          **error);
 
 G_END_DECLS
 
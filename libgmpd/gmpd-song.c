@@ -16,11 +16,13 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
  */
 
+#include <string.h>
 #include <gio/gio.h>
 
 #include "gmpd-audio-format.h"
 #include "gmpd-entity.h"
 #include "gmpd-entity-priv.h"
+#include "gmpd-key.h"
 #include "gmpd-response.h"
 #include "gmpd-song.h"
 #include "gmpd-tag.h"
@@ -28,6 +30,35 @@
 
 static void gmpd_song_response_iface_init(GMpdResponseIface *iface);
 static void gmpd_song_tag_changed(GMpdSong *self, GMpdTag tag);
+static void gmpd_song_append_tag(GMpdSong *self, GMpdTag tag, const gchar *value);
+static void gmpd_song_remove_tag(GMpdSong *self, GMpdTag tag);
+
+/* The tag values of a song are packed into a single block. The values
+ * come first, each terminated by a NUL, followed by one TagEntry per
+ * value at the next 4 byte boundary. Values of the same tag are kept
+ * in the order they were added.
+ *
+ * Values of tags that repeat across a library, like the artist, are
+ * interned instead. The block then holds a pointer to the interned
+ * GRefString in place of the value, so songs share a single copy and
+ * their values can be compared by pointer.
+ */
+typedef struct _TagEntry {
+	guint32 tag      : 7;
+	guint32 interned : 1;
+	guint32 offset   : 24;
+} TagEntry;
+
+#define TAG_MAX_OFFSET ((1u << 24) - 1)
+
+#define TAG_ENTRIES_OFFSET(tags_len) \
+	(((tags_len) + 3) & ~(gsize) 3)
+
+#define TAG_ENTRIES(tags, tags_len) \
+	((TagEntry *) ((tags) + TAG_ENTRIES_OFFSET(tags_len)))
+
+static const gchar *tag_entry_get_value(const guint8 *tags, TagEntry entry);
+static void tags_free(guint8 *tags, guint32 tags_len, guint16 n_tags);
 
 enum {
 	PROP_NONE,
@@ -55,7 +86,10 @@ struct _GMpdSong {
 	float            range_start;
 	float            range_end;
 	GMpdAudioFormat *format;
-	GPtrArray       *tags[GMPD_N_TAGS];
+	guint8          *tags;
+	guint32          tags_len;
+	guint32          tags_size;
+	guint16          n_tags;
 };
 
 struct _GMpdSongClass {
@@ -78,7 +112,8 @@ gmpd_song_response_feed_pair(GMpdResponse *response,
                              const gchar  *value)
 {
 	GMpdSong *self;
-	GMpdTag tag;
+	GMpdEntity *entity;
+	GMpdKey song_key;
 
 	g_return_if_fail(GMPD_IS_SONG(response));
 	g_return_if_fail(GMPD_IS_VERSION(version));
@@ -86,62 +121,84 @@ gmpd_song_response_feed_pair(GMpdResponse *response,
 	g_return_if_fail(value != NULL);
 
 	self = GMPD_SONG(response);
+	entity = GMPD_ENTITY(response);
+	song_key = gmpd_key_from_string(key);
 
-	if (!g_strcmp0(key, "file")) {
-		gmpd_entity_set_path(GMPD_ENTITY(self), value);
+	if (GMPD_KEY_IS_TAG(song_key)) {
+		gmpd_song_append_tag(self, (GMpdTag) song_key, value);
+		return;
+	}
 
-	} else if (!g_strcmp0(key, "Last-Modified")) {
-		GDateTime *last_modified = g_date_time_new_from_iso8601(value, NULL);
-		gmpd_entity_set_last_modified(GMPD_ENTITY(self), last_modified);
-		g_clear_pointer(&last_modified, g_date_time_unref);
+	switch (song_key) {
+	case GMPD_KEY_FILE:
+		g_free(entity->path);
+		entity->path = g_strdup(value);
+		break;
 
-	} else if (!g_strcmp0(key, "Pos")) {
-		gmpd_song_set_position(self, g_ascii_strtoull(value, NULL, 10));
+	case GMPD_KEY_LAST_MODIFIED:
+		g_clear_pointer(&entity->last_modified, g_date_time_unref);
+		entity->last_modified = g_date_time_new_from_iso8601(value, NULL);
+		break;
 
-	} else if (!g_strcmp0(key, "Id")) {
-		gmpd_song_set_id(self, g_ascii_strtoull(value, NULL, 10));
+	case GMPD_KEY_POS:
+		self->position = g_ascii_strtoull(value, NULL, 10);
+		break;
 
-	} else if (!g_strcmp0(key, "Prio")) {
-		gmpd_song_set_priority(self, g_ascii_strtoull(value, NULL, 10));
+	case GMPD_KEY_ID:
+		self->id = g_ascii_strtoull(value, NULL, 10);
+		break;
 
-	} else if (!g_strcmp0(key, "Time") && !self->duration) {
-		gmpd_song_set_duration(self, g_ascii_strtod(value, NULL));
+	case GMPD_KEY_PRIO:
+		self->priority = g_ascii_strtoull(value, NULL, 10);
+		break;
+
+	case GMPD_KEY_SONG_TIME:
+		if (!self->duration)
+			self->duration = g_ascii_strtod(value, NULL);
+		break;
 
-	} else if (!g_strcmp0(key, "duration")) {
-		gmpd_song_set_duration(self, g_ascii_strtod(value, NULL));
+	case GMPD_KEY_DURATION:
+		self->duration = g_ascii_strtod(value, NULL);
+		break;
 
-	} else if (!g_strcmp0(key, "Range")) {
+	case GMPD_KEY_RANGE: {
 		gchar **parts = g_strsplit(value, "-", 2);
 		if (!parts || g_strv_length(parts) != 2) {
-			gmpd_song_set_range_start(self, 0);
-			gmpd_song_set_range_end(self, 0);
+			self->range_start = 0;
+			self->range_end = 0;
 
 		} else {
-			gmpd_song_set_range_start(self, g_ascii_strtod(parts[0], NULL));
-			gmpd_song_set_range_end(self, g_ascii_strtod(parts[1], NULL));
+			self->range_start = g_ascii_strtod(parts[0], NULL);
+			self->range_end = g_ascii_strtod(parts[1], NULL);
 		}
 
 		g_strfreev(parts);
+		break;
+	}
 
-	} else if (!g_strcmp0(key, "Format")) {
-		GMpdAudioFormat *format = gmpd_audio_format_new_from_string(value);
-		gmpd_song_set_format(self, format);
-		g_clear_object(&format);
-
-	} else if ((tag = gmpd_tag_from_string(key)) != GMPD_TAG_UNKNOWN) {
-		if (!self->tags[tag]) {
-			self->tags[tag] = g_ptr_array_new_full(2, g_free);
-			g_ptr_array_add(self->tags[tag], NULL);
-		}
+	case GMPD_KEY_FORMAT:
+		g_clear_object(&self->format);
+		self->format = gmpd_audio_format_new_from_string(value);
+		break;
 
-		g_ptr_array_remove(self->tags[tag], NULL);
-		g_ptr_array_add(self->tags[tag], g_strdup(value));
-		g_ptr_array_add(self->tags[tag], NULL);
+	default:
+		g_warning("%s: unknown key: %s", __func__, key);
+	}
+}
 
-		gmpd_song_tag_changed(self, tag);
+/* The tag block grows geometrically while it is parsed, the slack is
+ * given back once the song is complete.
+ */
+static void
+gmpd_song_response_finish(GMpdResponse *response,
+                          GMpdVersion  *version G_GNUC_UNUSED)
+{
+	GMpdSong *self = GMPD_SONG(response);
+	gsize size = TAG_ENTRIES_OFFSET(self->tags_len) + self->n_tags * sizeof(TagEntry);
 
-	} else {
-		g_warning("%s: unknown key: %s", __func__, key);
+	if (self->tags && size < self->tags_size) {
+		self->tags = g_realloc(self->tags, size);
+		self->tags_size = size;
 	}
 }
 
@@ -149,6 +206,7 @@ static void
 gmpd_song_response_iface_init(GMpdResponseIface *iface)
 {
 	iface->feed_pair = gmpd_song_response_feed_pair;
+	iface->finish = gmpd_song_response_finish;
 }
 
 static void
@@ -252,12 +310,9 @@ static void
 gmpd_song_finalize(GObject *object)
 {
 	GMpdSong *self = GMPD_SONG(object);
-	gsize i;
 
 	g_clear_object(&self->format);
-
-	for (i = 0; i < GMPD_N_TAGS; i++)
-		g_clear_pointer(&self->tags[i], g_ptr_array_unref);
+	tags_free(self->tags, self->tags_len, self->n_tags);
 
 	G_OBJECT_CLASS(gmpd_song_parent_class)->finalize(object);
 }
@@ -360,8 +415,6 @@ gmpd_song_class_init(GMpdSongClass *klass)
 static void
 gmpd_song_init(GMpdSong *self)
 {
-	size_t i;
-
 	self->position = 0;
 	self->id = 0;
 	self->priority = 0;
@@ -369,9 +422,10 @@ gmpd_song_init(GMpdSong *self)
 	self->range_start = 0;
 	self->range_end = 0;
 	self->format = NULL;
-
-	for (i = 0; i < GMPD_N_TAGS; i++)
-		self->tags[i] = NULL;
+	self->tags = NULL;
+	self->tags_len = 0;
+	self->tags_size = 0;
+	self->n_tags = 0;
 }
 
 GMpdSong *
@@ -471,31 +525,15 @@ gmpd_song_set_tag(GMpdSong           *self,
                   GMpdTag             tag,
                   const gchar *const *values)
 {
-	gsize values_len;
-	GPtrArray *new_tag;
 	gsize i;
 
 	g_return_if_fail(GMPD_IS_SONG(self));
 	g_return_if_fail(GMPD_TAG_IS_VALID(tag));
 
-	if (!values || !values[0]) {
-		g_clear_pointer(&self->tags[tag], g_ptr_array_unref);
-		gmpd_song_tag_changed(self, tag);
-		return;
-	}
+	gmpd_song_remove_tag(self, tag);
 
-	values_len = g_strv_length((gchar **)values);
-	new_tag = g_ptr_array_new_full(values_len, g_free);
-
-	for (i = 0; i < values_len; i++) {
-		gchar *s = g_strdup(values[i]);
-		g_ptr_array_add(new_tag, s);
-	}
-
-	g_ptr_array_add(new_tag, NULL);
-
-	g_clear_pointer(&self->tags[tag], g_ptr_array_unref);
-	self->tags[tag] = new_tag;
+	for (i = 0; values && values[i]; i++)
+		gmpd_song_append_tag(self, tag, values[i]);
 
 	gmpd_song_tag_changed(self, tag);
 }
@@ -553,12 +591,178 @@ gchar **
 gmpd_song_get_tag(GMpdSong *self,
                   GMpdTag   tag)
 {
+	TagEntry *entries;
+	gchar **values;
+	guint n_values = 0;
+	guint i;
+
 	g_return_val_if_fail(GMPD_IS_SONG(self), NULL);
 	g_return_val_if_fail(GMPD_TAG_IS_VALID(tag), NULL);
 
-	if (!self->tags[tag] || !self->tags[tag]->len)
+	entries = TAG_ENTRIES(self->tags, self->tags_len);
+
+	for (i = 0; i < self->n_tags; i++)
+		n_values += entries[i].tag == tag;
+
+	if (!n_values)
 		return NULL;
 
-	return g_strdupv((gchar **)self->tags[tag]->pdata);
+	values = g_new(gchar *, n_values + 1);
+	n_values = 0;
+
+	for (i = 0; i < self->n_tags; i++) {
+		if (entries[i].tag == tag)
+			values[n_values++] = g_strdup(tag_entry_get_value(self->tags, entries[i]));
+	}
+
+	values[n_values] = NULL;
+
+	return values;
+}
+
+/* Unlike gmpd_song_get_tag(), this does not copy anything. The value is
+ * only valid until any tag of the song is changed. Values of shared
+ * tags such as the artist are interned, so equal values are the same
+ * pointer.
+ */
+const gchar *
+gmpd_song_peek_tag(GMpdSong *self,
+                   GMpdTag   tag,
+                   guint     index)
+{
+	TagEntry *entries;
+	guint i;
+
+	g_return_val_if_fail(GMPD_IS_SONG(self), NULL);
+	g_return_val_if_fail(GMPD_TAG_IS_VALID(tag), NULL);
+
+	entries = TAG_ENTRIES(self->tags, self->tags_len);
+
+	for (i = 0; i < self->n_tags; i++) {
+		if (entries[i].tag == tag && index-- == 0)
+			return tag_entry_get_value(self->tags, entries[i]);
+	}
+
+	return NULL;
+}
+
+static gboolean
+tag_is_shared(GMpdTag tag)
+{
+	switch (tag) {
+	case GMPD_TAG_TITLE:
+	case GMPD_TAG_TRACK:
+	case GMPD_TAG_NAME:
+	case GMPD_TAG_COMMENT:
+	case GMPD_TAG_DISC:
+	case GMPD_TAG_MUSICBRAINZ_TRACK_ID:
+	case GMPD_TAG_MUSICBRAINZ_RELEASE_TRACK_ID:
+		return FALSE;
+
+	default:
+		return TRUE;
+	}
+}
+
+static const gchar *
+tag_entry_get_value(const guint8 *tags,
+                    TagEntry      entry)
+{
+	const gchar *value;
+
+	if (!entry.interned)
+		return (const gchar *) tags + entry.offset;
+
+	memcpy(&value, tags + entry.offset, sizeof(value));
+
+	return value;
+}
+
+static void
+tags_free(guint8  *tags,
+          guint32  tags_len,
+          guint16  n_tags)
+{
+	TagEntry *entries = TAG_ENTRIES(tags, tags_len);
+	guint i;
+
+	for (i = 0; i < n_tags; i++) {
+		if (entries[i].interned)
+			g_ref_string_release((gchar *) tag_entry_get_value(tags, entries[i]));
+	}
+
+	g_free(tags);
+}
+
+/* The block is grown geometrically, so parsing a song does not realloc
+ * for every tag line. The entries are moved up past the new value
+ * first, then the value is copied to where they were.
+ */
+static void
+gmpd_song_append_tag(GMpdSong    *self,
+                     GMpdTag      tag,
+                     const gchar *value)
+{
+	gboolean interned = tag_is_shared(tag);
+	gsize value_len = interned ? sizeof(gchar *) : strlen(value) + 1;
+	gsize tags_len = self->tags_len + value_len;
+	TagEntry *entries;
+	gsize size;
+
+	if (tags_len > TAG_MAX_OFFSET || self->n_tags == G_MAXUINT16) {
+		g_warning("%s: too many tags, dropping a value", __func__);
+		return;
+	}
+
+	size = TAG_ENTRIES_OFFSET(tags_len) + (self->n_tags + 1) * sizeof(TagEntry);
+	if (size > self->tags_size) {
+		self->tags_size = MAX(size, MIN(2 * (gsize) self->tags_size, G_MAXUINT32));
+		self->tags = g_realloc(self->tags, self->tags_size);
+	}
+
+	entries = TAG_ENTRIES(self->tags, tags_len);
+	memmove(entries, TAG_ENTRIES(self->tags, self->tags_len), self->n_tags * sizeof(TagEntry));
+
+	if (interned) {
+		gchar *ref_string = g_ref_string_new_intern(value);
+		memcpy(self->tags + self->tags_len, &ref_string, value_len);
+	} else {
+		memcpy(self->tags + self->tags_len, value, value_len);
+	}
+
+	entries[self->n_tags].tag = tag;
+	entries[self->n_tags].interned = interned;
+	entries[self->n_tags].offset = self->tags_len;
+
+	self->tags_len = tags_len;
+	self->n_tags++;
+}
+
+static void
+gmpd_song_remove_tag(GMpdSong *self,
+                     GMpdTag   tag)
+{
+	guint8 *old_tags = self->tags;
+	guint32 old_len = self->tags_len;
+	guint16 old_n_tags = self->n_tags;
+	TagEntry *old_entries;
+	guint i;
+
+	self->tags = NULL;
+	self->tags_len = 0;
+	self->tags_size = 0;
+	self->n_tags = 0;
+
+	old_entries = TAG_ENTRIES(old_tags, old_len);
+
+	/* the values that are kept take their own reference */
+	for (i = 0; i < old_n_tags; i++) {
+		if (old_entries[i].tag != tag)
+			gmpd_song_append_tag(self,
+			                     old_entries[i].tag,
+			                     tag_entry_get_value(old_tags, old_entries[i]));
+	}
+
+	tags_free(old_tags, old_len, old_n_tags);
 }
 
@@ -92,6 +92,10 @@ GMpdAudioFormat *  gmpd_song_get_format       (GMpdSong           *self);
 gchar **           gmpd_song_get_tag          (GMpdSong           *self,
                                                GMpdTag             tag);
 
+const gchar *      gmpd_song_peek_tag         (GMpdSong           *self,
+                                               GMpdTag             tag,
+                                               guint               index);
+
 G_END_DECLS
 
 #endif /* __GMPD_SONG_H__ */
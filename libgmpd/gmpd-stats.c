@@ -17,6 +17,7 @@
  */
 
 #include <gio/gio.h>
+#include "gmpd-key.h"
 #include "gmpd-response.h"
 #include "gmpd-stats.h"
 
@@ -70,33 +71,40 @@ gmpd_stats_response_feed_pair(GMpdResponse *response,
 
 	self = GMPD_STATS(response);
 
-	if (g_strcmp0(key, "artists") == 0) {
-		gmpd_stats_set_artists(self, g_ascii_strtoull(value, NULL, 10));
+	switch (gmpd_key_from_string(key)) {
+	case GMPD_KEY_ARTISTS:
+		self->artists = g_ascii_strtoull(value, NULL, 10);
+		break;
 
-	} else if (g_strcmp0(key, "albums") == 0) {
-		gmpd_stats_set_albums(self, g_ascii_strtoull(value, NULL, 10));
+	case GMPD_KEY_ALBUMS:
+		self->albums = g_ascii_strtoull(value, NULL, 10);
+		break;
 
-	} else if (g_strcmp0(key, "songs") == 0) {
-		gmpd_stats_set_songs(self, g_ascii_strtoull(value, NULL, 10));
+	case GMPD_KEY_SONGS:
+		self->songs = g_ascii_strtoull(value, NULL, 10);
+		break;
 
-	} else if (g_strcmp0(key, "uptime") == 0) {
-		gmpd_stats_set_uptime(self, g_ascii_strtoull(value, NULL, 10));
+	case GMPD_KEY_UPTIME:
+		self->uptime = g_ascii_strtoull(value, NULL, 10);
+		break;
 
-	} else if (g_strcmp0(key, "db_playtime") == 0) {
-		gmpd_stats_set_db_playtime(self, g_ascii_strtoull(value, NULL, 10));
+	case GMPD_KEY_DB_PLAYTIME:
+		self->db_playtime = g_ascii_strtoull(value, NULL, 10);
+		break;
 
-	} else if (g_strcmp0(key, "db_update") == 0) {
+	case GMPD_KEY_DB_UPDATE: {
 		gint64 unix_utc = g_ascii_strtoll(value, NULL, 10);
-		GDateTime *db_update = g_date_time_new_from_unix_utc(unix_utc);
-
-		gmpd_stats_set_db_update(self, db_update);
 
-		g_clear_pointer(&db_update, g_date_time_unref);
+		g_clear_pointer(&self->db_update, g_date_time_unref);
+		self->db_update = g_date_time_new_from_unix_utc(unix_utc);
+		break;
+	}
 
-	} else if (g_strcmp0(key, "playtime") == 0) {
-		gmpd_stats_set_playtime(self, g_ascii_strtoull(value, NULL, 10));
+	case GMPD_KEY_PLAYTIME:
+		self->playtime = g_ascii_strtoull(value, NULL, 10);
+		break;
 
-	} else {
+	default:
 		g_warning("invalid key: %s", key);
 	}
 }
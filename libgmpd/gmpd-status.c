@@ -18,6 +18,7 @@
 
 #include <gio/gio.h>
 #include "gmpd-audio-format.h"
+#include "gmpd-key.h"
 #include "gmpd-playback-state.h"
 #include "gmpd-single-state.h"
 #include "gmpd-response.h"
@@ -54,6 +55,11 @@ enum {
 	N_PROPERTIES,
 };
 
+enum {
+	SIGNAL_UPDATED,
+	N_SIGNALS,
+};
+
 struct _GMpdStatus {
 	GObject           __base__;
 	gchar            *partition;
@@ -82,6 +88,7 @@ struct _GMpdStatus {
 
 struct _GMpdStatusClass {
 	GObjectClass __base__;
+	void       (*updated) (GMpdStatus *self);
 };
 
 G_DEFINE_TYPE_WITH_CODE(GMpdStatus, gmpd_status, G_TYPE_OBJECT,
@@ -90,6 +97,7 @@ G_DEFINE_TYPE_WITH_CODE(GMpdStatus, gmpd_status, G_TYPE_OBJECT,
 
 
 static GParamSpec *PROPERTIES[N_PROPERTIES] = {NULL};
+static guint SIGNALS[N_SIGNALS] = {0};
 
 static void
 gmpd_status_response_feed_pair(GMpdResponse *response,
@@ -106,76 +114,109 @@ gmpd_status_response_feed_pair(GMpdResponse *response,
 
 	self = GMPD_STATUS(response);
 
-	if (g_strcmp0(key, "partition") == 0) {
-		gmpd_status_set_partition(self, value);
+	switch (gmpd_key_from_string(key)) {
+	case GMPD_KEY_PARTITION:
+		g_free(self->partition);
+		self->partition = g_strdup(value);
+		break;
 
-	} else if (g_strcmp0(key, "volume") == 0) {
-		gmpd_status_set_volume(self, g_ascii_strtoll(value, NULL, 10));
+	case GMPD_KEY_VOLUME: {
+		gint64 volume = g_ascii_strtoll(value, NULL, 10);
+		self->volume = volume >= -1 && volume <= 100 ? volume : -1;
+		break;
+	}
 
-	} else if (g_strcmp0(key, "repeat") == 0) {
-		gmpd_status_set_repeat(self, !!g_ascii_strtoull(value, NULL, 10));
+	case GMPD_KEY_REPEAT:
+		self->repeat = !!g_ascii_strtoull(value, NULL, 10);
+		break;
 
-	} else if (g_strcmp0(key, "random") == 0) {
-		gmpd_status_set_random(self, !!g_ascii_strtoull(value, NULL, 10));
+	case GMPD_KEY_RANDOM:
+		self->random = !!g_ascii_strtoull(value, NULL, 10);
+		break;
 
-	} else if (g_strcmp0(key, "single") == 0) {
-		gmpd_status_set_single(self, gmpd_single_state_from_string(value));
+	case GMPD_KEY_SINGLE:
+		self->single = gmpd_single_state_from_string(value);
+		if (!GMPD_IS_SINGLE_STATE(self->single))
+			self->single = GMPD_SINGLE_DISABLED;
+		break;
 
-	} else if (g_strcmp0(key, "consume") == 0) {
-		gmpd_status_set_consume(self, !!g_ascii_strtoull(value, NULL, 10));
+	case GMPD_KEY_CONSUME:
+		self->consume = !!g_ascii_strtoull(value, NULL, 10);
+		break;
 
-	} else if (g_strcmp0(key, "playlist") == 0) {
-		gmpd_status_set_queue_version(self, g_ascii_strtoull(value, NULL, 10));
+	case GMPD_KEY_PLAYLIST:
+		self->queue_version = g_ascii_strtoull(value, NULL, 10);
+		break;
 
-	} else if (g_strcmp0(key, "playlistlength") == 0) {
-		gmpd_status_set_queue_length(self, g_ascii_strtoull(value, NULL, 10));
+	case GMPD_KEY_PLAYLIST_LENGTH:
+		self->queue_length = g_ascii_strtoull(value, NULL, 10);
+		break;
 
-	} else if (g_strcmp0(key, "state") == 0) {
-		gmpd_status_set_playback(self, gmpd_playback_state_from_string(value));
+	case GMPD_KEY_STATE:
+		self->playback = gmpd_playback_state_from_string(value);
+		if (!GMPD_IS_PLAYBACK_STATE(self->playback))
+			self->playback = GMPD_PLAYBACK_UNKNOWN;
+		break;
 
-	} else if (g_strcmp0(key, "song") == 0) {
-		gmpd_status_set_current_position(self, g_ascii_strtoull(value, NULL, 10));
+	case GMPD_KEY_SONG:
+		self->current_position = g_ascii_strtoull(value, NULL, 10);
+		break;
 
-	} else if (g_strcmp0(key, "songid") == 0) {
-		gmpd_status_set_current_id(self, g_ascii_strtoull(value, NULL, 10));
+	case GMPD_KEY_SONG_ID:
+		self->current_id = g_ascii_strtoull(value, NULL, 10);
+		break;
 
-	} else if (g_strcmp0(key, "nextsong") == 0) {
-		gmpd_status_set_next_position(self, g_ascii_strtoull(value, NULL, 10));
+	case GMPD_KEY_NEXT_SONG:
+		self->next_position = g_ascii_strtoull(value, NULL, 10);
+		break;
 
-	} else if (g_strcmp0(key, "nextsongid") == 0) {
-		gmpd_status_set_next_id(self, g_ascii_strtoull(value, NULL, 10));
+	case GMPD_KEY_NEXT_SONG_ID:
+		self->next_id = g_ascii_strtoull(value, NULL, 10);
+		break;
 
-	} else if (g_strcmp0(key, "time") == 0) {
+	case GMPD_KEY_TIME:
 		/* TODO */
+		break;
 
-	} else if (g_strcmp0(key, "elapsed") == 0) {
-		gmpd_status_set_current_elapsed(self, g_ascii_strtod(value, NULL));
+	case GMPD_KEY_ELAPSED:
+		self->current_elapsed = MAX(g_ascii_strtod(value, NULL), 0);
+		break;
 
-	} else if (g_strcmp0(key, "duration") == 0) {
-		gmpd_status_set_current_duration(self, g_ascii_strtod(value, NULL));
+	case GMPD_KEY_DURATION:
+		self->current_duration = MAX(g_ascii_strtod(value, NULL), 0);
+		break;
 
-	} else if (g_strcmp0(key, "bitrate") == 0) {
-		gmpd_status_set_bit_rate(self, g_ascii_strtoull(value, NULL, 10));
+	case GMPD_KEY_BITRATE:
+		self->bit_rate = g_ascii_strtoull(value, NULL, 10);
+		break;
 
-	} else if (g_strcmp0(key, "xfade") == 0) {
-		gmpd_status_set_crossfade(self, g_ascii_strtoull(value, NULL, 10));
+	case GMPD_KEY_XFADE:
+		self->crossfade = g_ascii_strtoull(value, NULL, 10);
+		break;
 
-	} else if (g_strcmp0(key, "mixrampdb") == 0) {
-		gmpd_status_set_mixramp_db(self, g_ascii_strtod(value, NULL));
+	case GMPD_KEY_MIXRAMP_DB:
+		self->mixramp_db = g_ascii_strtod(value, NULL);
+		break;
 
-	} else if (g_strcmp0(key, "mixrampdelay") == 0) {
-		gmpd_status_set_mixramp_delay(self, g_ascii_strtod(value, NULL));
+	case GMPD_KEY_MIXRAMP_DELAY:
+		self->mixramp_delay = MAX(g_ascii_strtod(value, NULL), 0);
+		break;
 
-	} else if (g_strcmp0(key, "audio") == 0) {
-		gmpd_status_set_audio_format(self, gmpd_audio_format_new_from_string(value));
+	case GMPD_KEY_AUDIO:
+		g_clear_object(&self->audio_format);
+		self->audio_format = gmpd_audio_format_new_from_string(value);
+		break;
 
-	} else if (g_strcmp0(key, "updating_db") == 0) {
-		gmpd_status_set_db_update_job_id(self, g_ascii_strtoull(value, NULL, 10));
+	case GMPD_KEY_UPDATING_DB:
+		self->db_update_job_id = g_ascii_strtoull(value, NULL, 10);
+		break;
 
-	} else if (g_strcmp0(key, "error") == 0) {
-		gmpd_status_set_error(self, value);
+	case GMPD_KEY_ERROR:
+		g_free(self->error);
+		self->error = g_strdup(value);
+		break;
 
-	} else {
+	default:
 		g_warning("invalid key: %s", key);
 	}
 }
@@ -616,6 +657,16 @@ gmpd_status_class_init(GMpdStatusClass *klass)
 		                    G_PARAM_STATIC_STRINGS);
 
 	g_object_class_install_properties(object_class, N_PROPERTIES, PROPERTIES);
+
+	SIGNALS[SIGNAL_UPDATED] =
+		g_signal_new("updated",
+		             GMPD_TYPE_STATUS,
+		             G_SIGNAL_RUN_LAST | G_SIGNAL_NO_RECURSE | G_SIGNAL_NO_HOOKS,
+		             G_STRUCT_OFFSET(GMpdStatusClass, updated),
+		             NULL, NULL,
+		             NULL,
+		             G_TYPE_NONE,
+		             0);
 }
 
 static void
@@ -651,6 +702,132 @@ gmpd_status_new(void)
 	return g_object_new(GMPD_TYPE_STATUS, NULL);
 }
 
+static void
+update_uint(GMpdStatus *self,
+            guint      *field,
+            guint       value,
+            guint       prop_id)
+{
+	if (*field != value) {
+		*field = value;
+		g_object_notify_by_pspec(G_OBJECT(self), PROPERTIES[prop_id]);
+	}
+}
+
+static void
+update_boolean(GMpdStatus *self,
+               gboolean   *field,
+               gboolean    value,
+               guint       prop_id)
+{
+	if (*field != value) {
+		*field = value;
+		g_object_notify_by_pspec(G_OBJECT(self), PROPERTIES[prop_id]);
+	}
+}
+
+static void
+update_float(GMpdStatus *self,
+             gfloat     *field,
+             gfloat      value,
+             guint       prop_id)
+{
+	if (*field != value) {
+		*field = value;
+		g_object_notify_by_pspec(G_OBJECT(self), PROPERTIES[prop_id]);
+	}
+}
+
+static void
+update_string(GMpdStatus   *self,
+              gchar       **field,
+              const gchar  *value,
+              guint         prop_id)
+{
+	if (g_strcmp0(*field, value) != 0) {
+		g_free(*field);
+		*field = g_strdup(value);
+		g_object_notify_by_pspec(G_OBJECT(self), PROPERTIES[prop_id]);
+	}
+}
+
+static gboolean
+audio_format_equal(GMpdAudioFormat *a,
+                   GMpdAudioFormat *b)
+{
+	if (!a || !b)
+		return a == b;
+
+	return gmpd_audio_format_get_sample_rate(a) == gmpd_audio_format_get_sample_rate(b) &&
+	       gmpd_audio_format_get_bit_depth(a) == gmpd_audio_format_get_bit_depth(b) &&
+	       gmpd_audio_format_get_channels(a) == gmpd_audio_format_get_channels(b);
+}
+
+/* Copies every field of status that differs into self, so only the
+ * properties that really changed are notified, and only once all of
+ * them hold their new value. A status parsed from a response has the
+ * fields the server left out at their defaults, so those are reset.
+ * "updated" is emitted last, even if nothing changed, since the status
+ * was still sampled again.
+ */
+void
+gmpd_status_update(GMpdStatus *self,
+                   GMpdStatus *status)
+{
+	g_return_if_fail(GMPD_IS_STATUS(self));
+	g_return_if_fail(GMPD_IS_STATUS(status));
+
+	g_object_freeze_notify(G_OBJECT(self));
+
+	update_string(self, &self->partition, status->partition, PROP_PARTITION);
+
+	if (self->volume != status->volume) {
+		self->volume = status->volume;
+		g_object_notify_by_pspec(G_OBJECT(self), PROPERTIES[PROP_VOLUME]);
+	}
+
+	update_boolean(self, &self->repeat, status->repeat, PROP_REPEAT);
+	update_boolean(self, &self->random, status->random, PROP_RANDOM);
+
+	if (self->single != status->single) {
+		self->single = status->single;
+		g_object_notify_by_pspec(G_OBJECT(self), PROPERTIES[PROP_SINGLE]);
+	}
+
+	update_boolean(self, &self->consume, status->consume, PROP_CONSUME);
+	update_uint(self, &self->queue_version, status->queue_version, PROP_QUEUE_VERSION);
+	update_uint(self, &self->queue_length, status->queue_length, PROP_QUEUE_LENGTH);
+
+	if (self->playback != status->playback) {
+		self->playback = status->playback;
+		g_object_notify_by_pspec(G_OBJECT(self), PROPERTIES[PROP_PLAYBACK]);
+	}
+
+	update_uint(self, &self->current_position, status->current_position, PROP_CURRENT_POSITION);
+	update_uint(self, &self->current_id, status->current_id, PROP_CURRENT_ID);
+	update_uint(self, &self->next_position, status->next_position, PROP_NEXT_POSITION);
+	update_uint(self, &self->next_id, status->next_id, PROP_NEXT_ID);
+	update_float(self, &self->current_elapsed, status->current_elapsed, PROP_CURRENT_ELAPSED);
+	update_float(self, &self->current_duration, status->current_duration, PROP_CURRENT_DURATION);
+	update_uint(self, &self->bit_rate, status->bit_rate, PROP_BIT_RATE);
+	update_uint(self, &self->crossfade, status->crossfade, PROP_CROSSFADE);
+	update_float(self, &self->mixramp_db, status->mixramp_db, PROP_MIXRAMP_DB);
+	update_float(self, &self->mixramp_delay, status->mixramp_delay, PROP_MIXRAMP_DELAY);
+
+	if (!audio_format_equal(self->audio_format, status->audio_format)) {
+		g_clear_object(&self->audio_format);
+		self->audio_format = status->audio_format ? g_object_ref(status->audio_format) : NULL;
+		g_object_notify_by_pspec(G_OBJECT(self), PROPERTIES[PROP_AUDIO_FORMAT]);
+	}
+
+	update_uint(self, &self->db_update_job_id, status->db_update_job_id, PROP_DB_UPDATE_JOB_ID);
+	update_string(self, &self->error, status->error, PROP_ERROR);
+
+	g_object_thaw_notify(G_OBJECT(self));
+
+	g_signal_emit(self, SIGNALS[SIGNAL_UPDATED], 0);
+}
+
 void
 gmpd_status_set_partition(GMpdStatus  *self,
                           const gchar *partition)
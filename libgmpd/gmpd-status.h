@@ -55,6 +55,9 @@ GType              gmpd_status_get_type              (void);
 
 GMpdStatus *       gmpd_status_new                   (void);
 
+void               gmpd_status_update                (GMpdStatus        *self,
+                                                      GMpdStatus        *status);
+
 void               gmpd_status_set_partition         (GMpdStatus        *self,
                                                       const gchar       *partition);
 
@@ -17,6 +17,7 @@
  */
 
 #include <gio/gio.h>
+#include "gmpd-key.h"
 #include "gmpd-tag.h"
 
 static const gchar *const GMPD_TAG_NAMES[] =
@@ -118,16 +119,13 @@ gmpd_tag_get_type(void)
 GMpdTag
 gmpd_tag_from_string(const gchar *s)
 {
-	gsize i;
+	GMpdKey key;
 
 	g_return_val_if_fail(s != NULL, GMPD_TAG_UNKNOWN);
 
-	for (i = 0; i < GMPD_N_TAGS; i++) {
-		if (g_strcmp0(GMPD_TAG_NAMES[i], s) == 0)
-			return (GMpdTag) i;
-	}
+	key = gmpd_key_from_string(s);
 
-	return GMPD_TAG_UNKNOWN;
+	return GMPD_KEY_IS_TAG(key) ? (GMpdTag) key : GMPD_TAG_UNKNOWN;
 }
 
 gchar *
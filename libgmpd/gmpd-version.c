@@ -16,6 +16,7 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
  */
 
+#include <string.h>
 #include <gio/gio.h>
 #include "gmpd-version.h"
 
@@ -25,7 +26,10 @@ static void gmpd_version_set_minor (GMpdVersion *self,
                                     gint         minor);
 static void gmpd_version_set_patch (GMpdVersion *self,
                                     gint         patch);
-static GRegex *gmpd_version_regex  (void);
+static gboolean gmpd_version_match (const gchar *s,
+                                    gint        *major,
+                                    gint        *minor,
+                                    gint        *patch);
 
 enum {
 	PROP_NONE,
@@ -165,36 +169,14 @@ gmpd_version_new(gint major,
 GMpdVersion *
 gmpd_version_new_from_string(const gchar *s)
 {
-	GRegex *regex;
-	GMatchInfo *match_info;
-	gchar *pos_1;
-	gchar *pos_2;
-	gchar *pos_3;
 	gint major;
 	gint minor;
 	gint patch;
 
 	g_return_val_if_fail(s != NULL, NULL);
 
-	regex = gmpd_version_regex();
-
-	if (!g_regex_match(regex, s, 0, &match_info)) {
-		g_match_info_unref(match_info);
+	if (!gmpd_version_match(s, &major, &minor, &patch))
 		return NULL;
-	}
-
-	pos_1 = g_match_info_fetch(match_info, 1);
-	pos_2 = g_match_info_fetch(match_info, 2);
-	pos_3 = g_match_info_fetch(match_info, 3);
-
-	major = g_ascii_strtoll(pos_1, NULL, 10);
-	minor = g_ascii_strtoll(pos_2, NULL, 10);
-	patch = g_ascii_strtoll(pos_3, NULL, 10);
-
-	g_free(pos_1);
-	g_free(pos_2);
-	g_free(pos_3);
-	g_match_info_unref(match_info);
 
 	return gmpd_version_new(major, minor, patch);
 }
@@ -265,29 +247,97 @@ gmpd_version_compare(GMpdVersion *lhs,
 	g_return_val_if_fail(GMPD_IS_VERSION(lhs), 0);
 	g_return_val_if_fail(GMPD_IS_VERSION(rhs), 0);
 
-	(void) ((result = lhs->major = rhs->major) ||
-		(result = lhs->minor = rhs->minor) ||
-		(result = lhs->patch = rhs->patch));
+	(void) ((result = lhs->major - rhs->major) ||
+		(result = lhs->minor - rhs->minor) ||
+		(result = lhs->patch - rhs->patch));
 
 	return result;
 }
 
-static GRegex *
-gmpd_version_regex(void)
+static gsize
+count_digits(const gchar *s)
 {
-	static const gchar *const regex_string = "OK MPD (\\d+).(\\d+).(\\d+)";
-	static volatile gsize initialized = 0;
-	static GRegex *regex = NULL;
+	gsize n = 0;
+
+	while (g_ascii_isdigit(s[n]))
+		n++;
+
+	return n;
+}
 
-	if (g_once_init_enter(&initialized)) {
-		regex = g_regex_new(regex_string, G_REGEX_OPTIMIZE, 0, NULL);
+/* Parses exactly n digits, saturating like g_ascii_strtoll(). */
+static gint
+parse_digits(const gchar *s,
+             gsize        n)
+{
+	gint64 value = 0;
+	gsize i;
 
-		if (!regex)
-			g_error("unable to compile regex: %s", regex_string);
+	for (i = 0; i < n; i++) {
+		if (value > (G_MAXINT64 - (s[i] - '0')) / 10)
+			return (gint) G_MAXINT64;
 
-		g_once_init_leave(&initialized, 1);
+		value = value * 10 + (s[i] - '0');
 	}
 
-	return regex;
+	return (gint) value;
 }
 
+/* Any character but a newline separates the numbers, so a number can
+ * give up digits to the separator that follows it. Longer numbers are
+ * tried first, which picks the same split a backtracking regex would.
+ */
+static gboolean
+gmpd_version_try_match(const gchar *s,
+                       gint        *major,
+                       gint        *minor,
+                       gint        *patch)
+{
+	gsize n_major;
+	gsize n_minor;
+
+	for (n_major = count_digits(s); n_major > 0; n_major--) {
+		const gchar *sep = s + n_major;
+		const gchar *minor_str;
+		const gchar *patch_str;
+
+		if (*sep == '\0' || *sep == '\n')
+			continue;
+
+		minor_str = g_utf8_next_char(sep);
+
+		for (n_minor = count_digits(minor_str); n_minor > 0; n_minor--) {
+			sep = minor_str + n_minor;
+
+			if (*sep == '\0' || *sep == '\n')
+				continue;
+
+			patch_str = g_utf8_next_char(sep);
+			if (!count_digits(patch_str))
+				continue;
+
+			*major = parse_digits(s, n_major);
+			*minor = parse_digits(minor_str, n_minor);
+			*patch = parse_digits(patch_str, count_digits(patch_str));
+
+			return TRUE;
+		}
+	}
+
+	return FALSE;
+}
+
+/* Matches "OK MPD <major>.<minor>.<patch>" anywhere in s. */
+static gboolean
+gmpd_version_match(const gchar *s,
+                   gint        *major,
+                   gint        *minor,
+                   gint        *patch)
+{
+	for (s = strstr(s, "OK MPD "); s; s = strstr(s + 1, "OK MPD ")) {
+		if (gmpd_version_try_match(s + 7, major, minor, patch))
+			return TRUE;
+	}
+
+	return FALSE;
+}
@@ -26,12 +26,22 @@ G_BEGIN_DECLS
 #define __GMPD_H_INSIDE__
 
 #include <gmpd-audio-format.h>
+#include <gmpd-batch.h>
 #include <gmpd-client.h>
+#include <gmpd-connection-state.h>
+#include <gmpd-db-snapshot.h>
+#include <gmpd-directory.h>
 #include <gmpd-entity.h>
 #include <gmpd-error.h>
 #include <gmpd-idle.h>
+#include <gmpd-live-state.h>
+#include <gmpd-metrics.h>
 #include <gmpd-object.h>
+#include <gmpd-paged-queue-model.h>
+#include <gmpd-playback-clock.h>
 #include <gmpd-playback-state.h>
+#include <gmpd-playlist.h>
+#include <gmpd-queue-model.h>
 #include <gmpd-replay-gain-mode.h>
 #include <gmpd-replay-gain-status.h>
 #include <gmpd-single-state.h>
@@ -0,0 +1,154 @@
+/* libgmpd: MPD protocol implementation for GLib
+ * Copyright (C) 2020 Patrick Keating <binarydrifter@protonmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* Times callbacks and notifies going through the per-object dispatch
+ * source against one idle source per callback, which is how they were
+ * dispatched before.
+ */
+
+#include <gio/gio.h>
+#include "value-object.h"
+
+#define N_CALLBACKS 100000
+
+static GParamSpec *value_pspec;
+
+static gboolean
+count(gpointer data)
+{
+	guint *n_calls = data;
+
+	(*n_calls)++;
+
+	return G_SOURCE_REMOVE;
+}
+
+static gboolean
+notify_value(gpointer data)
+{
+	g_object_notify_by_pspec(data, value_pspec);
+	return G_SOURCE_REMOVE;
+}
+
+static void
+drain(GMainContext *context)
+{
+	while (g_main_context_iteration(context, FALSE))
+		continue;
+}
+
+static void
+attach_idle(GMainContext *context,
+            GSourceFunc   func,
+            gpointer      data)
+{
+	GSource *source = g_idle_source_new();
+
+	g_source_set_callback(source, func, data, NULL);
+	g_source_attach(source, context);
+	g_source_unref(source);
+}
+
+static gdouble
+run_callbacks(gboolean dispatch_source)
+{
+	GMainContext *context = g_main_context_new();
+	ValueObject *object = value_object_new(context);
+	GTimer *timer = g_timer_new();
+	guint n_calls = 0;
+	gdouble elapsed;
+	guint i;
+
+	for (i = 0; i < N_CALLBACKS; i++) {
+		if (dispatch_source)
+			gmpd_object_run_in_context(GMPD_OBJECT(object), count, &n_calls, NULL);
+		else
+			attach_idle(context, count, &n_calls);
+	}
+
+	drain(context);
+
+	elapsed = g_timer_elapsed(timer, NULL);
+	g_assert_cmpuint(n_calls, ==, N_CALLBACKS);
+
+	g_timer_destroy(timer);
+	g_object_unref(object);
+	g_main_context_unref(context);
+
+	return elapsed;
+}
+
+/* The object without a context emits right away, so the idle sources
+ * stand in for the old deferred notify.
+ */
+static gdouble
+run_notifies(gboolean dispatch_source)
+{
+	GMainContext *context = g_main_context_new();
+	ValueObject *object = value_object_new(dispatch_source ? context : NULL);
+	GTimer *timer = g_timer_new();
+	gdouble elapsed;
+	guint i;
+
+	for (i = 0; i < N_CALLBACKS; i++) {
+		if (dispatch_source)
+			value_object_set_value(object, i);
+		else
+			attach_idle(context, notify_value, object);
+	}
+
+	drain(context);
+
+	elapsed = g_timer_elapsed(timer, NULL);
+
+	g_timer_destroy(timer);
+	g_object_unref(object);
+	g_main_context_unref(context);
+
+	return elapsed;
+}
+
+static void
+compare(const gchar *name,
+        gdouble    (*func) (gboolean dispatch_source))
+{
+	gdouble dispatch_source = func(TRUE);
+	gdouble idle_sources = func(FALSE);
+
+	g_print("%-10s  dispatch source %7.1f ns  idle sources %7.1f ns  (%.1fx)\n",
+	        name,
+	        dispatch_source * 1e9 / N_CALLBACKS,
+	        idle_sources * 1e9 / N_CALLBACKS,
+	        idle_sources / dispatch_source);
+}
+
+int
+main(int    argc G_GNUC_UNUSED,
+     char **argv G_GNUC_UNUSED)
+{
+	GObjectClass *klass = g_type_class_ref(VALUE_TYPE_OBJECT);
+
+	value_pspec = g_object_class_find_property(klass, "value");
+
+	compare("callbacks", run_callbacks);
+	compare("notifies", run_notifies);
+
+	g_type_class_unref(klass);
+
+	return 0;
+}
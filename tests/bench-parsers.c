@@ -0,0 +1,177 @@
+/* libgmpd: MPD protocol implementation for GLib
+ * Copyright (C) 2020 Patrick Keating <binarydrifter@protonmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* Times the version, error and audio format scanners against the GRegex
+ * patterns they replaced. The regex side matches, fetches the groups
+ * and converts them, which is what the old parsers did.
+ */
+
+#include <gio/gio.h>
+#include <gmpd.h>
+
+#define N_ITERATIONS 200000
+
+#define VERSION_PATTERN      "OK MPD (\\d+).(\\d+).(\\d+)"
+#define ERROR_PATTERN        "ACK \\[(\\d+)@(\\d+)\\] {([^}]+)} (.*)"
+#define AUDIO_FORMAT_PATTERN "(\\d+):(\\d+):(\\d+)"
+
+#define VERSION_INPUT      "OK MPD 0.23.5\n"
+#define ERROR_INPUT        "ACK [50@0] {play} No such song"
+#define AUDIO_FORMAT_INPUT "44100:24:2"
+
+typedef void (*ParseFunc) (const gchar *s);
+
+static GRegex *regex;
+
+static void
+parse_version(const gchar *s)
+{
+	g_object_unref(gmpd_version_new_from_string(s));
+}
+
+static void
+parse_error(const gchar *s)
+{
+	g_error_free(gmpd_error_from_string(s));
+}
+
+static void
+parse_audio_format(const gchar *s)
+{
+	g_object_unref(gmpd_audio_format_new_from_string(s));
+}
+
+static void
+match_version(const gchar *s)
+{
+	GMatchInfo *match_info;
+
+	if (g_regex_match(regex, s, 0, &match_info)) {
+		gchar *major = g_match_info_fetch(match_info, 1);
+		gchar *minor = g_match_info_fetch(match_info, 2);
+		gchar *patch = g_match_info_fetch(match_info, 3);
+
+		g_object_unref(gmpd_version_new(g_ascii_strtoll(major, NULL, 10),
+		                                g_ascii_strtoll(minor, NULL, 10),
+		                                g_ascii_strtoll(patch, NULL, 10)));
+
+		g_free(major);
+		g_free(minor);
+		g_free(patch);
+	}
+
+	g_match_info_unref(match_info);
+}
+
+static void
+match_error(const gchar *s)
+{
+	GMatchInfo *match_info;
+
+	if (g_regex_match(regex, s, 0, &match_info)) {
+		gchar *code = g_match_info_fetch(match_info, 1);
+		gchar *command = g_match_info_fetch(match_info, 3);
+		gchar *text = g_match_info_fetch(match_info, 4);
+
+		g_error_free(g_error_new(GMPD_ERROR, g_ascii_strtoll(code, NULL, 10),
+		                         "%s: %s", command, text));
+
+		g_free(code);
+		g_free(command);
+		g_free(text);
+	}
+
+	g_match_info_unref(match_info);
+}
+
+static void
+match_audio_format(const gchar *s)
+{
+	GMatchInfo *match_info;
+
+	if (g_regex_match(regex, s, 0, &match_info)) {
+		gchar *sample_rate = g_match_info_fetch(match_info, 1);
+		gchar *bit_depth = g_match_info_fetch(match_info, 2);
+		gchar *channels = g_match_info_fetch(match_info, 3);
+		GMpdAudioFormat *audio_format = gmpd_audio_format_new();
+
+		gmpd_audio_format_set_sample_rate(audio_format, g_ascii_strtoull(sample_rate, NULL, 10));
+		gmpd_audio_format_set_bit_depth(audio_format, g_ascii_strtoull(bit_depth, NULL, 10));
+		gmpd_audio_format_set_channels(audio_format, g_ascii_strtoull(channels, NULL, 10));
+		g_object_unref(audio_format);
+
+		g_free(sample_rate);
+		g_free(bit_depth);
+		g_free(channels);
+	}
+
+	g_match_info_unref(match_info);
+}
+
+static gdouble
+run(ParseFunc    func,
+    const gchar *s)
+{
+	GTimer *timer = g_timer_new();
+	gdouble elapsed;
+	guint i;
+
+	for (i = 0; i < N_ITERATIONS; i++)
+		func(s);
+
+	elapsed = g_timer_elapsed(timer, NULL);
+	g_timer_destroy(timer);
+
+	return elapsed;
+}
+
+static void
+compare(const gchar *name,
+        const gchar *pattern,
+        ParseFunc    parse,
+        ParseFunc    match,
+        const gchar *s)
+{
+	gdouble scanner;
+	gdouble pattern_time;
+
+	regex = g_regex_new(pattern, G_REGEX_OPTIMIZE, 0, NULL);
+	g_assert_nonnull(regex);
+
+	scanner = run(parse, s);
+	pattern_time = run(match, s);
+
+	g_print("%-12s  scanner %7.1f ns  regex %7.1f ns  (%.1fx)\n",
+	        name,
+	        scanner * 1e9 / N_ITERATIONS,
+	        pattern_time * 1e9 / N_ITERATIONS,
+	        pattern_time / scanner);
+
+	g_regex_unref(regex);
+}
+
+int
+main(int    argc G_GNUC_UNUSED,
+     char **argv G_GNUC_UNUSED)
+{
+	compare("version", VERSION_PATTERN, parse_version, match_version, VERSION_INPUT);
+	compare("error", ERROR_PATTERN, parse_error, match_error, ERROR_INPUT);
+	compare("audio-format", AUDIO_FORMAT_PATTERN, parse_audio_format, match_audio_format, AUDIO_FORMAT_INPUT);
+
+	return 0;
+}
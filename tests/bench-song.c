@@ -0,0 +1,121 @@
+/* libgmpd: MPD protocol implementation for GLib
+ * Copyright (C) 2020 Patrick Keating <binarydrifter@protonmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* Builds a library of 100k songs the way the client parses them and
+ * reports how much resident memory they take. The tags repeat across
+ * songs like in a real library, a few hundred artists and a few
+ * thousand albums.
+ */
+
+#include <unistd.h>
+#include <gio/gio.h>
+#include "gmpd-response.h"
+#include "gmpd-song.h"
+
+#define N_SONGS   100000
+#define N_ARTISTS 500
+#define N_ALBUMS  8000
+#define N_GENRES  20
+
+/* Resident set size in bytes, or 0 where /proc is not available. */
+static gsize
+get_resident_size(void)
+{
+	gchar *contents = NULL;
+	gsize resident = 0;
+	gchar **fields;
+
+	if (!g_file_get_contents("/proc/self/statm", &contents, NULL, NULL))
+		return 0;
+
+	fields = g_strsplit(contents, " ", -1);
+
+	if (g_strv_length(fields) > 1)
+		resident = g_ascii_strtoull(fields[1], NULL, 10) * sysconf(_SC_PAGESIZE);
+
+	g_strfreev(fields);
+	g_free(contents);
+
+	return resident;
+}
+
+static void
+feed(GMpdSong    *song,
+     GMpdVersion *version,
+     const gchar *key,
+     gchar       *value)
+{
+	gmpd_response_feed_pair(GMPD_RESPONSE(song), version, key, value);
+	g_free(value);
+}
+
+static GMpdSong *
+song_new(GMpdVersion *version,
+         guint        i)
+{
+	GMpdSong *song = gmpd_song_new();
+	guint album = i % N_ALBUMS;
+	guint artist = album % N_ARTISTS;
+
+	feed(song, version, "file", g_strdup_printf("music/%u/%u/%u.flac", artist, album, i));
+	feed(song, version, "Artist", g_strdup_printf("Artist %u", artist));
+	feed(song, version, "AlbumArtist", g_strdup_printf("Artist %u", artist));
+	feed(song, version, "Album", g_strdup_printf("Album %u", album));
+	feed(song, version, "Genre", g_strdup_printf("Genre %u", artist % N_GENRES));
+	feed(song, version, "Date", g_strdup_printf("%u", 1960 + album % 60));
+	feed(song, version, "Title", g_strdup_printf("Title of song %u", i));
+	feed(song, version, "Track", g_strdup_printf("%u", i / N_ALBUMS + 1));
+	feed(song, version, "Time", g_strdup("215"));
+	feed(song, version, "duration", g_strdup("214.813"));
+
+	gmpd_response_finish(GMPD_RESPONSE(song), version);
+
+	return song;
+}
+
+int
+main(int    argc G_GNUC_UNUSED,
+     char **argv G_GNUC_UNUSED)
+{
+	GMpdVersion *version = gmpd_version_new(0, 23, 5);
+	GPtrArray *songs = g_ptr_array_new_full(N_SONGS, g_object_unref);
+	gsize before;
+	gsize after;
+	guint i;
+
+	before = get_resident_size();
+
+	for (i = 0; i < N_SONGS; i++)
+		g_ptr_array_add(songs, song_new(version, i));
+
+	after = get_resident_size();
+
+	if (!before || !after) {
+		g_print("resident size not available, skipped\n");
+	} else {
+		g_print("%u songs  %" G_GSIZE_FORMAT " KiB  %" G_GSIZE_FORMAT " bytes per song\n",
+		        N_SONGS,
+		        (after - before) / 1024,
+		        (after - before) / N_SONGS);
+	}
+
+	g_ptr_array_unref(songs);
+	g_object_unref(version);
+
+	return 0;
+}
@@ -0,0 +1,236 @@
+/* libgmpd: MPD protocol implementation for GLib
+ * Copyright (C) 2020 Patrick Keating <binarydrifter@protonmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* A server that answers one client from a table of canned responses, so
+ * the models can be driven without a running MPD. Commands that are not
+ * in the table succeed with an empty response. idle waits for noidle or
+ * for a change made with fake_server_emit_idle(), like MPD does.
+ */
+
+#include <string.h>
+#include <gio/gio.h>
+#include "fake-server.h"
+
+#define WELCOME "OK MPD 0.23.5\n"
+
+/* mutex guards everything below it, writes to the client included */
+struct _FakeServer {
+	GSocketListener *listener;
+	GCancellable    *cancellable;
+	GThread         *thread;
+	guint16          port;
+
+	GMutex           mutex;
+	GHashTable      *responses;
+	GOutputStream   *output;
+	gboolean         idling;
+	GString         *changed;
+};
+
+static gboolean
+fake_server_write(FakeServer *self,
+                  GString    *reply)
+{
+	gboolean result;
+
+	result = g_output_stream_write_all(self->output, reply->str, reply->len,
+	                                   NULL, self->cancellable, NULL);
+	g_string_truncate(reply, 0);
+
+	return result;
+}
+
+static gboolean
+is_idle(const gchar *line)
+{
+	return !strcmp(line, "idle") || g_str_has_prefix(line, "idle ");
+}
+
+static void
+fake_server_serve(FakeServer        *self,
+                  GSocketConnection *connection)
+{
+	GDataInputStream *input;
+	GString *reply;
+	gboolean in_list = FALSE;
+	gboolean list_ok = FALSE;
+	gboolean open;
+	gchar *line;
+
+	input = g_data_input_stream_new(g_io_stream_get_input_stream(G_IO_STREAM(connection)));
+	reply = g_string_new(WELCOME);
+
+	g_mutex_lock(&self->mutex);
+	self->output = g_io_stream_get_output_stream(G_IO_STREAM(connection));
+	open = fake_server_write(self, reply);
+	g_mutex_unlock(&self->mutex);
+
+	while (open && (line = g_data_input_stream_read_line(input, NULL, self->cancellable, NULL))) {
+		const gchar *response;
+
+		g_mutex_lock(&self->mutex);
+
+		if (!strcmp(line, "command_list_begin")) {
+			in_list = TRUE;
+			list_ok = FALSE;
+
+		} else if (!strcmp(line, "command_list_ok_begin")) {
+			in_list = TRUE;
+			list_ok = TRUE;
+
+		} else if (!strcmp(line, "command_list_end")) {
+			in_list = FALSE;
+			g_string_append(reply, "OK\n");
+
+		} else if (!in_list && is_idle(line)) {
+			if (self->changed->len) {
+				g_string_append(reply, self->changed->str);
+				g_string_append(reply, "OK\n");
+				g_string_truncate(self->changed, 0);
+			} else {
+				self->idling = TRUE;
+			}
+
+		} else if (!strcmp(line, "noidle")) {
+			/* ignored unless idle is waiting */
+			if (self->idling) {
+				self->idling = FALSE;
+				g_string_append(reply, "OK\n");
+			}
+
+		} else {
+			response = g_hash_table_lookup(self->responses, line);
+			if (response)
+				g_string_append(reply, response);
+
+			if (!in_list)
+				g_string_append(reply, "OK\n");
+			else if (list_ok)
+				g_string_append(reply, "list_OK\n");
+		}
+
+		/* the reply to a command list is sent as a whole */
+		if (reply->len && !in_list)
+			open = fake_server_write(self, reply);
+
+		g_mutex_unlock(&self->mutex);
+		g_free(line);
+	}
+
+	g_mutex_lock(&self->mutex);
+	self->output = NULL;
+	self->idling = FALSE;
+	g_mutex_unlock(&self->mutex);
+
+	g_string_free(reply, TRUE);
+	g_object_unref(input);
+}
+
+static gpointer
+fake_server_thread(gpointer user_data)
+{
+	FakeServer *self = user_data;
+	GSocketConnection *connection;
+
+	connection = g_socket_listener_accept(self->listener, NULL, self->cancellable, NULL);
+
+	if (connection) {
+		fake_server_serve(self, connection);
+		g_object_unref(connection);
+	}
+
+	return NULL;
+}
+
+FakeServer *
+fake_server_new(void)
+{
+	FakeServer *self = g_new0(FakeServer, 1);
+	GError *error = NULL;
+
+	self->listener = g_socket_listener_new();
+	self->cancellable = g_cancellable_new();
+	self->port = g_socket_listener_add_any_inet_port(self->listener, NULL, &error);
+	g_assert_no_error(error);
+
+	g_mutex_init(&self->mutex);
+	self->responses = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+	self->output = NULL;
+	self->idling = FALSE;
+	self->changed = g_string_new(NULL);
+
+	self->thread = g_thread_new("fake-server", fake_server_thread, self);
+
+	return self;
+}
+
+void
+fake_server_free(FakeServer *self)
+{
+	g_cancellable_cancel(self->cancellable);
+	g_thread_join(self->thread);
+
+	g_socket_listener_close(self->listener);
+	g_object_unref(self->listener);
+	g_object_unref(self->cancellable);
+
+	g_hash_table_unref(self->responses);
+	g_string_free(self->changed, TRUE);
+	g_mutex_clear(&self->mutex);
+
+	g_free(self);
+}
+
+guint16
+fake_server_get_port(FakeServer *self)
+{
+	return self->port;
+}
+
+void
+fake_server_set_response(FakeServer  *self,
+                         const gchar *command,
+                         const gchar *response)
+{
+	g_mutex_lock(&self->mutex);
+	g_hash_table_insert(self->responses, g_strdup(command), g_strdup(response));
+	g_mutex_unlock(&self->mutex);
+}
+
+/* The change is reported to the pending idle, or to the next one. */
+void
+fake_server_emit_idle(FakeServer  *self,
+                      const gchar *subsystem)
+{
+	g_mutex_lock(&self->mutex);
+
+	g_string_append_printf(self->changed, "changed: %s\n", subsystem);
+
+	if (self->idling && self->output) {
+		GString *reply = g_string_new(self->changed->str);
+
+		g_string_append(reply, "OK\n");
+		g_string_truncate(self->changed, 0);
+		self->idling = FALSE;
+
+		fake_server_write(self, reply);
+		g_string_free(reply, TRUE);
+	}
+
+	g_mutex_unlock(&self->mutex);
+}
@@ -0,0 +1,39 @@
+/* libgmpd: MPD protocol implementation for GLib
+ * Copyright (C) 2020 Patrick Keating <binarydrifter@protonmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef __FAKE_SERVER_H__
+#define __FAKE_SERVER_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef struct _FakeServer FakeServer;
+
+FakeServer *fake_server_new          (void);
+void        fake_server_free         (FakeServer  *self);
+guint16     fake_server_get_port     (FakeServer  *self);
+void        fake_server_set_response (FakeServer  *self,
+                                      const gchar *command,
+                                      const gchar *response);
+void        fake_server_emit_idle    (FakeServer  *self,
+                                      const gchar *subsystem);
+
+G_END_DECLS
+
+#endif /* __FAKE_SERVER_H__ */
@@ -0,0 +1,368 @@
+/* libgmpd: MPD protocol implementation for GLib
+ * Copyright (C) 2020 Patrick Keating <binarydrifter@protonmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* Checks that a database snapshot reads back what was saved, and that
+ * truncated or corrupted files and records are rejected.
+ */
+
+#include <string.h>
+#include <gio/gio.h>
+#include <glib/gstdio.h>
+#include "gmpd-db-snapshot.h"
+#include "gmpd-directory.h"
+#include "gmpd-entity.h"
+#include "gmpd-response.h"
+#include "gmpd-song.h"
+
+#define SERVER "localhost:6600"
+
+/* offsets into the file, see gmpd-db-snapshot.c */
+#define HEADER_STRINGS_LEN   28
+#define HEADER_N_DIRECTORIES 32
+#define HEADER_SIZE          48
+#define DIRECTORY_SIZE       32
+#define SONG_SIZE            48
+#define SONG_PATH            8
+#define SONG_N_TAGS          40
+
+typedef struct {
+	gchar     *dir;
+	gchar     *filename;
+	GDateTime *db_update;
+} Fixture;
+
+static GMpdSong *
+song_new(const gchar *const *pairs)
+{
+	GMpdVersion *version = gmpd_version_new(0, 23, 5);
+	GMpdSong *song = gmpd_song_new();
+
+	for (; pairs[0]; pairs += 2)
+		gmpd_response_feed_pair(GMPD_RESPONSE(song), version, pairs[0], pairs[1]);
+
+	gmpd_response_finish(GMPD_RESPONSE(song), version);
+	g_object_unref(version);
+
+	return song;
+}
+
+static void
+fixture_set_up(Fixture       *fixture,
+               gconstpointer  user_data G_GNUC_UNUSED)
+{
+	static const gchar *const a[] = {
+		"file",          "music/a.flac",
+		"Last-Modified", "2020-05-01T12:00:00Z",
+		"Artist",        "first",
+		"Artist",        "second",
+		"Title",         "a",
+		"duration",      "100.500",
+		"Format",        "44100:16:2",
+		NULL,
+	};
+
+	static const gchar *const b[] = {
+		"file",   "music/b.flac",
+		"Artist", "first",
+		"Title",  "b",
+		NULL,
+	};
+
+	static const gchar *const c[] = {
+		"file",  "c.flac",
+		"Title", "c",
+		NULL,
+	};
+
+	GPtrArray *entities = g_ptr_array_new_with_free_func(g_object_unref);
+	GMpdDirectory *directory = gmpd_directory_new();
+	GError *error = NULL;
+
+	fixture->dir = g_dir_make_tmp("test-db-snapshot-XXXXXX", &error);
+	g_assert_no_error(error);
+
+	fixture->filename = g_build_filename(fixture->dir, "snapshot", NULL);
+	fixture->db_update = g_date_time_new_from_unix_utc(1600000000);
+
+	gmpd_entity_set_path(GMPD_ENTITY(directory), "music");
+
+	g_ptr_array_add(entities, directory);
+	g_ptr_array_add(entities, song_new(a));
+	g_ptr_array_add(entities, song_new(b));
+	g_ptr_array_add(entities, song_new(c));
+
+	gmpd_db_snapshot_save(fixture->filename, SERVER, fixture->db_update, entities, &error);
+	g_assert_no_error(error);
+
+	g_ptr_array_unref(entities);
+}
+
+static void
+fixture_tear_down(Fixture       *fixture,
+                  gconstpointer  user_data G_GNUC_UNUSED)
+{
+	g_remove(fixture->filename);
+	g_rmdir(fixture->dir);
+
+	g_free(fixture->filename);
+	g_free(fixture->dir);
+	g_date_time_unref(fixture->db_update);
+}
+
+static guint32
+get_uint32(const gchar *contents,
+           gsize        offset)
+{
+	guint32 value;
+
+	memcpy(&value, contents + offset, sizeof(value));
+
+	return value;
+}
+
+static void
+set_uint32(gchar   *contents,
+           gsize    offset,
+           guint32  value)
+{
+	memcpy(contents + offset, &value, sizeof(value));
+}
+
+/* Offset of the first song record. */
+static gsize
+songs_offset(const gchar *contents)
+{
+	gsize strings_end = HEADER_SIZE + get_uint32(contents, HEADER_STRINGS_LEN);
+
+	return ((strings_end + 7) & ~(gsize) 7) +
+	       get_uint32(contents, HEADER_N_DIRECTORIES) * DIRECTORY_SIZE;
+}
+
+static gchar *
+read_file(Fixture *fixture,
+          gsize   *length)
+{
+	gchar *contents;
+	GError *error = NULL;
+
+	g_file_get_contents(fixture->filename, &contents, length, &error);
+	g_assert_no_error(error);
+
+	return contents;
+}
+
+static void
+write_file(Fixture     *fixture,
+           const gchar *contents,
+           gsize        length)
+{
+	GError *error = NULL;
+
+	g_file_set_contents(fixture->filename, contents, length, &error);
+	g_assert_no_error(error);
+}
+
+static void
+test_round_trip(Fixture       *fixture,
+                gconstpointer  user_data G_GNUC_UNUSED)
+{
+	GMpdDbSnapshot *snapshot;
+	GMpdAudioFormat *format;
+	GDateTime *date_time;
+	GMpdSong *song;
+	GError *error = NULL;
+	gchar *server;
+	guint first;
+	guint n;
+
+	snapshot = gmpd_db_snapshot_new_from_file(fixture->filename, &error);
+	g_assert_no_error(error);
+
+	server = gmpd_db_snapshot_get_server(snapshot);
+	g_assert_cmpstr(server, ==, SERVER);
+	g_free(server);
+
+	date_time = gmpd_db_snapshot_get_db_update(snapshot);
+	g_assert_true(g_date_time_equal(date_time, fixture->db_update));
+	g_date_time_unref(date_time);
+
+	/* the root holds c.flac and music, music holds the other two */
+	g_assert_cmpuint(gmpd_db_snapshot_get_n_directories(snapshot), ==, 2);
+	g_assert_cmpuint(gmpd_db_snapshot_get_n_songs(snapshot), ==, 3);
+	g_assert_cmpstr(gmpd_db_snapshot_peek_directory_path(snapshot, 1), ==, "music");
+	g_assert_cmpuint(gmpd_db_snapshot_get_directory_parent(snapshot, 1), ==, 0);
+
+	gmpd_db_snapshot_get_directory_songs(snapshot, 1, &first, &n);
+	g_assert_cmpuint(first, ==, 1);
+	g_assert_cmpuint(n, ==, 2);
+
+	g_assert_cmpstr(gmpd_db_snapshot_peek_song_path(snapshot, 0), ==, "c.flac");
+	g_assert_cmpstr(gmpd_db_snapshot_peek_song_path(snapshot, 1), ==, "music/a.flac");
+	g_assert_cmpstr(gmpd_db_snapshot_peek_song_path(snapshot, 2), ==, "music/b.flac");
+
+	song = gmpd_db_snapshot_get_song(snapshot, 1);
+
+	g_assert_cmpstr(gmpd_song_peek_tag(song, GMPD_TAG_ARTIST, 0), ==, "first");
+	g_assert_cmpstr(gmpd_song_peek_tag(song, GMPD_TAG_ARTIST, 1), ==, "second");
+	g_assert_null(gmpd_song_peek_tag(song, GMPD_TAG_ARTIST, 2));
+	g_assert_cmpstr(gmpd_song_peek_tag(song, GMPD_TAG_TITLE, 0), ==, "a");
+	g_assert_cmpfloat(gmpd_song_get_duration(song), ==, 100.5);
+
+	date_time = gmpd_entity_get_last_modified(GMPD_ENTITY(song));
+	g_assert_cmpint(g_date_time_to_unix(date_time), ==, 1588334400);
+	g_date_time_unref(date_time);
+
+	format = gmpd_song_get_format(song);
+	g_assert_cmpuint(gmpd_audio_format_get_sample_rate(format), ==, 44100);
+	g_assert_cmpuint(gmpd_audio_format_get_bit_depth(format), ==, 16);
+	g_assert_cmpuint(gmpd_audio_format_get_channels(format), ==, 2);
+	g_object_unref(format);
+
+	g_object_unref(song);
+
+	song = gmpd_db_snapshot_get_song(snapshot, 0);
+	g_assert_null(gmpd_song_peek_tag(song, GMPD_TAG_ARTIST, 0));
+	g_assert_null(gmpd_song_get_format(song));
+	g_object_unref(song);
+
+	g_object_unref(snapshot);
+}
+
+static void
+test_truncated(Fixture       *fixture,
+               gconstpointer  user_data G_GNUC_UNUSED)
+{
+	GMpdDbSnapshot *snapshot;
+	GError *error = NULL;
+	gchar *contents;
+	gsize length;
+
+	contents = read_file(fixture, &length);
+	write_file(fixture, contents, length - 1);
+
+	snapshot = gmpd_db_snapshot_new_from_file(fixture->filename, &error);
+	g_assert_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA);
+	g_assert_null(snapshot);
+	g_clear_error(&error);
+
+	/* too short for a header */
+	write_file(fixture, contents, HEADER_SIZE - 1);
+
+	snapshot = gmpd_db_snapshot_new_from_file(fixture->filename, &error);
+	g_assert_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA);
+	g_assert_null(snapshot);
+	g_clear_error(&error);
+
+	g_free(contents);
+}
+
+static void
+test_bad_counts(Fixture       *fixture,
+                gconstpointer  user_data G_GNUC_UNUSED)
+{
+	GMpdDbSnapshot *snapshot;
+	GError *error = NULL;
+	gchar *contents;
+	gsize length;
+
+	/* more directories than the file holds */
+	contents = read_file(fixture, &length);
+	set_uint32(contents, HEADER_N_DIRECTORIES, G_MAXUINT32);
+	write_file(fixture, contents, length);
+
+	snapshot = gmpd_db_snapshot_new_from_file(fixture->filename, &error);
+	g_assert_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA);
+	g_assert_null(snapshot);
+
+	g_clear_error(&error);
+	g_free(contents);
+}
+
+static void
+test_tags_out_of_range(Fixture       *fixture,
+                       gconstpointer  user_data G_GNUC_UNUSED)
+{
+	GMpdDbSnapshot *snapshot;
+	GMpdSong *song;
+	GError *error = NULL;
+	gchar *contents;
+	gsize length;
+
+	contents = read_file(fixture, &length);
+	set_uint32(contents, songs_offset(contents) + SONG_SIZE + SONG_N_TAGS, G_MAXUINT32);
+	write_file(fixture, contents, length);
+
+	snapshot = gmpd_db_snapshot_new_from_file(fixture->filename, &error);
+	g_assert_no_error(error);
+
+	g_test_expect_message(NULL, G_LOG_LEVEL_WARNING, "tags of song 1 out of range");
+	song = gmpd_db_snapshot_get_song(snapshot, 1);
+	g_test_assert_expected_messages();
+
+	/* the record itself is still read */
+	g_assert_cmpfloat(gmpd_song_get_duration(song), ==, 100.5);
+	g_assert_null(gmpd_song_peek_tag(song, GMPD_TAG_ARTIST, 0));
+
+	g_object_unref(song);
+	g_object_unref(snapshot);
+	g_free(contents);
+}
+
+static void
+test_string_out_of_range(Fixture       *fixture,
+                         gconstpointer  user_data G_GNUC_UNUSED)
+{
+	GMpdDbSnapshot *snapshot;
+	GError *error = NULL;
+	gchar *contents;
+	gsize length;
+
+	contents = read_file(fixture, &length);
+	set_uint32(contents, songs_offset(contents) + SONG_PATH, get_uint32(contents, HEADER_STRINGS_LEN));
+	write_file(fixture, contents, length);
+
+	snapshot = gmpd_db_snapshot_new_from_file(fixture->filename, &error);
+	g_assert_no_error(error);
+
+	g_test_expect_message(NULL, G_LOG_LEVEL_WARNING, "string offset * out of range");
+	g_assert_cmpstr(gmpd_db_snapshot_peek_song_path(snapshot, 0), ==, "");
+	g_test_assert_expected_messages();
+
+	g_object_unref(snapshot);
+	g_free(contents);
+}
+
+int
+main(int    argc,
+     char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add("/db-snapshot/round-trip", Fixture, NULL,
+	           fixture_set_up, test_round_trip, fixture_tear_down);
+	g_test_add("/db-snapshot/truncated", Fixture, NULL,
+	           fixture_set_up, test_truncated, fixture_tear_down);
+	g_test_add("/db-snapshot/bad-counts", Fixture, NULL,
+	           fixture_set_up, test_bad_counts, fixture_tear_down);
+	g_test_add("/db-snapshot/tags-out-of-range", Fixture, NULL,
+	           fixture_set_up, test_tags_out_of_range, fixture_tear_down);
+	g_test_add("/db-snapshot/string-out-of-range", Fixture, NULL,
+	           fixture_set_up, test_string_out_of_range, fixture_tear_down);
+
+	return g_test_run();
+}
@@ -0,0 +1,210 @@
+/* libgmpd: MPD protocol implementation for GLib
+ * Copyright (C) 2020 Patrick Keating <binarydrifter@protonmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* Checks that the live state merges a refresh into the objects it hands
+ * out, notifying only the properties and tags that changed.
+ */
+
+#include <gio/gio.h>
+#include <gmpd.h>
+#include "fake-server.h"
+
+#define STATUS \
+	"volume: 50\nstate: play\nsong: 0\nsongid: 1\nduration: 100.000\n"
+
+#define CURRENT_SONG \
+	"file: a.flac\nArtist: artist\nPos: 0\nId: 1\n"
+
+typedef struct {
+	GMainContext  *context;
+	FakeServer    *server;
+	GMpdClient    *client;
+	GMpdLiveState *state;
+
+	GMpdStatus    *status;
+	GMpdSong      *song;
+	GPtrArray     *notified;
+	GArray        *tags;
+} Fixture;
+
+static void
+on_notify(GObject    *object G_GNUC_UNUSED,
+          GParamSpec *pspec,
+          Fixture    *fixture)
+{
+	g_ptr_array_add(fixture->notified, g_strdup(pspec->name));
+}
+
+static void
+on_tag_changed(GMpdSong *song G_GNUC_UNUSED,
+               GMpdTag   tag,
+               Fixture  *fixture)
+{
+	g_array_append_val(fixture->tags, tag);
+}
+
+static void
+on_refresh_ready(GObject      *source_object,
+                 GAsyncResult *result,
+                 gpointer      user_data)
+{
+	GError *error = NULL;
+
+	gmpd_live_state_refresh_finish(GMPD_LIVE_STATE(source_object), result, &error);
+	g_assert_no_error(error);
+
+	g_main_loop_quit(user_data);
+}
+
+static void
+refresh(Fixture *fixture)
+{
+	GMainLoop *loop = g_main_loop_new(fixture->context, FALSE);
+
+	gmpd_live_state_refresh_async(fixture->state, GMPD_IDLE_ALL, NULL, on_refresh_ready, loop);
+	g_main_loop_run(loop);
+	g_main_loop_unref(loop);
+}
+
+static void
+set_responses(Fixture     *fixture,
+              const gchar *elapsed,
+              const gchar *title)
+{
+	gchar *status = g_strdup_printf(STATUS "elapsed: %s\n", elapsed);
+	gchar *song = g_strdup_printf(CURRENT_SONG "Title: %s\n", title);
+
+	fake_server_set_response(fixture->server, "status", status);
+	fake_server_set_response(fixture->server, "currentsong", song);
+
+	g_free(status);
+	g_free(song);
+}
+
+static void
+fixture_set_up(Fixture       *fixture,
+               gconstpointer  user_data G_GNUC_UNUSED)
+{
+	GError *error = NULL;
+
+	fixture->context = g_main_context_new();
+	g_main_context_push_thread_default(fixture->context);
+
+	fixture->server = fake_server_new();
+	fake_server_set_response(fixture->server, "stats", "artists: 1\nsongs: 1\n");
+	set_responses(fixture, "1.000", "title");
+
+	fixture->client = gmpd_client_connect("127.0.0.1",
+	                                      fake_server_get_port(fixture->server),
+	                                      NULL,
+	                                      &error);
+	g_assert_no_error(error);
+
+	fixture->state = gmpd_live_state_new(fixture->client);
+	refresh(fixture);
+
+	fixture->status = gmpd_live_state_get_status(fixture->state);
+	fixture->song = gmpd_live_state_get_current_song(fixture->state);
+	fixture->notified = g_ptr_array_new_with_free_func(g_free);
+	fixture->tags = g_array_new(FALSE, FALSE, sizeof(GMpdTag));
+
+	g_assert_cmpstr(gmpd_song_peek_tag(fixture->song, GMPD_TAG_TITLE, 0), ==, "title");
+
+	g_signal_connect(fixture->status, "notify", G_CALLBACK(on_notify), fixture);
+	g_signal_connect(fixture->song, "notify", G_CALLBACK(on_notify), fixture);
+	g_signal_connect(fixture->song, "tag-changed", G_CALLBACK(on_tag_changed), fixture);
+}
+
+static void
+fixture_tear_down(Fixture       *fixture,
+                  gconstpointer  user_data G_GNUC_UNUSED)
+{
+	g_signal_handlers_disconnect_by_data(fixture->status, fixture);
+	g_signal_handlers_disconnect_by_data(fixture->song, fixture);
+
+	g_array_unref(fixture->tags);
+	g_ptr_array_unref(fixture->notified);
+	g_object_unref(fixture->song);
+	g_object_unref(fixture->status);
+	g_object_unref(fixture->state);
+	g_object_unref(fixture->client);
+	fake_server_free(fixture->server);
+
+	g_main_context_pop_thread_default(fixture->context);
+	g_main_context_unref(fixture->context);
+}
+
+static void
+test_unchanged(Fixture       *fixture,
+               gconstpointer  user_data G_GNUC_UNUSED)
+{
+	refresh(fixture);
+
+	g_assert_cmpuint(fixture->notified->len, ==, 0);
+	g_assert_cmpuint(fixture->tags->len, ==, 0);
+}
+
+static void
+test_changed(Fixture       *fixture,
+             gconstpointer  user_data G_GNUC_UNUSED)
+{
+	set_responses(fixture, "2.000", "retitled");
+	refresh(fixture);
+
+	g_assert_cmpuint(fixture->notified->len, ==, 1);
+	g_assert_cmpstr(g_ptr_array_index(fixture->notified, 0), ==, "current-elapsed");
+
+	g_assert_cmpuint(fixture->tags->len, ==, 1);
+	g_assert_cmpint(g_array_index(fixture->tags, GMpdTag, 0), ==, GMPD_TAG_TITLE);
+	g_assert_cmpstr(gmpd_song_peek_tag(fixture->song, GMPD_TAG_TITLE, 0), ==, "retitled");
+	g_assert_cmpstr(gmpd_song_peek_tag(fixture->song, GMPD_TAG_ARTIST, 0), ==, "artist");
+}
+
+/* The same, picked up from an idle event instead of a refresh. */
+static void
+test_idle_event(Fixture       *fixture,
+                gconstpointer  user_data G_GNUC_UNUSED)
+{
+	set_responses(fixture, "2.000", "retitled");
+	fake_server_emit_idle(fixture->server, "player");
+
+	while (!fixture->tags->len)
+		g_main_context_iteration(fixture->context, TRUE);
+
+	g_assert_cmpuint(fixture->notified->len, ==, 1);
+	g_assert_cmpstr(g_ptr_array_index(fixture->notified, 0), ==, "current-elapsed");
+
+	g_assert_cmpuint(fixture->tags->len, ==, 1);
+	g_assert_cmpint(g_array_index(fixture->tags, GMpdTag, 0), ==, GMPD_TAG_TITLE);
+}
+
+int
+main(int    argc,
+     char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add("/live-state/unchanged", Fixture, NULL,
+	           fixture_set_up, test_unchanged, fixture_tear_down);
+	g_test_add("/live-state/changed", Fixture, NULL,
+	           fixture_set_up, test_changed, fixture_tear_down);
+	g_test_add("/live-state/idle-event", Fixture, NULL,
+	           fixture_set_up, test_idle_event, fixture_tear_down);
+
+	return g_test_run();
+}
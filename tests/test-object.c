@@ -0,0 +1,117 @@
+/* libgmpd: MPD protocol implementation for GLib
+ * Copyright (C) 2020 Patrick Keating <binarydrifter@protonmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* Checks the per-object dispatch source: queued callbacks run once and
+ * in order, and notifies are coalesced until it is dispatched.
+ */
+
+#include <gio/gio.h>
+#include "value-object.h"
+
+static void
+on_notify(GObject    *object G_GNUC_UNUSED,
+          GParamSpec *pspec G_GNUC_UNUSED,
+          guint      *n_notifies)
+{
+	(*n_notifies)++;
+}
+
+static void
+drain(GMainContext *context)
+{
+	while (g_main_context_iteration(context, FALSE))
+		continue;
+}
+
+static gboolean
+append_index(gpointer data)
+{
+	GArray *order = data;
+	guint index = order->len;
+
+	g_array_append_val(order, index);
+
+	/* runs once, whatever it returns */
+	return G_SOURCE_CONTINUE;
+}
+
+static void
+test_run_in_context(void)
+{
+	GMainContext *context = g_main_context_new();
+	ValueObject *object = value_object_new(context);
+	GArray *order = g_array_new(FALSE, FALSE, sizeof(guint));
+	guint i;
+
+	for (i = 0; i < 3; i++)
+		gmpd_object_run_in_context(GMPD_OBJECT(object), append_index, order, NULL);
+
+	g_assert_cmpuint(order->len, ==, 0);
+
+	drain(context);
+
+	g_assert_cmpuint(order->len, ==, 3);
+
+	for (i = 0; i < order->len; i++)
+		g_assert_cmpuint(g_array_index(order, guint, i), ==, i);
+
+	g_array_unref(order);
+	g_object_unref(object);
+	g_main_context_unref(context);
+}
+
+static void
+test_notify_coalesced(void)
+{
+	GMainContext *context = g_main_context_new();
+	ValueObject *object = value_object_new(context);
+	guint n_notifies = 0;
+
+	g_signal_connect(object, "notify::value", G_CALLBACK(on_notify), &n_notifies);
+
+	value_object_set_value(object, 1);
+	value_object_set_value(object, 2);
+	value_object_set_value(object, 3);
+
+	g_assert_cmpuint(n_notifies, ==, 0);
+
+	drain(context);
+
+	g_assert_cmpuint(n_notifies, ==, 1);
+	g_assert_cmpint(value_object_get_value(object), ==, 3);
+
+	value_object_set_value(object, 4);
+	drain(context);
+
+	g_assert_cmpuint(n_notifies, ==, 2);
+
+	g_object_unref(object);
+	g_main_context_unref(context);
+}
+
+int
+main(int    argc,
+     char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/object/run-in-context", test_run_in_context);
+	g_test_add_func("/object/notify-coalesced", test_notify_coalesced);
+
+	return g_test_run();
+}
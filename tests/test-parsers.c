@@ -0,0 +1,294 @@
+/* libgmpd: MPD protocol implementation for GLib
+ * Copyright (C) 2020 Patrick Keating <binarydrifter@protonmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* The version, error and audio format parsers used to be GRegex
+ * patterns. These tests check the hand written scanners against those
+ * patterns, on a table of edge cases and on random input.
+ */
+
+#include <string.h>
+#include <gio/gio.h>
+#include <gmpd.h>
+
+#define VERSION_PATTERN      "OK MPD (\\d+).(\\d+).(\\d+)"
+#define ERROR_PATTERN        "ACK \\[(\\d+)@(\\d+)\\] {([^}]+)} (.*)"
+#define AUDIO_FORMAT_PATTERN "(\\d+):(\\d+):(\\d+)"
+
+#define N_RANDOM_INPUTS 20000
+
+static const gchar *const VERSION_INPUTS[] = {
+	"OK MPD 0.21.25\n",
+	"OK MPD 0.21\n",
+	"OK MPD 0.21.\n",
+	"OK MPD 1.2.3.4\n",
+	"OK MPD 12345\n",
+	"OK MPD 123\n",
+	"OK MPD 1x2y3\n",
+	"OK MPD 1\n2.3\n",
+	"OK MPD 1.2\n3\n",
+	"OK MPD 0\xc3\xa9" "2\xc3\xa9" "3\n",
+	"OK MPD x OK MPD 0.22.0\n",
+	"OK MPD 1. OK MPD 2.3.4\n",
+	"OK MPD OK MPD 5.6.7",
+	"garbage OK MPD 0.23.5",
+	"OK MPD  1.2.3",
+	"OK MPD",
+	"",
+};
+
+static const gchar *const ERROR_INPUTS[] = {
+	"ACK [50@0] {play} No such song",
+	"ACK [2@1] {} empty command",
+	"ACK [5@0] {a}b} message",
+	"ACK [5@0] {cmd} message with } brace",
+	"ACK [5@0] {cmd}message",
+	"ACK [5@0] {cmd} line1\nline2",
+	"ACK [5@0] {c\nmd} message",
+	"junk ACK [x@0] {a} b ACK [2@0] {c} d",
+	"ACK [5@] {a} b",
+	"ACK [@0] {a} b",
+	"ACK [5@0]{a} b",
+	"ACK [999@0] {a} unknown code",
+	"ACK [5@0] {a} ",
+	"ACK [5@0] {a}",
+	"",
+};
+
+static const gchar *const AUDIO_FORMAT_INPUTS[] = {
+	"44100:16:2",
+	"44100:f:2",
+	"dsd64:2",
+	"a1:2:3b",
+	"12:34",
+	"1:2:3:4",
+	"x 1::2:3 4:5:6",
+	"1:2:x 3:4:5",
+	"12:34:",
+	":1:2:3",
+	"",
+};
+
+/* pieces the random inputs are built from, chosen to hit the prefixes
+ * and separators the scanners look for */
+static const gchar *const TOKENS[] = {
+	"OK MPD ", "ACK [", "0", "2", "5", "50", "17", "@", "] ", "]",
+	"{", "}", " ", "play", ".", ":", "\n", "x", "\xc3\xa9",
+};
+
+static GRegex *
+regex_new(const gchar *pattern)
+{
+	GError *error = NULL;
+	GRegex *regex = g_regex_new(pattern, 0, 0, &error);
+
+	g_assert_no_error(error);
+
+	return regex;
+}
+
+static gchar *
+random_input(void)
+{
+	GString *s = g_string_new(NULL);
+	gint n_tokens = g_test_rand_int_range(0, 12);
+	gint i;
+
+	for (i = 0; i < n_tokens; i++)
+		g_string_append(s, TOKENS[g_test_rand_int_range(0, G_N_ELEMENTS(TOKENS))]);
+
+	return g_string_free(s, FALSE);
+}
+
+/* Numbers too large for the properties are rejected by GObject, which
+ * is the same before and after, so they are left out.
+ */
+static gboolean
+has_long_number(const gchar *s)
+{
+	gsize n = 0;
+
+	for (; *s; s++) {
+		n = g_ascii_isdigit(*s) ? n + 1 : 0;
+		if (n > 9)
+			return TRUE;
+	}
+
+	return FALSE;
+}
+
+static void
+check_version(GRegex      *regex,
+              const gchar *s)
+{
+	GMatchInfo *match_info;
+	GMpdVersion *version;
+
+	version = gmpd_version_new_from_string(s);
+
+	if (!g_regex_match(regex, s, 0, &match_info)) {
+		g_assert_null(version);
+	} else {
+		gchar *major = g_match_info_fetch(match_info, 1);
+		gchar *minor = g_match_info_fetch(match_info, 2);
+		gchar *patch = g_match_info_fetch(match_info, 3);
+
+		g_assert_nonnull(version);
+		g_assert_cmpint(gmpd_version_get_major(version), ==, (gint) g_ascii_strtoll(major, NULL, 10));
+		g_assert_cmpint(gmpd_version_get_minor(version), ==, (gint) g_ascii_strtoll(minor, NULL, 10));
+		g_assert_cmpint(gmpd_version_get_patch(version), ==, (gint) g_ascii_strtoll(patch, NULL, 10));
+
+		g_free(major);
+		g_free(minor);
+		g_free(patch);
+		g_object_unref(version);
+	}
+
+	g_match_info_unref(match_info);
+}
+
+static void
+check_error(GRegex      *regex,
+            const gchar *s)
+{
+	GMatchInfo *match_info;
+	GError *error;
+	gchar *message;
+	gint code;
+
+	error = gmpd_error_from_string(s);
+
+	if (!g_regex_match(regex, s, 0, &match_info)) {
+		code = GMPD_ERROR_UNKNOWN;
+		message = g_strdup_printf("invalid error string: %s", s);
+	} else {
+		gchar *code_str = g_match_info_fetch(match_info, 1);
+		gchar *command = g_match_info_fetch(match_info, 3);
+		gchar *text = g_match_info_fetch(match_info, 4);
+
+		code = g_ascii_strtoll(code_str, NULL, 10);
+		if (!GMPD_IS_ERROR_ENUM(code))
+			code = GMPD_ERROR_UNKNOWN;
+
+		message = g_strdup_printf("%s: %s", command, text);
+
+		g_free(code_str);
+		g_free(command);
+		g_free(text);
+	}
+
+	g_assert_error(error, GMPD_ERROR, code);
+	g_assert_cmpstr(error->message, ==, message);
+
+	g_free(message);
+	g_error_free(error);
+	g_match_info_unref(match_info);
+}
+
+static void
+check_audio_format(GRegex      *regex,
+                   const gchar *s)
+{
+	GMatchInfo *match_info;
+	GMpdAudioFormat *audio_format;
+
+	audio_format = gmpd_audio_format_new_from_string(s);
+
+	if (!g_regex_match(regex, s, 0, &match_info)) {
+		g_assert_null(audio_format);
+	} else {
+		gchar *sample_rate = g_match_info_fetch(match_info, 1);
+		gchar *bit_depth = g_match_info_fetch(match_info, 2);
+		gchar *channels = g_match_info_fetch(match_info, 3);
+
+		g_assert_nonnull(audio_format);
+		g_assert_cmpuint(gmpd_audio_format_get_sample_rate(audio_format), ==,
+		                 (guint32) g_ascii_strtoull(sample_rate, NULL, 10));
+		g_assert_cmpuint(gmpd_audio_format_get_bit_depth(audio_format), ==,
+		                 (guint8) g_ascii_strtoull(bit_depth, NULL, 10));
+		g_assert_cmpuint(gmpd_audio_format_get_channels(audio_format), ==,
+		                 (guint8) g_ascii_strtoull(channels, NULL, 10));
+
+		g_free(sample_rate);
+		g_free(bit_depth);
+		g_free(channels);
+		g_object_unref(audio_format);
+	}
+
+	g_match_info_unref(match_info);
+}
+
+typedef void (*CheckFunc) (GRegex      *regex,
+                           const gchar *s);
+
+static void
+run_checks(const gchar        *pattern,
+           const gchar *const *inputs,
+           gsize               n_inputs,
+           CheckFunc           check)
+{
+	GRegex *regex = regex_new(pattern);
+	gsize i;
+
+	for (i = 0; i < n_inputs; i++)
+		check(regex, inputs[i]);
+
+	for (i = 0; i < N_RANDOM_INPUTS; i++) {
+		gchar *s = random_input();
+
+		if (!has_long_number(s))
+			check(regex, s);
+
+		g_free(s);
+	}
+
+	g_regex_unref(regex);
+}
+
+static void
+test_version(void)
+{
+	run_checks(VERSION_PATTERN, VERSION_INPUTS, G_N_ELEMENTS(VERSION_INPUTS), check_version);
+}
+
+static void
+test_error(void)
+{
+	run_checks(ERROR_PATTERN, ERROR_INPUTS, G_N_ELEMENTS(ERROR_INPUTS), check_error);
+}
+
+static void
+test_audio_format(void)
+{
+	run_checks(AUDIO_FORMAT_PATTERN, AUDIO_FORMAT_INPUTS, G_N_ELEMENTS(AUDIO_FORMAT_INPUTS), check_audio_format);
+}
+
+int
+main(int    argc,
+     char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+
+	/* unknown error codes are logged as warnings, which is expected */
+	g_log_set_always_fatal(G_LOG_FATAL_MASK | G_LOG_LEVEL_CRITICAL);
+
+	g_test_add_func("/parsers/version", test_version);
+	g_test_add_func("/parsers/error", test_error);
+	g_test_add_func("/parsers/audio-format", test_audio_format);
+
+	return g_test_run();
+}
@@ -0,0 +1,130 @@
+/* libgmpd: MPD protocol implementation for GLib
+ * Copyright (C) 2020 Patrick Keating <binarydrifter@protonmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* Checks that the playback clock extrapolates the elapsed time while
+ * playing, stops at the end of the song, stands still otherwise and
+ * takes a new sample on every status update.
+ */
+
+#include <gio/gio.h>
+#include <gmpd.h>
+
+#define SLEEP (G_USEC_PER_SEC / 5)
+
+static GMpdStatus *
+status_new(GMpdPlaybackState playback,
+           gfloat            elapsed,
+           gfloat            duration)
+{
+	GMpdStatus *status = gmpd_status_new();
+
+	gmpd_status_set_playback(status, playback);
+	gmpd_status_set_current_elapsed(status, elapsed);
+	gmpd_status_set_current_duration(status, duration);
+
+	return status;
+}
+
+static void
+test_playing(void)
+{
+	GMpdStatus *status = status_new(GMPD_PLAYBACK_PLAYING, 10, 100);
+	GMpdPlaybackClock *clock = gmpd_playback_clock_new(status);
+	gfloat elapsed;
+
+	g_assert_true(gmpd_playback_clock_get_running(clock));
+
+	g_usleep(SLEEP);
+	elapsed = gmpd_playback_clock_get_elapsed(clock);
+
+	g_assert_cmpfloat(elapsed, >=, 10.2);
+	g_assert_cmpfloat(elapsed, <, 12);
+
+	g_object_unref(clock);
+	g_object_unref(status);
+}
+
+static void
+test_clamped(void)
+{
+	GMpdStatus *status = status_new(GMPD_PLAYBACK_PLAYING, 99.95, 100);
+	GMpdPlaybackClock *clock = gmpd_playback_clock_new(status);
+
+	g_usleep(SLEEP);
+
+	g_assert_cmpfloat(gmpd_playback_clock_get_elapsed(clock), ==, 100);
+
+	g_object_unref(clock);
+	g_object_unref(status);
+}
+
+static void
+test_paused(void)
+{
+	GMpdStatus *status = status_new(GMPD_PLAYBACK_PAUSED, 10, 100);
+	GMpdPlaybackClock *clock = gmpd_playback_clock_new(status);
+
+	g_assert_false(gmpd_playback_clock_get_running(clock));
+
+	g_usleep(SLEEP);
+
+	g_assert_cmpfloat(gmpd_playback_clock_get_elapsed(clock), ==, 10);
+
+	gmpd_status_set_playback(status, GMPD_PLAYBACK_PLAYING);
+	g_assert_true(gmpd_playback_clock_get_running(clock));
+
+	g_object_unref(clock);
+	g_object_unref(status);
+}
+
+/* The server reports the same elapsed time again, after a seek back to
+ * where the last sample was taken. Nothing is notified, but the clock
+ * has to start over from there.
+ */
+static void
+test_resync_on_update(void)
+{
+	GMpdStatus *status = status_new(GMPD_PLAYBACK_PLAYING, 10, 100);
+	GMpdStatus *sample = status_new(GMPD_PLAYBACK_PLAYING, 10, 100);
+	GMpdPlaybackClock *clock = gmpd_playback_clock_new(status);
+
+	g_usleep(SLEEP);
+	g_assert_cmpfloat(gmpd_playback_clock_get_elapsed(clock), >=, 10.2);
+
+	gmpd_status_update(status, sample);
+
+	g_assert_cmpfloat(gmpd_playback_clock_get_elapsed(clock), <, 10.1);
+
+	g_object_unref(clock);
+	g_object_unref(sample);
+	g_object_unref(status);
+}
+
+int
+main(int    argc,
+     char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/playback-clock/playing", test_playing);
+	g_test_add_func("/playback-clock/clamped", test_clamped);
+	g_test_add_func("/playback-clock/paused", test_paused);
+	g_test_add_func("/playback-clock/resync-on-update", test_resync_on_update);
+
+	return g_test_run();
+}
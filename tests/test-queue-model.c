@@ -0,0 +1,220 @@
+/* libgmpd: MPD protocol implementation for GLib
+ * Copyright (C) 2020 Patrick Keating <binarydrifter@protonmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* Checks that the queue model only signals the songs that were really
+ * added or removed, and keeps the objects of the songs that moved.
+ */
+
+#include <gio/gio.h>
+#include <gmpd.h>
+#include "fake-server.h"
+
+#define SONG(path, pos, id) \
+	"file: " path "\nTitle: " path "\nPos: " #pos "\nId: " #id "\n"
+
+typedef struct {
+	guint position;
+	guint removed;
+	guint added;
+} Change;
+
+/* Each test runs in a context of its own, so nothing left attached by
+ * the client of one test is dispatched in the next.
+ */
+typedef struct {
+	GMainContext   *context;
+	FakeServer     *server;
+	GMpdClient     *client;
+	GMpdQueueModel *model;
+	GArray         *changes;
+} Fixture;
+
+static void
+on_items_changed(GListModel *model G_GNUC_UNUSED,
+                 guint       position,
+                 guint       removed,
+                 guint       added,
+                 Fixture    *fixture)
+{
+	Change change = {position, removed, added};
+	g_array_append_val(fixture->changes, change);
+}
+
+static void
+on_update_ready(GObject      *source_object,
+                GAsyncResult *result,
+                gpointer      user_data)
+{
+	GError *error = NULL;
+
+	gmpd_queue_model_update_finish(GMPD_QUEUE_MODEL(source_object), result, &error);
+	g_assert_no_error(error);
+
+	g_main_loop_quit(user_data);
+}
+
+static void
+update(Fixture *fixture)
+{
+	GMainLoop *loop = g_main_loop_new(fixture->context, FALSE);
+
+	gmpd_queue_model_update_async(fixture->model, NULL, on_update_ready, loop);
+	g_main_loop_run(loop);
+	g_main_loop_unref(loop);
+}
+
+static void
+fixture_set_up(Fixture       *fixture,
+               gconstpointer  user_data G_GNUC_UNUSED)
+{
+	GError *error = NULL;
+
+	fixture->context = g_main_context_new();
+	g_main_context_push_thread_default(fixture->context);
+
+	fixture->server = fake_server_new();
+	fake_server_set_response(fixture->server, "status",
+	                         "playlist: 4\nplaylistlength: 3\n");
+	fake_server_set_response(fixture->server, "playlistinfo",
+	                         SONG("a", 0, 1) SONG("b", 1, 2) SONG("c", 2, 3));
+
+	fixture->client = gmpd_client_connect("127.0.0.1",
+	                                      fake_server_get_port(fixture->server),
+	                                      NULL,
+	                                      &error);
+	g_assert_no_error(error);
+
+	fixture->model = gmpd_queue_model_new(fixture->client);
+	fixture->changes = g_array_new(FALSE, FALSE, sizeof(Change));
+
+	update(fixture);
+	g_assert_cmpuint(g_list_model_get_n_items(G_LIST_MODEL(fixture->model)), ==, 3);
+
+	g_signal_connect(fixture->model, "items-changed", G_CALLBACK(on_items_changed), fixture);
+}
+
+static void
+fixture_tear_down(Fixture       *fixture,
+                  gconstpointer  user_data G_GNUC_UNUSED)
+{
+	g_array_unref(fixture->changes);
+	g_object_unref(fixture->model);
+	g_object_unref(fixture->client);
+	fake_server_free(fixture->server);
+
+	g_main_context_pop_thread_default(fixture->context);
+	g_main_context_unref(fixture->context);
+}
+
+static void
+assert_change(Fixture *fixture,
+              guint    position,
+              guint    removed,
+              guint    added)
+{
+	Change *change;
+
+	g_assert_cmpuint(fixture->changes->len, ==, 1);
+
+	change = &g_array_index(fixture->changes, Change, 0);
+	g_assert_cmpuint(change->position, ==, position);
+	g_assert_cmpuint(change->removed, ==, removed);
+	g_assert_cmpuint(change->added, ==, added);
+}
+
+static void
+test_head_delete(Fixture       *fixture,
+                 gconstpointer  user_data G_GNUC_UNUSED)
+{
+	GListModel *list = G_LIST_MODEL(fixture->model);
+	GObject *b = g_list_model_get_item(list, 1);
+	GObject *item;
+
+	fake_server_set_response(fixture->server, "status",
+	                         "playlist: 5\nplaylistlength: 2\n");
+	fake_server_set_response(fixture->server, "plchanges 4",
+	                         SONG("b", 0, 2) SONG("c", 1, 3));
+
+	update(fixture);
+
+	assert_change(fixture, 0, 1, 0);
+	g_assert_cmpuint(g_list_model_get_n_items(list), ==, 2);
+
+	item = g_list_model_get_item(list, 0);
+	g_assert_true(item == b);
+	g_assert_cmpuint(gmpd_song_get_position(GMPD_SONG(item)), ==, 0);
+
+	g_object_unref(item);
+	g_object_unref(b);
+}
+
+static void
+test_head_insert(Fixture       *fixture,
+                 gconstpointer  user_data G_GNUC_UNUSED)
+{
+	GListModel *list = G_LIST_MODEL(fixture->model);
+	GObject *a = g_list_model_get_item(list, 0);
+	GObject *item;
+
+	fake_server_set_response(fixture->server, "status",
+	                         "playlist: 5\nplaylistlength: 4\n");
+	fake_server_set_response(fixture->server, "plchanges 4",
+	                         SONG("x", 0, 4) SONG("a", 1, 1) SONG("b", 2, 2) SONG("c", 3, 3));
+
+	update(fixture);
+
+	assert_change(fixture, 0, 0, 1);
+	g_assert_cmpuint(g_list_model_get_n_items(list), ==, 4);
+
+	item = g_list_model_get_item(list, 1);
+	g_assert_true(item == a);
+	g_assert_cmpuint(gmpd_song_get_position(GMPD_SONG(item)), ==, 1);
+
+	g_object_unref(item);
+	g_object_unref(a);
+}
+
+static void
+test_changed_tags(Fixture       *fixture,
+                  gconstpointer  user_data G_GNUC_UNUSED)
+{
+	fake_server_set_response(fixture->server, "status",
+	                         "playlist: 5\nplaylistlength: 3\n");
+	fake_server_set_response(fixture->server, "plchanges 4",
+	                         "file: b\nTitle: retitled\nPos: 1\nId: 2\n");
+
+	update(fixture);
+
+	assert_change(fixture, 1, 1, 1);
+}
+
+int
+main(int    argc,
+     char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add("/queue-model/head-delete", Fixture, NULL,
+	           fixture_set_up, test_head_delete, fixture_tear_down);
+	g_test_add("/queue-model/head-insert", Fixture, NULL,
+	           fixture_set_up, test_head_insert, fixture_tear_down);
+	g_test_add("/queue-model/changed-tags", Fixture, NULL,
+	           fixture_set_up, test_changed_tags, fixture_tear_down);
+
+	return g_test_run();
+}
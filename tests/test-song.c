@@ -0,0 +1,159 @@
+/* libgmpd: MPD protocol implementation for GLib
+ * Copyright (C) 2020 Patrick Keating <binarydrifter@protonmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* Checks the packed tag block of GMpdSong: values keep their order,
+ * shared tags are interned across songs, and the block stays valid
+ * after finish() has trimmed it and it is grown again.
+ */
+
+#include <gio/gio.h>
+#include "gmpd-response.h"
+#include "gmpd-song.h"
+
+static GMpdVersion *version;
+
+static GMpdSong *
+song_new_from_pairs(const gchar *const *pairs)
+{
+	GMpdSong *song = gmpd_song_new();
+
+	for (; pairs[0]; pairs += 2)
+		gmpd_response_feed_pair(GMPD_RESPONSE(song), version, pairs[0], pairs[1]);
+
+	gmpd_response_finish(GMPD_RESPONSE(song), version);
+
+	return song;
+}
+
+static void
+test_order(void)
+{
+	static const gchar *const pairs[] = {
+		"file",   "a.flac",
+		"Artist", "first",
+		"Title",  "title",
+		"Artist", "second",
+		"Album",  "album",
+		NULL,
+	};
+
+	GMpdSong *song = song_new_from_pairs(pairs);
+	gchar **artists;
+
+	g_assert_cmpstr(gmpd_song_peek_tag(song, GMPD_TAG_ARTIST, 0), ==, "first");
+	g_assert_cmpstr(gmpd_song_peek_tag(song, GMPD_TAG_ARTIST, 1), ==, "second");
+	g_assert_null(gmpd_song_peek_tag(song, GMPD_TAG_ARTIST, 2));
+	g_assert_cmpstr(gmpd_song_peek_tag(song, GMPD_TAG_TITLE, 0), ==, "title");
+	g_assert_cmpstr(gmpd_song_peek_tag(song, GMPD_TAG_ALBUM, 0), ==, "album");
+	g_assert_null(gmpd_song_peek_tag(song, GMPD_TAG_GENRE, 0));
+
+	artists = gmpd_song_get_tag(song, GMPD_TAG_ARTIST);
+	g_assert_cmpuint(g_strv_length(artists), ==, 2);
+	g_assert_cmpstr(artists[0], ==, "first");
+	g_assert_cmpstr(artists[1], ==, "second");
+	g_strfreev(artists);
+
+	g_assert_null(gmpd_song_get_tag(song, GMPD_TAG_GENRE));
+
+	g_object_unref(song);
+}
+
+static void
+test_interned(void)
+{
+	static const gchar *const pairs[] = {
+		"Artist", "artist",
+		"Title",  "title",
+		NULL,
+	};
+
+	GMpdSong *a = song_new_from_pairs(pairs);
+	GMpdSong *b = song_new_from_pairs(pairs);
+
+	/* the artist is shared, the title is copied into each block */
+	g_assert_true(gmpd_song_peek_tag(a, GMPD_TAG_ARTIST, 0) ==
+	              gmpd_song_peek_tag(b, GMPD_TAG_ARTIST, 0));
+	g_assert_false(gmpd_song_peek_tag(a, GMPD_TAG_TITLE, 0) ==
+	               gmpd_song_peek_tag(b, GMPD_TAG_TITLE, 0));
+
+	g_object_unref(a);
+
+	g_assert_cmpstr(gmpd_song_peek_tag(b, GMPD_TAG_ARTIST, 0), ==, "artist");
+
+	g_object_unref(b);
+}
+
+/* Enough values to grow the block a few times before it is trimmed. */
+static void
+test_finish(void)
+{
+	static const gchar *const artists[] = {"x", "y", NULL};
+	GPtrArray *pairs = g_ptr_array_new_with_free_func(g_free);
+	GMpdSong *song;
+	guint i;
+
+	for (i = 0; i < 64; i++) {
+		g_ptr_array_add(pairs, g_strdup("Comment"));
+		g_ptr_array_add(pairs, g_strdup_printf("comment %u", i));
+	}
+
+	g_ptr_array_add(pairs, NULL);
+
+	song = song_new_from_pairs((const gchar *const *) pairs->pdata);
+
+	for (i = 0; i < 64; i++) {
+		gchar *comment = g_strdup_printf("comment %u", i);
+		g_assert_cmpstr(gmpd_song_peek_tag(song, GMPD_TAG_COMMENT, i), ==, comment);
+		g_free(comment);
+	}
+
+	gmpd_song_set_tag(song, GMPD_TAG_ARTIST, artists);
+
+	g_assert_cmpstr(gmpd_song_peek_tag(song, GMPD_TAG_ARTIST, 0), ==, "x");
+	g_assert_cmpstr(gmpd_song_peek_tag(song, GMPD_TAG_ARTIST, 1), ==, "y");
+	g_assert_cmpstr(gmpd_song_peek_tag(song, GMPD_TAG_COMMENT, 63), ==, "comment 63");
+
+	gmpd_song_set_tag(song, GMPD_TAG_COMMENT, NULL);
+
+	g_assert_null(gmpd_song_peek_tag(song, GMPD_TAG_COMMENT, 0));
+	g_assert_cmpstr(gmpd_song_peek_tag(song, GMPD_TAG_ARTIST, 1), ==, "y");
+
+	g_object_unref(song);
+	g_ptr_array_unref(pairs);
+}
+
+int
+main(int    argc,
+     char **argv)
+{
+	int result;
+
+	g_test_init(&argc, &argv, NULL);
+
+	version = gmpd_version_new(0, 23, 5);
+
+	g_test_add_func("/song/order", test_order);
+	g_test_add_func("/song/interned", test_interned);
+	g_test_add_func("/song/finish", test_finish);
+
+	result = g_test_run();
+
+	g_object_unref(version);
+
+	return result;
+}
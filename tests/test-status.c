@@ -0,0 +1,157 @@
+/* libgmpd: MPD protocol implementation for GLib
+ * Copyright (C) 2020 Patrick Keating <binarydrifter@protonmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* Checks that gmpd_status_update() copies a status field by field and
+ * only notifies the properties whose value really changed.
+ */
+
+#include <gio/gio.h>
+#include "gmpd-response.h"
+#include "gmpd-status.h"
+
+typedef struct {
+	GMpdStatus *status;
+	GPtrArray  *notified;
+} Fixture;
+
+/* Every notify comes after the whole status was copied. */
+static void
+on_notify(GMpdStatus *status,
+          GParamSpec *pspec,
+          Fixture    *fixture)
+{
+	g_assert_cmpint(gmpd_status_get_volume(status), ==, 80);
+	g_ptr_array_add(fixture->notified, g_strdup(pspec->name));
+}
+
+static void
+fixture_set_up(Fixture       *fixture,
+               gconstpointer  user_data G_GNUC_UNUSED)
+{
+	GMpdAudioFormat *audio_format = gmpd_audio_format_new_from_string("44100:24:2");
+
+	fixture->status = gmpd_status_new();
+	fixture->notified = g_ptr_array_new_with_free_func(g_free);
+
+	gmpd_status_set_volume(fixture->status, 50);
+	gmpd_status_set_repeat(fixture->status, TRUE);
+	gmpd_status_set_playback(fixture->status, GMPD_PLAYBACK_PLAYING);
+	gmpd_status_set_current_elapsed(fixture->status, 10);
+	gmpd_status_set_audio_format(fixture->status, audio_format);
+	gmpd_status_set_error(fixture->status, "decoder failed");
+
+	g_signal_connect(fixture->status, "notify", G_CALLBACK(on_notify), fixture);
+
+	g_object_unref(audio_format);
+}
+
+static void
+fixture_tear_down(Fixture       *fixture,
+                  gconstpointer  user_data G_GNUC_UNUSED)
+{
+	g_object_unref(fixture->status);
+	g_ptr_array_unref(fixture->notified);
+}
+
+static void
+assert_notified(Fixture            *fixture,
+                const gchar *const *names)
+{
+	guint i;
+
+	g_assert_cmpuint(fixture->notified->len, ==, g_strv_length((gchar **) names));
+
+	for (i = 0; names[i]; i++)
+		g_assert_true(g_ptr_array_find_with_equal_func(fixture->notified, names[i], g_str_equal, NULL));
+}
+
+static void
+test_changed_fields(Fixture       *fixture,
+                    gconstpointer  user_data G_GNUC_UNUSED)
+{
+	static const gchar *const names[] = {"volume", "repeat", "current-elapsed", NULL};
+	GMpdAudioFormat *audio_format = gmpd_audio_format_new_from_string("44100:24:2");
+	GMpdStatus *status = gmpd_status_new();
+
+	gmpd_status_set_volume(status, 80);
+	gmpd_status_set_repeat(status, FALSE);
+	gmpd_status_set_playback(status, GMPD_PLAYBACK_PLAYING);
+	gmpd_status_set_current_elapsed(status, 12.5);
+	gmpd_status_set_audio_format(status, audio_format);
+	gmpd_status_set_error(status, "decoder failed");
+
+	gmpd_status_update(fixture->status, status);
+
+	/* an equal audio format in another object is no change */
+	assert_notified(fixture, names);
+	g_assert_false(gmpd_status_get_repeat(fixture->status));
+	g_assert_cmpfloat(gmpd_status_get_current_elapsed(fixture->status), ==, 12.5);
+
+	g_ptr_array_set_size(fixture->notified, 0);
+	gmpd_status_update(fixture->status, status);
+	g_assert_cmpuint(fixture->notified->len, ==, 0);
+
+	g_object_unref(audio_format);
+	g_object_unref(status);
+}
+
+/* A parsed status has the fields the server left out at their
+ * defaults, updating from it resets them.
+ */
+static void
+test_parsed(Fixture       *fixture,
+            gconstpointer  user_data G_GNUC_UNUSED)
+{
+	static const gchar *const names[] = {
+		"volume", "repeat", "current-elapsed", "audio-format", "error", NULL,
+	};
+
+	GMpdVersion *version = gmpd_version_new(0, 23, 5);
+	GMpdStatus *status = gmpd_status_new();
+	gchar *error;
+
+	gmpd_response_feed_pair(GMPD_RESPONSE(status), version, "volume", "80");
+	gmpd_response_feed_pair(GMPD_RESPONSE(status), version, "repeat", "0");
+	gmpd_response_feed_pair(GMPD_RESPONSE(status), version, "state", "play");
+	gmpd_response_feed_pair(GMPD_RESPONSE(status), version, "elapsed", "12.500");
+
+	gmpd_status_update(fixture->status, status);
+
+	assert_notified(fixture, names);
+
+	error = gmpd_status_get_error(fixture->status);
+	g_assert_null(error);
+	g_assert_null(gmpd_status_get_audio_format(fixture->status));
+
+	g_object_unref(status);
+	g_object_unref(version);
+}
+
+int
+main(int    argc,
+     char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add("/status/changed-fields", Fixture, NULL,
+	           fixture_set_up, test_changed_fields, fixture_tear_down);
+	g_test_add("/status/parsed", Fixture, NULL,
+	           fixture_set_up, test_parsed, fixture_tear_down);
+
+	return g_test_run();
+}
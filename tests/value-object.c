@@ -0,0 +1,128 @@
+/* libgmpd: MPD protocol implementation for GLib
+ * Copyright (C) 2020 Patrick Keating <binarydrifter@protonmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* The smallest GMpdObject there is, one integer property that notifies
+ * on every set, for exercising the dispatch source.
+ */
+
+#include "value-object.h"
+
+enum {
+	PROP_NONE,
+	PROP_VALUE,
+	N_PROPERTIES,
+};
+
+struct _ValueObject {
+	GMpdObject __base__;
+	gint       value;
+};
+
+struct _ValueObjectClass {
+	GMpdObjectClass __base__;
+};
+
+G_DEFINE_TYPE(ValueObject, value_object, GMPD_TYPE_OBJECT)
+
+static GParamSpec *PROPERTIES[N_PROPERTIES] = {NULL};
+
+static void
+value_object_set_property(GObject      *object,
+                          guint         prop_id,
+                          const GValue *value,
+                          GParamSpec   *pspec)
+{
+	ValueObject *self = VALUE_OBJECT(object);
+
+	switch (prop_id) {
+	case PROP_VALUE:
+		value_object_set_value(self, g_value_get_int(value));
+		break;
+
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+	}
+}
+
+static void
+value_object_get_property(GObject    *object,
+                          guint       prop_id,
+                          GValue     *value,
+                          GParamSpec *pspec)
+{
+	ValueObject *self = VALUE_OBJECT(object);
+
+	switch (prop_id) {
+	case PROP_VALUE:
+		g_value_set_int(value, value_object_get_value(self));
+		break;
+
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+	}
+}
+
+static void
+value_object_class_init(ValueObjectClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(klass);
+
+	object_class->set_property = value_object_set_property;
+	object_class->get_property = value_object_get_property;
+
+	PROPERTIES[PROP_VALUE] =
+		g_param_spec_int("value",
+		                 "Value",
+		                 "Value",
+		                 G_MININT, G_MAXINT, 0,
+		                 G_PARAM_READWRITE |
+		                 G_PARAM_EXPLICIT_NOTIFY |
+		                 G_PARAM_STATIC_STRINGS);
+
+	g_object_class_install_properties(object_class, N_PROPERTIES, PROPERTIES);
+}
+
+static void
+value_object_init(ValueObject *self)
+{
+	self->value = 0;
+}
+
+/* Without a context, notifies are emitted right away. */
+ValueObject *
+value_object_new(GMainContext *context)
+{
+	if (context)
+		return g_object_new(VALUE_TYPE_OBJECT, "context", context, NULL);
+	else
+		return g_object_new(VALUE_TYPE_OBJECT, NULL);
+}
+
+void
+value_object_set_value(ValueObject *self,
+                       gint         value)
+{
+	self->value = value;
+	g_object_notify_by_pspec(G_OBJECT(self), PROPERTIES[PROP_VALUE]);
+}
+
+gint
+value_object_get_value(ValueObject *self)
+{
+	return self->value;
+}
@@ -0,0 +1,44 @@
+/* libgmpd: MPD protocol implementation for GLib
+ * Copyright (C) 2020 Patrick Keating <binarydrifter@protonmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef __VALUE_OBJECT_H__
+#define __VALUE_OBJECT_H__
+
+#include <gio/gio.h>
+#include "gmpd-object-priv.h"
+
+G_BEGIN_DECLS
+
+#define VALUE_TYPE_OBJECT \
+	(value_object_get_type())
+
+#define VALUE_OBJECT(inst) \
+	(G_TYPE_CHECK_INSTANCE_CAST((inst), VALUE_TYPE_OBJECT, ValueObject))
+
+typedef struct _ValueObject      ValueObject;
+typedef struct _ValueObjectClass ValueObjectClass;
+
+GType          value_object_get_type   (void);
+ValueObject *  value_object_new        (GMainContext *context);
+void           value_object_set_value  (ValueObject  *self,
+                                        gint          value);
+gint           value_object_get_value  (ValueObject  *self);
+
+G_END_DECLS
+
+#endif /* __VALUE_OBJECT_H__ */